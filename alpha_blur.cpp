@@ -0,0 +1,145 @@
+//  alpha_blur.cpp  –  Better Cursor Finder (BCF)
+//  A column pass keeps one row of running sums: row y+k is added, the row out is the sums
+//  times 1/(2k+1), and row y-k is subtracted, so the work per pixel is three operations
+//  whatever the radius. The three passes run in one sweep, each handing its rows straight
+//  to the next through a ring of 2k+1 rows, so the plane is read and written once per axis
+//  and the rows in flight stay in cache. The SIMD paths do the same float operations in the
+//  same order per pixel and so match the scalar one exactly; values stay in 0..1, so the
+//  running sums drift by far less than a level.
+
+#include "alpha_blur.h"
+#include "cpu_features.h"
+#include <algorithm>
+
+#if defined(BCF_SSE2)
+  #include <emmintrin.h>
+  #include <immintrin.h>
+#endif
+
+//  SCALAR
+// acc += add; dst = acc*inv; acc -= sub, from element i on. Any of add, dst, sub may be null.
+static inline void StepTail(float*acc,const float*add,const float*sub,float*dst,float inv,int i,int n)
+{
+    for(;i<n;i++){
+        float s=acc[i];
+        if(add)s+=add[i];
+        if(dst)dst[i]=s*inv;
+        if(sub)s-=sub[i];
+        acc[i]=s;
+    }
+}
+static void StepScalar(float*acc,const float*add,const float*sub,float*dst,float inv,int n)
+{
+    StepTail(acc,add,sub,dst,inv,0,n);
+}
+
+// src is w x h, dst h x w; 8x8 blocks keep both sides in cache.
+static void TransposeScalar(const float*src,float*dst,int w,int h)
+{
+    for(int y0=0;y0<h;y0+=8)
+        for(int x0=0;x0<w;x0+=8)
+            for(int y=y0;y<std::min(h,y0+8);y++)
+                for(int x=x0;x<std::min(w,x0+8);x++)dst[(size_t)x*h+y]=src[(size_t)y*w+x];
+}
+
+#if defined(BCF_SSE2)
+//  SSE2  (4 lanes)
+static void StepSSE2(float*acc,const float*add,const float*sub,float*dst,float inv,int n)
+{
+    const __m128 vi=_mm_set1_ps(inv);
+    int i=0;
+    if(add&&sub&&dst)
+        for(;i+4<=n;i+=4){
+            __m128 s=_mm_add_ps(_mm_loadu_ps(acc+i),_mm_loadu_ps(add+i));
+            _mm_storeu_ps(dst+i,_mm_mul_ps(s,vi));
+            _mm_storeu_ps(acc+i,_mm_sub_ps(s,_mm_loadu_ps(sub+i)));
+        }
+    StepTail(acc,add,sub,dst,inv,i,n);
+}
+
+static void TransposeSSE2(const float*src,float*dst,int w,int h)
+{
+    const int w4=w&~3, h4=h&~3;
+    for(int y=0;y<h4;y+=4)
+        for(int x=0;x<w4;x+=4){
+            const float*s=src+(size_t)y*w+x;
+            __m128 r0=_mm_loadu_ps(s), r1=_mm_loadu_ps(s+w), r2=_mm_loadu_ps(s+2*w), r3=_mm_loadu_ps(s+3*w);
+            _MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+            float*d=dst+(size_t)x*h+y;
+            _mm_storeu_ps(d,r0); _mm_storeu_ps(d+h,r1); _mm_storeu_ps(d+2*h,r2); _mm_storeu_ps(d+3*h,r3);
+        }
+    for(int y=0;y<h;y++)
+        for(int x=y<h4?w4:0;x<w;x++)dst[(size_t)x*h+y]=src[(size_t)y*w+x];
+}
+#endif
+
+#if defined(BCF_AVX2)
+//  AVX2  (8 lanes)
+// Edge rows and tails stay in this function: calling out to code compiled without AVX from
+// here costs more than the loop itself.
+BCF_AVX2_FN static void StepAVX2(float*acc,const float*add,const float*sub,float*dst,float inv,int n)
+{
+    const __m256 vi=_mm256_set1_ps(inv);
+    int i=0;
+    if(add&&sub&&dst)
+        for(;i+8<=n;i+=8){
+            __m256 s=_mm256_add_ps(_mm256_loadu_ps(acc+i),_mm256_loadu_ps(add+i));
+            _mm256_storeu_ps(dst+i,_mm256_mul_ps(s,vi));
+            _mm256_storeu_ps(acc+i,_mm256_sub_ps(s,_mm256_loadu_ps(sub+i)));
+        }
+    else
+        for(;i+8<=n;i+=8){
+            __m256 s=_mm256_loadu_ps(acc+i);
+            if(add)s=_mm256_add_ps(s,_mm256_loadu_ps(add+i));
+            if(dst)_mm256_storeu_ps(dst+i,_mm256_mul_ps(s,vi));
+            if(sub)s=_mm256_sub_ps(s,_mm256_loadu_ps(sub+i));
+            _mm256_storeu_ps(acc+i,s);
+        }
+    StepTail(acc,add,sub,dst,inv,i,n);
+}
+#endif
+
+//  DISPATCH
+typedef void(*StepFn)(float*,const float*,const float*,float*,float,int);
+typedef void(*TransposeFn)(const float*,float*,int,int);
+
+static void PickFns(RasterPath path,StepFn&step,TransposeFn&tr)
+{
+    if(path==RP_AUTO)path=RasterBestPath();
+    step=StepScalar; tr=TransposeScalar;
+#if defined(BCF_SSE2)
+    if(path!=RP_SCALAR){step=StepSSE2;tr=TransposeSSE2;}
+#endif
+#if defined(BCF_AVX2)
+    if(path==RP_AVX2&&CpuHasAVX2())step=StepAVX2;
+#endif
+}
+
+// Three box passes of radius k down every column of a w x h plane, in place. Pass s takes
+// in row i-s*k at step i and, once it holds rows up to z+k, emits row z=i-(s+1)*k. The last
+// pass overwrites row i-3k, which the first stopped reading at step i-k.
+static void BoxCols3(float*a,int w,int h,int k,float*tmp,StepFn step)
+{
+    const int n=2*k+1; const float inv=1.f/(float)n;
+    float*acc[3]={tmp,tmp+w,tmp+2*w}, *ring[2]={tmp+3*(size_t)w,tmp+(3+(size_t)n)*w};
+    std::fill(tmp,tmp+3*(size_t)w,0.f);
+    auto in=[&](int s,int y){return s?ring[s-1]+(size_t)(y%n)*w:a+(size_t)y*w;};
+    for(int i=0;i<h+3*k;i++)
+        for(int s=0,y=i;s<3&&y>=0;s++,y-=k){
+            const int z=y-k;
+            if(z>=h)continue;
+            float*out=z<0?nullptr:s<2?ring[s]+(size_t)(z%n)*w:a+(size_t)z*w;
+            step(acc[s],y<h?in(s,y):nullptr,z-k>=0?in(s,z-k):nullptr,out,inv,w);
+        }
+}
+
+void BlurAlpha(float*a,int w,int h,int k,float*scratch,RasterPath path)
+{
+    if(k<=0||w<=0||h<=0)return;
+    StepFn step; TransposeFn tr; PickFns(path,step,tr);
+    float*t=scratch, *tmp=scratch+(size_t)w*h;
+    BoxCols3(a,w,h,k,tmp,step);
+    tr(a,t,w,h);                                    // rows are now columns: h wide, w tall
+    BoxCols3(t,h,w,k,tmp,step);
+    tr(t,a,h,w);
+}
@@ -0,0 +1,61 @@
+//  bcf_icon.h  –  Better Cursor Finder (BCF)
+//  The 32x32 tray / window icon, generated at compile time: a dark disc with an accent ring,
+//  4x4 supersampled, and "BCF" in a 2 px stroke bitmap font. BCF_ICON lands in read-only
+//  data, so building the HICON is a memcpy and no drawing library is touched at startup.
+//  No Windows headers.
+#pragma once
+#include <cstdint>
+
+static const int BCF_ICON_SZ = 32;
+
+struct BakedIcon {
+    uint32_t argb[BCF_ICON_SZ*BCF_ICON_SZ] = {};   // straight alpha, 0xAARRGGBB, top-down
+    uint8_t  mask[BCF_ICON_SZ*BCF_ICON_SZ/8] = {}; // AND mask, 1 bpp, set = transparent
+};
+
+namespace bcf_icon {
+    constexpr int GW = 5, GH = 8, GAP = 1;
+    constexpr const char* GLYPHS[3][GH] = {
+        {"####.","##.##","##.##","####.","##.##","##.##","##.##","####."},
+        {".###.","##.##","##...","##...","##...","##...","##.##",".###."},
+        {"#####","##...","##...","####.","##...","##...","##...","##..."},
+    };
+    constexpr int TX = (BCF_ICON_SZ-(3*GW+2*GAP))/2, TY = (BCF_ICON_SZ-GH)/2;
+
+    constexpr bool TextAt(int x,int y){
+        if(y<TY||y>=TY+GH||x<TX)return false;
+        int gx=x-TX, g=gx/(GW+GAP), col=gx%(GW+GAP);
+        return g<3&&col<GW&&GLYPHS[g][y-TY][col]=='#';
+    }
+}
+
+// Geometry and colours of the original GDI+ icon: disc of radius 15 at the centre, a 1.8 px
+// ring just inside its edge.
+constexpr BakedIcon BakeBCFIcon()
+{
+    using namespace bcf_icon;
+    const uint32_t BG = 0x12121E, RING = 0x4894FF, TEXT = 0xF0F0FF;
+    const float c = BCF_ICON_SZ/2.f, R = 15.f, RIN = R-1.8f;
+    BakedIcon ic;
+    for(int y=0;y<BCF_ICON_SZ;y++)
+        for(int x=0;x<BCF_ICON_SZ;x++){
+            const uint32_t fill = TextAt(x,y) ? TEXT : BG;
+            int n=0; uint32_t r=0, g=0, b=0;
+            for(int sy=0;sy<4;sy++)
+                for(int sx=0;sx<4;sx++){
+                    float dx=x+(sx+0.5f)/4-c, dy=y+(sy+0.5f)/4-c, d2=dx*dx+dy*dy;
+                    if(d2>R*R)continue;
+                    uint32_t col = d2>=RIN*RIN ? RING : fill;
+                    r+=col>>16&255; g+=col>>8&255; b+=col&255; n++;
+                }
+            uint32_t px=0;
+            if(n) px=(uint32_t)(n*255/16)<<24|(r+n/2)/n<<16|(g+n/2)/n<<8|(b+n/2)/n;
+            ic.argb[y*BCF_ICON_SZ+x]=px;
+            if(n<8) ic.mask[(y*BCF_ICON_SZ+x)/8]|=(uint8_t)(0x80>>(x&7));
+        }
+    return ic;
+}
+
+inline constexpr BakedIcon BCF_ICON = BakeBCFIcon();
+static_assert(BCF_ICON.argb[16*BCF_ICON_SZ+16]>>24==255, "centre is opaque");
+static_assert(BCF_ICON.argb[0]==0, "corners are transparent");
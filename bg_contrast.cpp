@@ -0,0 +1,139 @@
+//  bg_contrast.cpp  –  Better Cursor Finder (BCF)
+//  The SIMD paths keep per-row sums in 32-bit lanes and fold them into the 64-bit totals
+//  after each row; rows are capped so a lane cannot overflow.
+
+#include "bg_contrast.h"
+#include "cpu_features.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(BCF_SSE2)
+  #include <emmintrin.h>
+  #include <immintrin.h>
+#endif
+
+// A lane sees at most a quarter of a chunk: 1024 x 255^2 stays well below 2^32.
+static const int ROW_CHUNK = 4096;
+
+float LumaStdDev(const LumaStats&s)
+{
+    if(!s.n)return 0.f;
+    double m=(double)s.sum/s.n;
+    return (float)sqrt(std::max(0.0,(double)s.sumSq/s.n-m*m));
+}
+
+//  SCALAR
+static void RowScalar(const uint32_t*p,int n,LumaStats&o)
+{
+    uint64_t s=0, q=0;
+    for(int i=0;i<n;i++){
+        uint32_t c=p[i];
+        uint32_t y=(54*(c>>16&255)+183*(c>>8&255)+19*(c&255)+128)>>8;
+        s+=y; q+=y*y;
+    }
+    o.n+=(uint64_t)n; o.sum+=s; o.sumSq+=q;
+}
+
+#if defined(BCF_SSE2)
+//  SSE2  (4 lanes)
+static void RowSSE2(const uint32_t*p,int n,LumaStats&o)
+{
+    const __m128i m8=_mm_set1_epi32(255), kr=_mm_set1_epi32(54), kg=_mm_set1_epi32(183), kb=_mm_set1_epi32(19);
+    const __m128i rnd=_mm_set1_epi32(128);
+    __m128i s=_mm_setzero_si128(), q=_mm_setzero_si128();
+    int i=0;
+    for(;i+4<=n;i+=4){
+        __m128i c=_mm_loadu_si128((const __m128i*)(p+i));
+        // 16-bit multiplies are exact here: channel * weight < 2^16, the products fit 32 bits.
+        __m128i r=_mm_and_si128(_mm_srli_epi32(c,16),m8), g=_mm_and_si128(_mm_srli_epi32(c,8),m8), b=_mm_and_si128(c,m8);
+        __m128i y=_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(r,kr),_mm_madd_epi16(g,kg)),_mm_add_epi32(_mm_madd_epi16(b,kb),rnd));
+        y=_mm_srli_epi32(y,8);
+        s=_mm_add_epi32(s,y); q=_mm_add_epi32(q,_mm_madd_epi16(y,y));
+    }
+    alignas(16) uint32_t ls[4], lq[4];
+    _mm_store_si128((__m128i*)ls,s); _mm_store_si128((__m128i*)lq,q);
+    o.n+=(uint64_t)i;
+    for(int k=0;k<4;k++){o.sum+=ls[k];o.sumSq+=lq[k];}
+    RowScalar(p+i,n-i,o);
+}
+#endif
+
+#if defined(BCF_AVX2)
+//  AVX2  (8 lanes)
+BCF_AVX2_FN static void RowAVX2(const uint32_t*p,int n,LumaStats&o)
+{
+    const __m256i m8=_mm256_set1_epi32(255), kr=_mm256_set1_epi32(54), kg=_mm256_set1_epi32(183), kb=_mm256_set1_epi32(19);
+    const __m256i rnd=_mm256_set1_epi32(128);
+    __m256i s=_mm256_setzero_si256(), q=_mm256_setzero_si256();
+    int i=0;
+    for(;i+8<=n;i+=8){
+        __m256i c=_mm256_loadu_si256((const __m256i*)(p+i));
+        __m256i r=_mm256_and_si256(_mm256_srli_epi32(c,16),m8), g=_mm256_and_si256(_mm256_srli_epi32(c,8),m8), b=_mm256_and_si256(c,m8);
+        __m256i y=_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(r,kr),_mm256_madd_epi16(g,kg)),
+                                   _mm256_add_epi32(_mm256_madd_epi16(b,kb),rnd));
+        y=_mm256_srli_epi32(y,8);
+        s=_mm256_add_epi32(s,y); q=_mm256_add_epi32(q,_mm256_madd_epi16(y,y));
+    }
+    alignas(32) uint32_t ls[8], lq[8];
+    _mm256_store_si256((__m256i*)ls,s); _mm256_store_si256((__m256i*)lq,q);
+    o.n+=(uint64_t)i;
+    for(int k=0;k<8;k++){o.sum+=ls[k];o.sumSq+=lq[k];}
+    RowScalar(p+i,n-i,o);
+}
+#endif
+
+//  DISPATCH
+typedef void(*RowFn)(const uint32_t*,int,LumaStats&);
+static RowFn PickRow(RasterPath path)
+{
+    if(path==RP_AUTO)path=RasterBestPath();
+#if defined(BCF_AVX2)
+    if(path==RP_AVX2&&CpuHasAVX2())return RowAVX2;
+#endif
+#if defined(BCF_SSE2)
+    if(path!=RP_SCALAR)return RowSSE2;
+#endif
+    return RowScalar;
+}
+
+void LumaMeasure(const uint32_t*bits,int w,int h,int stride,int step,LumaStats&out,RasterPath path)
+{
+    RowFn row=PickRow(path);
+    step=std::max(1,step);
+    for(int y=0;y<h;y+=step)
+        for(int x=0;x<w;x+=ROW_CHUNK)row(bits+(size_t)y*stride+x,std::min(ROW_CHUNK,w-x),out);
+}
+
+//  CHOICE
+static int Delta(uint32_t c,int bg){return abs(ColorLuma(c)-bg);}
+
+ContrastChoice ContrastPick(const LumaStats&bg,uint32_t ring,uint32_t outline,ContrastChoice cur,
+                            const ContrastPolicy&pol)
+{
+    if(!bg.n)return cur;
+    const int m=(int)lroundf(LumaMean(bg));
+    int score[4];
+    for(int c=0;c<4;c++){uint32_t r=ring,o=outline;ContrastColors((ContrastChoice)c,r,o);score[c]=Delta(r,m);}
+    if(score[CC_CONFIG]>=pol.okDelta)return CC_CONFIG;
+    // The configured colours first, then the swap, then black or white; ties keep the earlier.
+    int best=CC_CONFIG;
+    for(int c=1;c<4;c++)if(score[c]>score[best])best=c;
+    if(best!=cur&&score[best]<score[cur]+pol.hystDelta)return cur;
+    return (ContrastChoice)best;
+}
+
+void ContrastColors(ContrastChoice c,uint32_t&ring,uint32_t&outline)
+{
+    switch(c){
+    case CC_CONFIG: break;
+    case CC_SWAP:   std::swap(ring,outline); break;
+    case CC_LIGHT:  ring=0x00FFFFFF; outline=0; break;
+    case CC_DARK:   ring=0; outline=0x00FFFFFF; break;
+    }
+}
+
+const char*ContrastName(int c)
+{
+    static const char*n[]={"configured","swapped","light","dark"};
+    return c>=0&&c<4?n[c]:"?";
+}
@@ -0,0 +1,38 @@
+//  bg_contrast.h  –  Better Cursor Finder (BCF)
+//  Auto-contrast: the luminance of the screen under the overlay, measured on every Nth row
+//  of a capture, and the ring / outline pair that stands out best against it. Luma is the
+//  Rec. 709 weighting of the 8-bit channels, (54 R + 183 G + 19 B + 128) >> 8, in integers so
+//  every path produces the same sums. No Windows headers.
+#pragma once
+#include "ring_raster.h"
+#include <cstdint>
+
+struct LumaStats { uint64_t n = 0, sum = 0, sumSq = 0; };
+
+static inline int ColorLuma(uint32_t c)             // COLORREF layout, 0x00BBGGRR
+{
+    return (int)((54*(c&255)+183*(c>>8&255)+19*(c>>16&255)+128)>>8);
+}
+static inline float LumaMean  (const LumaStats&s){return s.n?(float)s.sum/s.n:0.f;}
+float LumaStdDev(const LumaStats&s);
+
+// Adds rows 0, step, 2*step ... of a BGRA capture (alpha ignored) to `out`.
+void LumaMeasure(const uint32_t*bits,int w,int h,int stride,int step,LumaStats&out,RasterPath path=RP_AUTO);
+
+enum ContrastChoice : uint8_t {
+    CC_CONFIG,          // the configured colours
+    CC_SWAP,            // ring and outline colours exchanged
+    CC_LIGHT,           // white ring, black outline
+    CC_DARK,            // black ring, white outline
+};
+struct ContrastPolicy {
+    int okDelta  = 96;  // ring luma this far from the background keeps the configured colours
+    int hystDelta = 24; // a new choice must beat the current one by this much
+};
+
+// Picks the ring colours for a background; `cur` is what is on screen now, so small changes
+// in the background do not flip the ring back and forth.
+ContrastChoice ContrastPick(const LumaStats&bg,uint32_t ring,uint32_t outline,ContrastChoice cur,
+                            const ContrastPolicy&pol=ContrastPolicy());
+void        ContrastColors(ContrastChoice c,uint32_t&ring,uint32_t&outline);
+const char* ContrastName(int c);
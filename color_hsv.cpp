@@ -0,0 +1,198 @@
+//  color_hsv.cpp  –  Better Cursor Finder (BCF)
+//  The SIMD kernels evaluate the same p/q/t expressions as HSVtoRGB in the same order and
+//  pick the sector with masks instead of a switch, so every lane rounds exactly like the
+//  scalar code. The fmodf is replaced by h-360*floor(h/360) plus a one-step fix-up that also
+//  absorbs the rounding of the reciprocal, exact for hues in -360..720 (all the picker makes).
+
+#include "color_hsv.h"
+#include "cpu_features.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(BCF_SSE2)
+  #include <emmintrin.h>
+  #include <immintrin.h>
+#endif
+
+uint32_t HSVtoRGB(float h,float s,float v)
+{
+    if(s<=0){uint32_t c=(uint32_t)(int)(v*255+.5f)&0xFF;return c|c<<8|c<<16;}
+    h=fmodf(h,360.0f); if(h<0)h+=360.0f; h/=60.0f;
+    int i=(int)h; float f=h-i;
+    float p=v*(1-s),q=v*(1-s*f),t=v*(1-s*(1-f));
+    float r,g,b;
+    switch(i){
+        case 0:r=v;g=t;b=p;break; case 1:r=q;g=v;b=p;break;
+        case 2:r=p;g=v;b=t;break; case 3:r=p;g=q;b=v;break;
+        case 4:r=t;g=p;b=v;break; default:r=v;g=p;b=q;break;
+    }
+    return ((uint32_t)(int)(r*255+.5f)&0xFF)|((uint32_t)(int)(g*255+.5f)&0xFF)<<8|
+           ((uint32_t)(int)(b*255+.5f)&0xFF)<<16;
+}
+
+void RGBtoHSV(uint32_t c,float&h,float&s,float&v)
+{
+    float r=(c&0xFF)/255.f,g=((c>>8)&0xFF)/255.f,b=((c>>16)&0xFF)/255.f;
+    float mx=std::max({r,g,b}),mn=std::min({r,g,b});
+    v=mx; float d=mx-mn;
+    s=(mx<1e-6f)?0:d/mx;
+    if(s<1e-6f){h=0;return;}
+    if(mx==r)h=60*(g-b)/d; else if(mx==g)h=60*(b-r)/d+120; else h=60*(r-g)/d+240;
+    if(h<0)h+=360;
+}
+
+//  SCALAR
+static float RampAt(float x0,float x1,int i,float den){return x0+(x1-x0)*((float)i/den);}
+
+static void RowScalar(uint32_t*dst,int n,const HsvRamp&rp)
+{
+    const float den=n>1?(float)(n-1):1.f;
+    for(int i=0;i<n;i++)
+        dst[i]=ColorToBGRA(HSVtoRGB(RampAt(rp.h0,rp.h1,i,den),RampAt(rp.s0,rp.s1,i,den),RampAt(rp.v0,rp.v1,i,den)));
+}
+static void ArrScalar(uint32_t*dst,const float*h,const float*s,const float*v,int n)
+{
+    for(int i=0;i<n;i++)dst[i]=ColorToBGRA(HSVtoRGB(h[i],s[i],v[i]));
+}
+
+#if defined(BCF_SSE2)
+//  SSE2  (4 lanes)
+static inline __m128 Sel4(__m128 m,__m128 a,__m128 b){return _mm_or_ps(_mm_and_ps(m,a),_mm_andnot_ps(m,b));}
+static inline __m128 Floor4(__m128 x){
+    __m128 t=_mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t,_mm_and_ps(_mm_cmpgt_ps(t,x),_mm_set1_ps(1.f)));
+}
+static inline __m128i Hsv4(__m128 h,__m128 s,__m128 v)
+{
+    const __m128 k360=_mm_set1_ps(360.f), one=_mm_set1_ps(1.f), zero=_mm_setzero_ps();
+    s=_mm_max_ps(s,zero);                                   // s<=0 is grey: p=q=t=v
+    h=_mm_sub_ps(h,_mm_mul_ps(Floor4(_mm_mul_ps(h,_mm_set1_ps(1.f/360.f))),k360));
+    h=_mm_add_ps(h,_mm_and_ps(_mm_cmplt_ps(h,zero),k360));
+    h=_mm_sub_ps(h,_mm_and_ps(_mm_cmpge_ps(h,k360),k360));
+    h=_mm_div_ps(h,_mm_set1_ps(60.f));
+    __m128i i=_mm_cvttps_epi32(h);
+    __m128  f=_mm_sub_ps(h,_mm_cvtepi32_ps(i));
+    __m128 p=_mm_mul_ps(v,_mm_sub_ps(one,s));
+    __m128 q=_mm_mul_ps(v,_mm_sub_ps(one,_mm_mul_ps(s,f)));
+    __m128 t=_mm_mul_ps(v,_mm_sub_ps(one,_mm_mul_ps(s,_mm_sub_ps(one,f))));
+    __m128 m0=_mm_castsi128_ps(_mm_cmpeq_epi32(i,_mm_set1_epi32(0)));
+    __m128 m1=_mm_castsi128_ps(_mm_cmpeq_epi32(i,_mm_set1_epi32(1)));
+    __m128 m2=_mm_castsi128_ps(_mm_cmpeq_epi32(i,_mm_set1_epi32(2)));
+    __m128 m3=_mm_castsi128_ps(_mm_cmpeq_epi32(i,_mm_set1_epi32(3)));
+    __m128 m4=_mm_castsi128_ps(_mm_cmpeq_epi32(i,_mm_set1_epi32(4)));
+    // Sector table as in HSVtoRGB; the default row (5) is the fall-through value.
+    __m128 r=Sel4(m0,v,Sel4(m1,q,Sel4(m2,p,Sel4(m3,p,Sel4(m4,t,v)))));
+    __m128 g=Sel4(m0,t,Sel4(m1,v,Sel4(m2,v,Sel4(m3,q,p))));
+    __m128 b=Sel4(m0,p,Sel4(m1,p,Sel4(m2,t,Sel4(m3,v,Sel4(m4,v,q)))));
+    const __m128 k255=_mm_set1_ps(255.f), half=_mm_set1_ps(.5f), mask=_mm_castsi128_ps(_mm_set1_epi32(0xFF));
+    __m128i ri=_mm_and_si128(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r,k255),half)),_mm_castps_si128(mask));
+    __m128i gi=_mm_and_si128(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g,k255),half)),_mm_castps_si128(mask));
+    __m128i bi=_mm_and_si128(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b,k255),half)),_mm_castps_si128(mask));
+    return _mm_or_si128(_mm_or_si128(_mm_set1_epi32((int)0xFF000000),_mm_slli_epi32(ri,16)),
+                        _mm_or_si128(_mm_slli_epi32(gi,8),bi));
+}
+static inline __m128 Ramp4(float x0,float x1,__m128 t){return _mm_add_ps(_mm_set1_ps(x0),_mm_mul_ps(_mm_set1_ps(x1-x0),t));}
+
+static void RowSSE2(uint32_t*dst,int n,const HsvRamp&rp)
+{
+    const float den=n>1?(float)(n-1):1.f;
+    const __m128 vden=_mm_set1_ps(den);
+    __m128i idx=_mm_setr_epi32(0,1,2,3);
+    int i=0;
+    for(;i+4<=n;i+=4,idx=_mm_add_epi32(idx,_mm_set1_epi32(4))){
+        __m128 t=_mm_div_ps(_mm_cvtepi32_ps(idx),vden);
+        _mm_storeu_si128((__m128i*)(dst+i),Hsv4(Ramp4(rp.h0,rp.h1,t),Ramp4(rp.s0,rp.s1,t),Ramp4(rp.v0,rp.v1,t)));
+    }
+    for(;i<n;i++)
+        dst[i]=ColorToBGRA(HSVtoRGB(RampAt(rp.h0,rp.h1,i,den),RampAt(rp.s0,rp.s1,i,den),RampAt(rp.v0,rp.v1,i,den)));
+}
+static void ArrSSE2(uint32_t*dst,const float*h,const float*s,const float*v,int n)
+{
+    int i=0;
+    for(;i+4<=n;i+=4)
+        _mm_storeu_si128((__m128i*)(dst+i),Hsv4(_mm_loadu_ps(h+i),_mm_loadu_ps(s+i),_mm_loadu_ps(v+i)));
+    ArrScalar(dst+i,h+i,s+i,v+i,n-i);
+}
+#endif
+
+#if defined(BCF_AVX2)
+//  AVX2  (8 lanes)
+BCF_AVX2_FN static inline __m256i Hsv8(__m256 h,__m256 s,__m256 v)
+{
+    const __m256 k360=_mm256_set1_ps(360.f), one=_mm256_set1_ps(1.f), zero=_mm256_setzero_ps();
+    s=_mm256_max_ps(s,zero);
+    h=_mm256_sub_ps(h,_mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(h,_mm256_set1_ps(1.f/360.f))),k360));
+    h=_mm256_add_ps(h,_mm256_and_ps(_mm256_cmp_ps(h,zero,_CMP_LT_OQ),k360));
+    h=_mm256_sub_ps(h,_mm256_and_ps(_mm256_cmp_ps(h,k360,_CMP_GE_OQ),k360));
+    h=_mm256_div_ps(h,_mm256_set1_ps(60.f));
+    __m256i i=_mm256_cvttps_epi32(h);
+    __m256  f=_mm256_sub_ps(h,_mm256_cvtepi32_ps(i));
+    __m256 p=_mm256_mul_ps(v,_mm256_sub_ps(one,s));
+    __m256 q=_mm256_mul_ps(v,_mm256_sub_ps(one,_mm256_mul_ps(s,f)));
+    __m256 t=_mm256_mul_ps(v,_mm256_sub_ps(one,_mm256_mul_ps(s,_mm256_sub_ps(one,f))));
+    __m256 m0=_mm256_castsi256_ps(_mm256_cmpeq_epi32(i,_mm256_set1_epi32(0)));
+    __m256 m1=_mm256_castsi256_ps(_mm256_cmpeq_epi32(i,_mm256_set1_epi32(1)));
+    __m256 m2=_mm256_castsi256_ps(_mm256_cmpeq_epi32(i,_mm256_set1_epi32(2)));
+    __m256 m3=_mm256_castsi256_ps(_mm256_cmpeq_epi32(i,_mm256_set1_epi32(3)));
+    __m256 m4=_mm256_castsi256_ps(_mm256_cmpeq_epi32(i,_mm256_set1_epi32(4)));
+    __m256 r=_mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(v,t,m4),p,m3),p,m2),q,m1),v,m0);
+    __m256 g=_mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(p,q,m3),v,m2),v,m1),t,m0);
+    __m256 b=_mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(_mm256_blendv_ps(q,v,m4),v,m3),t,m2),p,m1),p,m0);
+    const __m256 k255=_mm256_set1_ps(255.f), half=_mm256_set1_ps(.5f);
+    const __m256i mask=_mm256_set1_epi32(0xFF);
+    __m256i ri=_mm256_and_si256(_mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(r,k255),half)),mask);
+    __m256i gi=_mm256_and_si256(_mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(g,k255),half)),mask);
+    __m256i bi=_mm256_and_si256(_mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(b,k255),half)),mask);
+    return _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi32((int)0xFF000000),_mm256_slli_epi32(ri,16)),
+                           _mm256_or_si256(_mm256_slli_epi32(gi,8),bi));
+}
+BCF_AVX2_FN static inline __m256 Ramp8(float x0,float x1,__m256 t){
+    return _mm256_add_ps(_mm256_set1_ps(x0),_mm256_mul_ps(_mm256_set1_ps(x1-x0),t));
+}
+
+BCF_AVX2_FN static void RowAVX2(uint32_t*dst,int n,const HsvRamp&rp)
+{
+    const float den=n>1?(float)(n-1):1.f;
+    const __m256 vden=_mm256_set1_ps(den);
+    __m256i idx=_mm256_setr_epi32(0,1,2,3,4,5,6,7);
+    int i=0;
+    for(;i+8<=n;i+=8,idx=_mm256_add_epi32(idx,_mm256_set1_epi32(8))){
+        __m256 t=_mm256_div_ps(_mm256_cvtepi32_ps(idx),vden);
+        _mm256_storeu_si256((__m256i*)(dst+i),Hsv8(Ramp8(rp.h0,rp.h1,t),Ramp8(rp.s0,rp.s1,t),Ramp8(rp.v0,rp.v1,t)));
+    }
+    for(;i<n;i++)
+        dst[i]=ColorToBGRA(HSVtoRGB(RampAt(rp.h0,rp.h1,i,den),RampAt(rp.s0,rp.s1,i,den),RampAt(rp.v0,rp.v1,i,den)));
+}
+BCF_AVX2_FN static void ArrAVX2(uint32_t*dst,const float*h,const float*s,const float*v,int n)
+{
+    int i=0;
+    for(;i+8<=n;i+=8)
+        _mm256_storeu_si256((__m256i*)(dst+i),Hsv8(_mm256_loadu_ps(h+i),_mm256_loadu_ps(s+i),_mm256_loadu_ps(v+i)));
+    ArrScalar(dst+i,h+i,s+i,v+i,n-i);
+}
+#endif
+
+//  DISPATCH
+void HsvRowToBGRA(uint32_t*dst,int n,const HsvRamp&ramp,RasterPath path)
+{
+    if(path==RP_AUTO)path=RasterBestPath();
+#if defined(BCF_AVX2)
+    if(path==RP_AVX2&&CpuHasAVX2()){RowAVX2(dst,n,ramp);return;}
+#endif
+#if defined(BCF_SSE2)
+    if(path!=RP_SCALAR){RowSSE2(dst,n,ramp);return;}
+#endif
+    RowScalar(dst,n,ramp);
+}
+
+void HsvToBGRA(uint32_t*dst,const float*h,const float*s,const float*v,int n,RasterPath path)
+{
+    if(path==RP_AUTO)path=RasterBestPath();
+#if defined(BCF_AVX2)
+    if(path==RP_AVX2&&CpuHasAVX2()){ArrAVX2(dst,h,s,v,n);return;}
+#endif
+#if defined(BCF_SSE2)
+    if(path!=RP_SCALAR){ArrSSE2(dst,h,s,v,n);return;}
+#endif
+    ArrScalar(dst,h,s,v,n);
+}
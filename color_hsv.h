@@ -0,0 +1,22 @@
+//  color_hsv.h  –  Better Cursor Finder (BCF)
+//  HSV <-> RGB for the colour picker, plus batch kernels that fill rows of opaque BGRA
+//  (GDI+ 32bppARGB / DIB order). The batch output matches HSVtoRGB bit for bit.
+//  No Windows headers.
+#pragma once
+#include <cstdint>
+#include "ring_raster.h"
+
+// h in degrees, s and v in 0..1. Colours use the COLORREF layout 0x00BBGGRR.
+uint32_t HSVtoRGB(float h,float s,float v);
+void     RGBtoHSV(uint32_t c,float&h,float&s,float&v);
+
+static inline uint32_t ColorToBGRA(uint32_t c){
+    return 0xFF000000u|((c&0xFF)<<16)|(c&0xFF00)|((c>>16)&0xFF);
+}
+
+// Each channel runs linearly from *0 at pixel 0 to *1 at pixel n-1, evaluated as
+// x0+(x1-x0)*(i/(n-1)) so a ramp from 0 to 1 lands on exactly i/(n-1).
+struct HsvRamp { float h0, h1, s0, s1, v0, v1; };
+
+void HsvRowToBGRA(uint32_t*dst,int n,const HsvRamp&ramp,RasterPath path=RP_AUTO);
+void HsvToBGRA(uint32_t*dst,const float*h,const float*s,const float*v,int n,RasterPath path=RP_AUTO);
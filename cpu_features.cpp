@@ -0,0 +1,31 @@
+//  cpu_features.cpp  –  Better Cursor Finder (BCF)
+
+#include "cpu_features.h"
+
+#if defined(BCF_AVX2)&&defined(_MSC_VER)&&!defined(__clang__)
+  #include <intrin.h>
+  #include <immintrin.h>
+#endif
+
+static bool DetectAVX2()
+{
+#if !defined(BCF_AVX2)
+    return false;
+#elif defined(_MSC_VER)&&!defined(__clang__)
+    int r[4]; __cpuid(r,0); if(r[0]<7)return false;
+    __cpuid(r,1);
+    bool osxsave=(r[2]&(1<<27))!=0, avx=(r[2]&(1<<28))!=0;
+    if(!osxsave||!avx)return false;
+    if((_xgetbv(0)&6)!=6)return false;              // XMM+YMM state enabled by the OS
+    __cpuidex(r,7,0); return (r[1]&(1<<5))!=0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool CpuHasAVX2()
+{
+    static const bool has=DetectAVX2();
+    return has;
+}
@@ -0,0 +1,23 @@
+//  cpu_features.h  –  Better Cursor Finder (BCF)
+//  Compile-time SIMD availability and runtime AVX2 detection for the portable kernels.
+#pragma once
+
+#if defined(_M_X64)||defined(_M_IX86)||defined(__x86_64__)||defined(__i386__)
+  #define BCF_X86 1
+#endif
+
+#if defined(BCF_X86)&&(defined(__SSE2__)||defined(_M_X64)||(defined(_M_IX86_FP)&&_M_IX86_FP>=2))
+  #define BCF_SSE2 1
+#endif
+
+// AVX2 kernels are always compiled on x86 and selected at runtime.
+#if defined(BCF_SSE2)
+  #define BCF_AVX2 1
+  #if defined(_MSC_VER)&&!defined(__clang__)
+    #define BCF_AVX2_FN
+  #else
+    #define BCF_AVX2_FN __attribute__((target("avx2")))
+  #endif
+#endif
+
+bool CpuHasAVX2();
@@ -0,0 +1,53 @@
+//  ctrl_tap.cpp  –  Better Cursor Finder (BCF)
+
+#include "ctrl_tap.h"
+
+static KeyBits WithCtrl(const KeyBits&held)
+{
+    KeyBits k=held;
+    KeyBits_Set(k,TAP_VK_CONTROL,true); KeyBits_Set(k,TAP_VK_LCONTROL,true); KeyBits_Set(k,TAP_VK_RCONTROL,true);
+    return k;
+}
+
+TapAction Tap_Key(CtrlTap&t,int vk,bool isDown,bool animating)
+{
+    if(vk<=0||vk>255)return TAP_NONE;
+    KeyBits_Set(t.down,vk,isDown);
+    bool ctrlDown=KeyBits_Test(t.down,TAP_VK_CONTROL)||KeyBits_Test(t.down,TAP_VK_LCONTROL)||
+                  KeyBits_Test(t.down,TAP_VK_RCONTROL);
+
+    if(ctrlDown&&!t.ctrlWas){
+        t.comboDetected=false;
+        t.known=WithCtrl(t.down);
+    }
+    bool fresh=isDown&&!KeyBits_Test(t.known,vk);
+    if(ctrlDown&&fresh)t.comboDetected=true;
+
+    TapAction a=TAP_NONE;
+    if(!ctrlDown&&t.ctrlWas){
+        if(!t.comboDetected)a=TAP_TRIGGER;
+        t.comboDetected=false;
+    }
+    t.ctrlWas=ctrlDown;
+    if(a==TAP_NONE&&animating&&fresh)a=TAP_CANCEL;
+    return a;
+}
+
+TapAction Tap_Poll(CtrlTap&t,const KeyBits&held,bool animating)
+{
+    bool ctrlDown=KeyBits_Test(held,TAP_VK_CONTROL);
+    if(ctrlDown&&!t.ctrlWas){
+        t.comboDetected=false;
+        t.known=WithCtrl(held);
+    }
+    if(ctrlDown&&!t.comboDetected&&KeyBits_AnyNew(held,t.known))t.comboDetected=true;
+
+    TapAction a=TAP_NONE;
+    if(!ctrlDown&&t.ctrlWas){
+        if(!t.comboDetected)a=TAP_TRIGGER;
+        t.comboDetected=false;
+    }
+    t.ctrlWas=ctrlDown;
+    if(a==TAP_NONE&&animating&&KeyBits_AnyNew(held,t.known))a=TAP_CANCEL;
+    return a;
+}
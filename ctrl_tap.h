@@ -0,0 +1,25 @@
+//  ctrl_tap.h  –  Better Cursor Finder (BCF)
+//  Bare-Ctrl-tap detection, driven either by key events (hook) or by held-key snapshots
+//  (polling). No Windows headers, so recorded or synthetic key traces can drive it.
+#pragma once
+#include "key_bits.h"
+
+enum { TAP_VK_CONTROL=0x11, TAP_VK_LCONTROL=0xA2, TAP_VK_RCONTROL=0xA3 };
+
+enum TapAction { TAP_NONE, TAP_TRIGGER, TAP_CANCEL };
+
+struct CtrlTap {
+    KeyBits down;                 // event mode: keys currently held
+    KeyBits known;                // keys held when Ctrl went down, plus the Ctrl keys themselves
+    bool    ctrlWas       = false;
+    bool    comboDetected = false;
+};
+
+static inline bool Tap_IsCtrl(int vk){return vk==TAP_VK_CONTROL||vk==TAP_VK_LCONTROL||vk==TAP_VK_RCONTROL;}
+
+// One key (or mouse button) transition. A Ctrl release with no other new key pressed while
+// it was held triggers; a new key going down while animating cancels.
+TapAction Tap_Key(CtrlTap&t,int vk,bool isDown,bool animating);
+
+// One polling tick with the full set of held virtual keys (bit VK_CONTROL is the generic Ctrl).
+TapAction Tap_Poll(CtrlTap&t,const KeyBits&held,bool animating);
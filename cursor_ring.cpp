@@ -2,22 +2,57 @@
 //  @mattytheprofessional
 
 #define WIN32_LEAN_AND_MEAN
+#ifndef _WIN32_WINNT
+  #define _WIN32_WINNT 0x0A00
+#endif
 #include <windows.h>
 #include <windowsx.h>
 #include <shellapi.h>
+#include <psapi.h>
+#include <shellscalingapi.h>
 #ifndef PROPID
   typedef ULONG PROPID;
 #endif
+#ifndef WM_DPICHANGED
+  #define WM_DPICHANGED 0x02E0
+#endif
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+  #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
 #include <gdiplus.h>
+#include <dwmapi.h>
 #include <cmath>
 #include <algorithm>
 #include <string>
 #include <cstdio>
+#include <cstring>
+#include "ring_raster.h"
+#include "ring_atlas.h"
+#include "ring_anim.h"
+#include "overlay_damage.h"
+#include "ctrl_tap.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "color_hsv.h"
+#include "settings_store.h"
+#include "render_channel.h"
+#include "motion_predict.h"
+#include "trace_log.h"
+#include "spotlight.h"
+#include "bcf_icon.h"
+#include "frame_governor.h"
+#include "cursor_trail.h"
+#include "bg_contrast.h"
+#include "shake_detect.h"
+#include "ipc_channel.h"
 
 #pragma comment(lib,"user32.lib")
 #pragma comment(lib,"gdi32.lib")
 #pragma comment(lib,"gdiplus.lib")
 #pragma comment(lib,"shell32.lib")
+#pragma comment(lib,"dwmapi.lib")
+#pragma comment(lib,"psapi.lib")
+#pragma comment(lib,"shcore.lib")
 
 using namespace Gdiplus;
 #ifndef M_PI
@@ -32,31 +67,67 @@ struct AppSettings {
     bool     moveCancel   = true;
     bool     darkMode     = true;
     bool     startOnBoot  = false;
+    int      prediction   = 50;      // % the ring leads the pointer towards the present time
+    int      mode         = LOCATE_RING;
+    bool     trail        = false;   // fading tail behind the pointer while it moves fast
+    bool     autoContrast = false;   // swap or replace the ring colours when they vanish on the background
+    bool     shake        = false;   // shaking the mouse starts the locate animation
+    int      glowRadius   = 9;       // logical px the glow reaches past the ring, 0 = none
+    int      glowStrength = 45;      // % opacity of the glow at the ring
 };
+static const int GLOW_MAX_PX = 24;       // keeps the largest ring's glow inside the overlay
 static AppSettings g_cfg;
 
+//  RENDER CHANNEL
+// The overlay is drawn on its own thread so a slow repaint or a modal menu on the UI thread
+// never stalls the ring. The UI thread reaches it only through g_chan (commands plus config
+// snapshots) and the auto-reset wake event; g_rcfg is the render thread's current snapshot.
+static RenderChannel g_chan;
+static RenderConfig  g_rcfg;
+static HANDLE g_renderWake   = nullptr;
+static HANDLE g_renderThread = nullptr;
+static HWND   g_hwndRing     = nullptr;   // layered ring window, owned by the render thread
+
+static void Render_Send(RenderCmdType t,int x=0,int y=0,int64_t tNs=0){Chan_Send(g_chan,t,x,y,tNs);if(g_renderWake)SetEvent(g_renderWake);}
+static PowerSource g_power = POWER_AC;     // UI thread; re-read on power broadcasts and triggers
+static void PublishConfig(){
+    RenderConfig c;
+    c.ringColor=g_cfg.ringColor; c.outlineColor=g_cfg.outlineColor;
+    c.speed=g_cfg.speed; c.moveCancel=g_cfg.moveCancel; c.prediction=g_cfg.prediction;
+    c.mode=g_cfg.mode; c.power=g_power; c.trail=g_cfg.trail;
+    c.autoContrast=g_cfg.autoContrast;
+    c.glowRadius=g_cfg.glowRadius; c.glowStrength=g_cfg.glowStrength;
+    Chan_Publish(g_chan,c); Render_Send(RC_CONFIG);
+}
+
 //  GLOBALS
 static HWND  g_hwndOverlay  = nullptr;
 static HWND  g_hwndSettings = nullptr;
-static bool  g_animating     = false;
-static bool  g_ctrlWas       = false;
-static bool  g_comboDetected = false;
-static DWORD g_startTime     = 0;
+static std::atomic<bool> g_animating{false};   // written by the render thread
+static CtrlTap g_tap;
 static POINT g_cursor        = {};
 static POINT g_animStart     = {};
-static bool  g_preExisting[256] = {};
+static HANDLE g_frameTimer   = nullptr;
+static HHOOK g_kbHook        = nullptr;
+static bool  g_rawMouse      = false;
+static ShakeDetector g_shake;                  // fed from raw mouse input, UI thread
 static NOTIFYICONDATA g_nid  = {};
 static bool  g_settingsOpen  = false;
 static HICON g_hBCFIcon      = nullptr;
 
-static const float ANIM_MAX_R = 88.0f;
-static const float ANIM_MIN_R = 3.0f;
 static const int   OV_SIZE    = 240;
 static const float STROKE_W   = 2.5f;
-static const int   MOVE_THR   = 4;
 static const int   SW_W       = 340;
 static const int   SW_H       = 502;
 static const UINT  WM_TRAY    = WM_APP + 1;
+static const UINT  WM_BCF_TAP = WM_APP + 2;
+static const UINT  WM_BCF_PREWARM = WM_APP + 3;
+static const UINT  WM_BCF_ANIM    = WM_APP + 4;   // render thread -> UI: animation started / ended
+static const UINT  WM_BCF_STATS   = WM_APP + 5;   // render thread -> UI: stats report written
+static const UINT  WM_BCF_IPC     = WM_APP + 6;   // IPC thread -> UI, sent: lParam is an IpcCall
+static const UINT_PTR TRACE_TIMER = 1;           // overlay window: drain the trace rings
+static const UINT  TRACE_DRAIN_MS = 250;
+static const int   FRAME_MS   = 6;
 static const UINT  TRAY_ID    = 1;
 
 
@@ -69,6 +140,7 @@ static RECT g_rcGithub;
 //  COLOR PICKER STATE
 static const int CP_W = 300;
 static const int CP_H = 388;
+static const UINT_PTR CP_FLUSH_TIMER = 1;
 
 struct CPState {
     HWND     hwnd         = nullptr;
@@ -82,60 +154,110 @@ struct CPState {
     bool     draggingHue  = false;
     bool     suppressEdit = false;
     RECT     rcSV, rcHue, rcOld, rcNew, rcOK, rcCancel;
+
+    // Cached layers, built when the picker opens and freed with it.
+    HDC      chromeDC     = nullptr;   // background, hue bar, labels, original swatch, buttons
+    HBITMAP  chromeBmp    = nullptr, chromeOld = nullptr;
+    HDC      svDC         = nullptr;   // SV gradient for svHue
+    HBITMAP  svBmp        = nullptr, svOld = nullptr;
+    uint32_t*svBits       = nullptr;
+    float    svHue        = -1;
+    HDC      backDC       = nullptr;   // composed frame; only the paint rect is recomposed
+    HBITMAP  backBmp      = nullptr, backOld = nullptr;
+    RECT     rcSelSV      = {}, rcSelHue = {};      // selector bounds last invalidated
+
+    // Drag coalescing: moves are applied at most once per display refresh.
+    POINT    pendingPt    = {};
+    bool     pending      = false;
+    bool     flushTimer   = false;
+    int64_t  lastFlushNs  = 0;
 };
 static CPState g_cp;
 
-//  HSV ↔ RGB
-static inline float Clamp01(float v){return v<0?0:v>1?1:v;}
-
-static COLORREF HSVtoRGB(float h,float s,float v)
-{
-    if(s<=0){int c=(int)(v*255+.5f);return RGB(c,c,c);}
-    h=fmodf(h,360.0f); if(h<0)h+=360.0f; h/=60.0f;
-    int i=(int)h; float f=h-i;
-    float p=v*(1-s),q=v*(1-s*f),t=v*(1-s*(1-f));
-    float r,g,b;
-    switch(i){
-        case 0:r=v;g=t;b=p;break; case 1:r=q;g=v;b=p;break;
-        case 2:r=p;g=v;b=t;break; case 3:r=p;g=q;b=v;break;
-        case 4:r=t;g=p;b=v;break; default:r=v;g=p;b=q;break;
+//  REGISTRY
+// One REG_DWORD per value under HKCU\Software\CursorFinder; values the key already holds
+// are not rewritten.
+struct RegistryBackend : SettingsBackend {
+    SettingsValues last;
+    bool           haveLast = false;
+    const char* Name() override {return "registry";}
+    bool Load(SettingsValues&s) override {
+        HKEY k; if(RegOpenKeyExA(HKEY_CURRENT_USER,"Software\\CursorFinder",0,KEY_READ,&k))return false;
+        char name[64]; DWORD v;
+        for(DWORD i=0;;i++){
+            DWORD nl=sizeof(name),sz=4,type=0;
+            LONG r=RegEnumValueA(k,i,name,&nl,NULL,&type,(BYTE*)&v,&sz);
+            if(r==ERROR_NO_MORE_ITEMS)break;
+            if(r==ERROR_SUCCESS&&type==REG_DWORD&&sz==4)Settings_Set(s,name,v);
+        }
+        RegCloseKey(k); last=s; haveLast=true;
+        return true;
     }
-    return RGB((int)(r*255+.5f),(int)(g*255+.5f),(int)(b*255+.5f));
-}
-
-static void RGBtoHSV(COLORREF c,float&h,float&s,float&v)
-{
-    float r=GetRValue(c)/255.f,g=GetGValue(c)/255.f,b=GetBValue(c)/255.f;
-    float mx=std::max({r,g,b}),mn=std::min({r,g,b});
-    v=mx; float d=mx-mn;
-    s=(mx<1e-6f)?0:d/mx;
-    if(s<1e-6f){h=0;return;}
-    if(mx==r)h=60*(g-b)/d; else if(mx==g)h=60*(b-r)/d+120; else h=60*(r-g)/d+240;
-    if(h<0)h+=360;
-}
+    bool Save(const SettingsValues&s) override {
+        HKEY k; if(RegCreateKeyExA(HKEY_CURRENT_USER,"Software\\CursorFinder",0,NULL,0,KEY_WRITE,NULL,&k,NULL))return false;
+        bool ok=true;
+        for(int i=0;i<s.count;i++){
+            uint32_t old;
+            if(haveLast&&Settings_Get(last,s.v[i].name,old)&&old==s.v[i].value)continue;
+            DWORD v=s.v[i].value;
+            ok=RegSetValueExA(k,s.v[i].name,0,REG_DWORD,(BYTE*)&v,4)==ERROR_SUCCESS&&ok;
+        }
+        RegCloseKey(k);
+        if(ok){last=s;haveLast=true;}
+        return ok;
+    }
+};
 
-//  REGISTRY
-static void LoadSettings()
-{
-    HKEY k; if(RegOpenKeyExA(HKEY_CURRENT_USER,"Software\\CursorFinder",0,KEY_READ,&k)) return;
-    DWORD sz=4,v;
-#define RD(n,f) sz=4;if(!RegQueryValueExA(k,n,0,0,(BYTE*)&v,&sz))f=(decltype(f))v;
-    RD("RingColor",g_cfg.ringColor) RD("OutlineColor",g_cfg.outlineColor)
-    RD("Speed",g_cfg.speed) RD("MoveCancel",g_cfg.moveCancel)
-    RD("DarkMode",g_cfg.darkMode) RD("StartOnBoot",g_cfg.startOnBoot)
-#undef RD
-    RegCloseKey(k);
-}
-static void SaveSettings()
+//  SETTINGS STORE
+// BCF.ini next to the executable takes precedence over the registry, so a deployed file
+// configures every machine it is copied to. Writes happen on the store's worker thread.
+static const int       SETTINGS_DEBOUNCE_MS = 400;
+static RegistryBackend g_regBackend;
+static IniFileBackend  g_iniBackend("");
+static SettingsStore   g_store;
+static SettingsValues  g_loadedValues;    // as loaded, for the names this version does not know
+
+// Known names first, so a file full of unknown ones cannot crowd them out.
+static SettingsValues CurrentValues()
 {
-    HKEY k; RegCreateKeyExA(HKEY_CURRENT_USER,"Software\\CursorFinder",0,NULL,0,KEY_WRITE,NULL,&k,NULL);
-#define WD(n,x){DWORD _v=(DWORD)(x);RegSetValueExA(k,n,0,REG_DWORD,(BYTE*)&_v,4);}
+    SettingsValues s;
+#define WD(n,x) Settings_Set(s,n,(uint32_t)(x));
     WD("RingColor",g_cfg.ringColor) WD("OutlineColor",g_cfg.outlineColor)
     WD("Speed",g_cfg.speed) WD("MoveCancel",g_cfg.moveCancel)
     WD("DarkMode",g_cfg.darkMode) WD("StartOnBoot",g_cfg.startOnBoot)
+    WD("Prediction",g_cfg.prediction) WD("Mode",g_cfg.mode) WD("Trail",g_cfg.trail)
+    WD("AutoContrast",g_cfg.autoContrast) WD("Shake",g_cfg.shake)
+    WD("GlowRadius",g_cfg.glowRadius) WD("GlowStrength",g_cfg.glowStrength)
 #undef WD
-    RegCloseKey(k);
+    Settings_AddMissing(s,g_loadedValues);
+    return s;
 }
+static void LoadSettings()
+{
+    char p[MAX_PATH]; GetModuleFileNameA(NULL,p,MAX_PATH);
+    if(char*sl=strrchr(p,'\\'))sl[1]=0;
+    g_iniBackend.path=std::string(p)+"BCF.ini";
+    SettingsBackend*be=FileExists(g_iniBackend.path)?(SettingsBackend*)&g_iniBackend:&g_regBackend;
+
+    SettingsValues s; uint32_t v;
+    if(be->Load(s)){
+#define RD(n,f) if(Settings_Get(s,n,v))f=(decltype(f))v;
+        RD("RingColor",g_cfg.ringColor) RD("OutlineColor",g_cfg.outlineColor)
+        RD("Speed",g_cfg.speed) RD("MoveCancel",g_cfg.moveCancel)
+        RD("DarkMode",g_cfg.darkMode) RD("StartOnBoot",g_cfg.startOnBoot)
+        RD("Prediction",g_cfg.prediction) RD("Mode",g_cfg.mode) RD("Trail",g_cfg.trail)
+        RD("AutoContrast",g_cfg.autoContrast) RD("Shake",g_cfg.shake)
+        RD("GlowRadius",g_cfg.glowRadius) RD("GlowStrength",g_cfg.glowStrength)
+#undef RD
+        g_cfg.prediction=std::min(100,std::max(0,g_cfg.prediction));
+        g_cfg.glowRadius=std::min(GLOW_MAX_PX,std::max(0,g_cfg.glowRadius));
+        g_cfg.glowStrength=std::min(100,std::max(0,g_cfg.glowStrength));
+        g_cfg.mode=std::min((int)LOCATE_SPOTLIGHT,std::max((int)LOCATE_RING,g_cfg.mode));
+        g_loadedValues=s;
+    }
+    Store_Start(g_store,be,s,SETTINGS_DEBOUNCE_MS);
+}
+static void SaveSettings(){Store_Submit(g_store,CurrentValues());PublishConfig();}
 static void ApplyStartup(bool on)
 {
     HKEY k; RegOpenKeyExA(HKEY_CURRENT_USER,"Software\\Microsoft\\Windows\\CurrentVersion\\Run",0,KEY_WRITE,&k);
@@ -147,8 +269,79 @@ static void ApplyStartup(bool on)
 }
 
 //  HELPERS
-static inline float EaseOutQuint(float t){return 1.f-powf(1.f-Clamp01(t),5.f);}
-static float GetDuration(){switch(g_cfg.speed){case 0:return 1600;case 2:return 560;default:return 1050;}}
+static float GetDuration(){return AnimDurationMs(g_rcfg.speed);}
+// QPC timeline; DWM reports its vblank grid in QPC ticks, so both map onto the same ns clock.
+struct QpcClock : PaceClock {
+    double nsPerTick=0;
+    QpcClock(){LARGE_INTEGER f;QueryPerformanceFrequency(&f);nsPerTick=1e9/(double)f.QuadPart;}
+    int64_t NowNs() override {LARGE_INTEGER c;QueryPerformanceCounter(&c);return (int64_t)(c.QuadPart*nsPerTick);}
+    bool VBlank(int64_t&periodNs,int64_t&lastNs) override {
+        DWM_TIMING_INFO ti={}; ti.cbSize=sizeof(ti);
+        if(FAILED(DwmGetCompositionTimingInfo(NULL,&ti))||!ti.qpcRefreshPeriod)return false;
+        periodNs=(int64_t)(ti.qpcRefreshPeriod*nsPerTick); lastNs=(int64_t)(ti.qpcVBlank*nsPerTick);
+        return true;
+    }
+};
+static QpcClock   g_clock;
+static int64_t RefreshPeriodNs(){int64_t p=0,l=0;return g_clock.VBlank(p,l)&&p>0?p:16666667;}
+
+//  STARTUP
+// Cold start is measured from process creation to the tray icon. Nothing before the icon
+// touches GDI+: the icon is baked at compile time and the overlay draws with its own
+// rasterizer, so GDI+ starts the first time the settings UI is about to be shown.
+struct StartupStats {
+    double   trayMs   = 0;      // process creation -> tray icon added
+    size_t   trayWS   = 0, trayPeak = 0;
+    double   gdipAtMs = 0;      // process creation -> GDI+ started, 0 if it never was
+    double   gdipMs   = 0;      // GdiplusStartup itself
+};
+static StartupStats g_startup;
+static ULONG_PTR    g_gdipToken = 0;
+
+static double SinceProcessStartMs(){
+    FILETIME c,e,k,u,now; GetProcessTimes(GetCurrentProcess(),&c,&e,&k,&u);
+    GetSystemTimePreciseAsFileTime(&now);
+    ULARGE_INTEGER a,b; a.LowPart=c.dwLowDateTime;a.HighPart=c.dwHighDateTime;
+    b.LowPart=now.dwLowDateTime;b.HighPart=now.dwHighDateTime;
+    return (double)(b.QuadPart-a.QuadPart)/1e4;
+}
+static size_t WorkingSet(size_t*peak=nullptr){
+    PROCESS_MEMORY_COUNTERS pm={}; pm.cb=sizeof(pm);
+    if(!GetProcessMemoryInfo(GetCurrentProcess(),&pm,sizeof(pm)))return 0;
+    if(peak)*peak=pm.PeakWorkingSetSize;
+    return pm.WorkingSetSize;
+}
+static void Startup_Tray(){
+    g_startup.trayMs=SinceProcessStartMs(); g_startup.trayWS=WorkingSet(&g_startup.trayPeak);
+    char buf[128];
+    sprintf(buf,"BCF: tray icon after %.1f ms, working set %.1f MB (peak %.1f MB)\n",
+            g_startup.trayMs,g_startup.trayWS/1048576.0,g_startup.trayPeak/1048576.0);
+    OutputDebugStringA(buf);
+}
+// UI thread. Everything that draws with GDI+ calls this first.
+static bool Gdip_Ensure(){
+    if(g_gdipToken)return true;
+    int64_t t0=g_clock.NowNs();
+    GdiplusStartupInput gi;
+    if(GdiplusStartup(&g_gdipToken,&gi,NULL)!=Ok){g_gdipToken=0;return false;}
+    g_startup.gdipMs=(g_clock.NowNs()-t0)/1e6; g_startup.gdipAtMs=SinceProcessStartMs();
+    char buf[96]; sprintf(buf,"BCF: GDI+ started in %.1f ms\n",g_startup.gdipMs);
+    OutputDebugStringA(buf);
+    return true;
+}
+// Appended to the frame stats report by the UI thread, which owns these numbers.
+static void WriteStartupStats(FILE*f){
+    size_t peak=0, ws=WorkingSet(&peak);
+    fprintf(f,"startup: tray icon %.1f ms, working set %.1f MB (peak %.1f MB)\n",
+            g_startup.trayMs,g_startup.trayWS/1048576.0,g_startup.trayPeak/1048576.0);
+    if(g_gdipToken)fprintf(f,"GDI+ started at %.1f ms, took %.1f ms\n",g_startup.gdipAtMs,g_startup.gdipMs);
+    else           fprintf(f,"GDI+ not started\n");
+    fprintf(f,"working set now %.1f MB (peak %.1f MB)\n",ws/1048576.0,peak/1048576.0);
+}
+// Settings controls are cached with a margin for their antialiased strokes.
+static const int SW_CTL_PAD = 2;
+static RECT SW_PadRect(const RECT&r){RECT q=r;InflateRect(&q,SW_CTL_PAD,SW_CTL_PAD);return q;}
+static void SW_InvalidateCtl(const RECT&r){if(g_hwndSettings){RECT q=SW_PadRect(r);InvalidateRect(g_hwndSettings,&q,FALSE);}}
 static Color CR(COLORREF c,BYTE a=255){return Color(a,GetRValue(c),GetGValue(c),GetBValue(c));}
 
 static void BuildRR(GraphicsPath&p,float x,float y,float w,float h,float r){
@@ -177,10 +370,277 @@ static void DrawToggle(Graphics&g,float x,float y,bool on,Color onC,Color offC){
     float dx=on?x+w-h+3:x+3; g.FillEllipse(&wb,dx,y+3,h-6,h-6);
 }
 
+//  OVERLAY SURFACE
+// Two persistent top-down DIB sections sharing one memory DC, created once and only
+// rebuilt when the overlay size or DPI changes. Frames are drawn into the back buffer,
+// only the frame's bounding box is uploaded (the layered window shrinks to it) and the
+// buffers swapped. Each buffer remembers what it last held so only that gets cleared.
+struct OverlaySurface {
+    HDC      dc       = nullptr;
+    HBITMAP  bmp[2]   = {};
+    uint32_t*bits[2]  = {};
+    IRect    drawn[2];
+    IRect    cleared;
+    HBITMAP  oldBmp   = nullptr;
+    int      back     = 0;
+    int      size     = 0;
+    int      dpi      = 0;
+    DamageStats damage;
+    unsigned created  = 0;      // GDI objects created / deleted over the process lifetime
+    unsigned deleted  = 0;
+    unsigned rebuilds = 0;
+};
+static OverlaySurface g_ov;
+static bool g_ovDpiDirty = false;
+
+static int ScreenDpi(){HDC s=GetDC(NULL);int d=GetDeviceCaps(s,LOGPIXELSX);ReleaseDC(NULL,s);return d?d:96;}
+// Effective DPI of the monitor under pt; the overlay there is drawn at this scale.
+static int DpiAt(POINT pt){
+    UINT x=0,y=0;
+    if(FAILED(GetDpiForMonitor(MonitorFromPoint(pt,MONITOR_DEFAULTTONEAREST),MDT_EFFECTIVE_DPI,&x,&y))||!x)
+        return ScreenDpi();
+    return (int)x;
+}
+static POINT CursorPos(){POINT p={};GetCursorPos(&p);return p;}
+
+// The process is per-monitor aware so the overlays get real pixels on every monitor. The
+// settings window and colour picker are laid out in fixed pixels, so they are created
+// DPI-unaware and the system keeps scaling them. The user32 calls are looked up because
+// they are newer than the first Windows 10 releases.
+typedef BOOL (WINAPI*SetProcessDpiCtxFn)(DPI_AWARENESS_CONTEXT);
+typedef DPI_AWARENESS_CONTEXT (WINAPI*SetThreadDpiCtxFn)(DPI_AWARENESS_CONTEXT);
+static SetThreadDpiCtxFn g_setThreadDpiCtx = nullptr;
+static void DeclareDpiAwareness(){
+    HMODULE u=GetModuleHandleA("user32.dll");
+    SetProcessDpiCtxFn setProcess=(SetProcessDpiCtxFn)GetProcAddress(u,"SetProcessDpiAwarenessContext");
+    g_setThreadDpiCtx=(SetThreadDpiCtxFn)GetProcAddress(u,"SetThreadDpiAwarenessContext");
+    if(!setProcess||!setProcess(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
+        SetProcessDpiAwareness(PROCESS_PER_MONITOR_DPI_AWARE);
+}
+static DPI_AWARENESS_CONTEXT BeginDpiUnaware(){
+    return g_setThreadDpiCtx?g_setThreadDpiCtx(DPI_AWARENESS_CONTEXT_UNAWARE):nullptr;
+}
+static void EndDpiUnaware(DPI_AWARENESS_CONTEXT prev){if(prev)g_setThreadDpiCtx(prev);}
+
+static void Surf_Destroy(OverlaySurface&s){
+    if(!s.dc)return;
+    if(s.oldBmp)SelectObject(s.dc,s.oldBmp);
+    for(int i=0;i<2;i++) if(s.bmp[i]){DeleteObject(s.bmp[i]);s.bmp[i]=nullptr;s.bits[i]=nullptr;s.deleted++;}
+    DeleteDC(s.dc); s.dc=nullptr; s.oldBmp=nullptr; s.size=0; s.deleted++;
+}
+static bool Surf_Ensure(OverlaySurface&s,int size,int dpi){
+    if(s.dc&&s.size==size&&s.dpi==dpi)return true;
+    Surf_Destroy(s);
+    s.dc=CreateCompatibleDC(NULL); if(!s.dc)return false; s.created++;
+    BITMAPINFO bmi={};bmi.bmiHeader.biSize=sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth=size;bmi.bmiHeader.biHeight=-size;
+    bmi.bmiHeader.biPlanes=1;bmi.bmiHeader.biBitCount=32;bmi.bmiHeader.biCompression=BI_RGB;
+    for(int i=0;i<2;i++){
+        void*pv=nullptr; s.bmp[i]=CreateDIBSection(s.dc,&bmi,DIB_RGB_COLORS,&pv,NULL,0);
+        if(!s.bmp[i]){Surf_Destroy(s);return false;}
+        s.bits[i]=(uint32_t*)pv; s.created++;
+        memset(pv,0,(size_t)size*size*4);
+        s.drawn[i]=IRect();
+    }
+    s.oldBmp=(HBITMAP)SelectObject(s.dc,s.bmp[0]);
+    s.back=0; s.size=size; s.dpi=dpi; s.rebuilds++;
+    char buf[128];
+    sprintf(buf,"BCF: overlay surface %dpx @%d dpi, GDI objects %lu\n",size,dpi,
+            GetGuiResources(GetCurrentProcess(),GR_GDIOBJECTS));
+    OutputDebugStringA(buf);
+    return true;
+}
+// Selects the back buffer into the DC, clears what it held last time and returns its pixels.
+static uint32_t* Surf_Back(OverlaySurface&s){
+    SelectObject(s.dc,s.bmp[s.back]); GdiFlush();
+    uint32_t*px=s.bits[s.back];
+    s.cleared=DamageClearRect(s.drawn[s.back],s.size);
+    for(int y=s.cleared.y0;y<s.cleared.y1;y++)
+        memset(px+(size_t)y*s.size+s.cleared.x0,0,(size_t)(s.cleared.x1-s.cleared.x0)*4);
+    s.drawn[s.back]=IRect();
+    return px;
+}
+// Uploads the part of the back buffer that was drawn, placing the surface centre at `centre`.
+static void Surf_Present(OverlaySurface&s,HWND hwnd,POINT centre,const IRect&drawn){
+    IRect u=DamageUploadRect(drawn,s.size);
+    POINT ptS={u.x0,u.y0};SIZE szW={u.x1-u.x0,u.y1-u.y0};
+    POINT ptD={centre.x-s.size/2+u.x0,centre.y-s.size/2+u.y0};
+    BLENDFUNCTION bf={};bf.BlendOp=AC_SRC_OVER;bf.SourceConstantAlpha=255;bf.AlphaFormat=AC_SRC_ALPHA;
+    UpdateLayeredWindow(hwnd,NULL,&ptD,&szW,s.dc,&ptS,0,&bf,ULW_ALPHA);
+    DamageAccount(s.damage,s.cleared,u,s.size);
+    s.drawn[s.back]=drawn;
+    s.back^=1;
+}
+
+//  FRAME ATLAS
+static RingAtlas g_atlas;
+
+static float OverlayScale(){return g_ov.dpi?g_ov.dpi/96.f:1.f;}
+static RingStyle CurrentRingStyle(){
+    RingStyle st; st.ringColor=g_rcfg.ringColor; st.outlineColor=g_rcfg.outlineColor; st.stroke=STROKE_W;
+    st.scale=OverlayScale(); st.glow=(float)g_rcfg.glowRadius; st.glowAlpha=g_rcfg.glowStrength/100.f;
+    return st;
+}
+// Re-bakes the animation frames when the ring colours or surface no longer match the atlas.
+// The glow profiles are warmed here too: when the atlas is skipped, or contrast colours are
+// drawn live, frames would otherwise build them mid-animation.
+static void RebuildAtlas(){
+    RingStyle st=CurrentRingStyle();
+    if(!g_ov.size)return;
+    RingGlowWarm(st,ANIM_MAX_R*st.scale);
+    if(AtlasMatches(g_atlas,g_ov.size,st))return;
+    AtlasBuild(g_atlas,g_ov.size,st);
+    char buf[160];
+    sprintf(buf,"BCF: atlas %d of %d keys, %u KB (animation needs ~%u KB), %.1f ms\n",g_atlas.baked,
+            g_atlas.keys,(unsigned)(g_atlas.bytes/1024),(unsigned)(g_atlas.needBytes/1024),g_atlas.buildMs);
+    OutputDebugStringA(buf);
+}
+
+//  SPOTLIGHT SURFACE
+// One top-down DIB covering the virtual desktop (about 95 MB for three 4K monitors). Building
+// and first sending it takes some 65 ms, so it is warmed when Ctrl goes down, ahead of the tap,
+// and freed SPOT_KEEP_NS after the last warm or animation. A locate that does not start with
+// Ctrl (shake, IPC) builds it on the spot. It is
+// filled once; frames rewrite only the tiles the circle's edge crosses and send just their
+// bounding rect through UpdateLayeredWindowIndirect. The fade is the window's constant alpha,
+// so it costs no pixels at all. Render thread.
+static const int64_t SPOT_KEEP_NS = 10000000000LL;
+struct SpotSurface {
+    HDC      dc       = nullptr;
+    HBITMAP  bmp      = nullptr;
+    HBITMAP  oldBmp   = nullptr;
+    uint32_t*bits     = nullptr;
+    RECT     desk     = {};
+    int      dpi      = 0;
+    bool     uploaded = false;      // the window holds the whole surface
+    SpotTiles tiles;
+    SpotStats past;                 // stats of surfaces already freed or re-initialised
+    unsigned builds   = 0, frees = 0;
+};
+static SpotSurface g_spot;
+static bool    g_spotDirty  = false;
+static int64_t g_spotFreeAt = 0;     // when the idle surface goes, 0 while unarmed
+static HWND g_hwndSpot  = nullptr;   // layered spotlight window, owned by the render thread
+
+static void Spot_FoldStats(SpotSurface&s){
+    SpotStats&p=s.past; const SpotStats&t=s.tiles.stats;
+    p.frames+=t.frames; p.rastered+=t.rastered; p.filled+=t.filled;
+    p.uploadBytes+=t.uploadBytes; p.fullBytes+=t.fullBytes;
+    s.tiles.stats=SpotStats();
+}
+static void Spot_Destroy(SpotSurface&s){
+    if(!s.dc)return;
+    Spot_FoldStats(s); s.frees++;
+    if(s.oldBmp)SelectObject(s.dc,s.oldBmp);
+    if(s.bmp)DeleteObject(s.bmp);
+    DeleteDC(s.dc);
+    s.dc=nullptr; s.bmp=s.oldBmp=nullptr; s.bits=nullptr; s.uploaded=false;
+}
+// The feather is scaled for the monitor under `at`; moving to a monitor with another DPI
+// refills the surface but keeps the allocation.
+static bool Spot_Ensure(SpotSurface&s,POINT at){
+    RECT d; d.left=GetSystemMetrics(SM_XVIRTUALSCREEN); d.top=GetSystemMetrics(SM_YVIRTUALSCREEN);
+    d.right=d.left+GetSystemMetrics(SM_CXVIRTUALSCREEN); d.bottom=d.top+GetSystemMetrics(SM_CYVIRTUALSCREEN);
+    int dpi=DpiAt(at);
+    if(s.dc&&!g_spotDirty&&EqualRect(&s.desk,&d)){
+        if(s.dpi!=dpi){
+            SpotStyle st; st.scale=dpi/96.f;
+            Spot_FoldStats(s);
+            Spot_Init(s.tiles,s.tiles.w,s.tiles.h,st,s.bits,s.tiles.w);
+            s.dpi=dpi; s.uploaded=false;
+        }
+        return true;
+    }
+    Spot_Destroy(s); g_spotDirty=false;
+    const int w=d.right-d.left, h=d.bottom-d.top;
+    if(w<=0||h<=0)return false;
+    s.dc=CreateCompatibleDC(NULL); if(!s.dc)return false;
+    BITMAPINFO bmi={};bmi.bmiHeader.biSize=sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth=w;bmi.bmiHeader.biHeight=-h;
+    bmi.bmiHeader.biPlanes=1;bmi.bmiHeader.biBitCount=32;bmi.bmiHeader.biCompression=BI_RGB;
+    void*pv=nullptr; s.bmp=CreateDIBSection(s.dc,&bmi,DIB_RGB_COLORS,&pv,NULL,0);
+    if(!s.bmp){Spot_Destroy(s);return false;}
+    s.bits=(uint32_t*)pv; s.oldBmp=(HBITMAP)SelectObject(s.dc,s.bmp);
+    SpotStyle st; st.scale=dpi/96.f;
+    Spot_Init(s.tiles,w,h,st,s.bits,w);
+    s.desk=d; s.dpi=dpi; s.builds++;
+    char buf[128];
+    sprintf(buf,"BCF: spotlight surface %dx%d @%d dpi, %u MB\n",w,h,dpi,(unsigned)((size_t)w*h*4>>20));
+    OutputDebugStringA(buf);
+    return true;
+}
+// The first present sends the whole surface; later ones only `dirty`, or no pixels at all
+// when only the fade changed.
+static void Spot_Present(SpotSurface&s,const IRect&dirty,BYTE alpha){
+    POINT ptD={s.desk.left,s.desk.top},ptS={0,0}; SIZE sz={s.tiles.w,s.tiles.h};
+    RECT rc={dirty.x0,dirty.y0,dirty.x1,dirty.y1};
+    BLENDFUNCTION bf={};bf.BlendOp=AC_SRC_OVER;bf.SourceConstantAlpha=alpha;bf.AlphaFormat=AC_SRC_ALPHA;
+    UPDATELAYEREDWINDOWINFO u={};u.cbSize=sizeof(u);
+    u.pptDst=&ptD;u.psize=&sz;u.pblend=&bf;u.dwFlags=ULW_ALPHA;
+    if(!s.uploaded||!IRectEmpty(dirty)){
+        GdiFlush(); u.hdcSrc=s.dc; u.pptSrc=&ptS;
+        if(s.uploaded)u.prcDirty=&rc;
+        s.uploaded=true;
+    }
+    UpdateLayeredWindowIndirect(g_hwndSpot,&u);
+}
+
+//  TRAIL SURFACE
+// A DIB that only grows, up to TRAIL_MAX_PX square; each frame draws into its top-left
+// corner at the size of the trail's bounding box, and the window is moved and sized to that
+// box as it is updated. Only the pixels drawn last frame are cleared. Render thread.
+static const int TRAIL_MAX_PX = 2048;
+struct TrailSurface {
+    HDC      dc     = nullptr;
+    HBITMAP  bmp    = nullptr;
+    HBITMAP  oldBmp = nullptr;
+    uint32_t*bits   = nullptr;
+    int      w = 0, h = 0;          // allocated; also the stride
+    IRect    drawn;                 // non-zero pixels
+};
+static TrailSurface g_trailSurf;
+static HWND g_hwndTrail = nullptr;  // layered trail window, owned by the render thread
+static uint64_t g_trailFrames = 0, g_trailSegsDrawn = 0, g_trailNs = 0;
+
+static void TrailSurf_Destroy(TrailSurface&s){
+    if(!s.dc)return;
+    if(s.oldBmp)SelectObject(s.dc,s.oldBmp);
+    if(s.bmp)DeleteObject(s.bmp);
+    DeleteDC(s.dc);
+    s.dc=nullptr; s.bmp=s.oldBmp=nullptr; s.bits=nullptr; s.w=s.h=0; s.drawn=IRect();
+}
+// Grows in 256 px steps so a lengthening trail does not re-create the DIB every frame.
+static bool TrailSurf_Ensure(TrailSurface&s,int w,int h){
+    if(s.dc&&w<=s.w&&h<=s.h)return true;
+    w=std::min(TRAIL_MAX_PX,(std::max(w,s.w)+255)&~255); h=std::min(TRAIL_MAX_PX,(std::max(h,s.h)+255)&~255);
+    TrailSurf_Destroy(s);
+    s.dc=CreateCompatibleDC(NULL); if(!s.dc)return false;
+    BITMAPINFO bmi={};bmi.bmiHeader.biSize=sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth=w;bmi.bmiHeader.biHeight=-h;
+    bmi.bmiHeader.biPlanes=1;bmi.bmiHeader.biBitCount=32;bmi.bmiHeader.biCompression=BI_RGB;
+    void*pv=nullptr; s.bmp=CreateDIBSection(s.dc,&bmi,DIB_RGB_COLORS,&pv,NULL,0);
+    if(!s.bmp){TrailSurf_Destroy(s);return false;}
+    s.bits=(uint32_t*)pv; s.oldBmp=(HBITMAP)SelectObject(s.dc,s.bmp);
+    s.w=w; s.h=h;
+    return true;
+}
+static void TrailSurf_Clear(TrailSurface&s){
+    for(int y=s.drawn.y0;y<s.drawn.y1;y++)
+        memset(s.bits+(size_t)y*s.w+s.drawn.x0,0,(size_t)(s.drawn.x1-s.drawn.x0)*4);
+    s.drawn=IRect();
+}
+// `box` is in screen pixels; the surface's top-left corner lands on its origin.
+static void TrailSurf_Present(TrailSurface&s,const IRect&box){
+    POINT ptD={box.x0,box.y0},ptS={0,0}; SIZE sz={box.x1-box.x0,box.y1-box.y0};
+    BLENDFUNCTION bf={};bf.BlendOp=AC_SRC_OVER;bf.SourceConstantAlpha=255;bf.AlphaFormat=AC_SRC_ALPHA;
+    GdiFlush();
+    UpdateLayeredWindow(g_hwndTrail,NULL,&ptD,&sz,s.dc,&ptS,0,&bf,ULW_ALPHA);
+}
+
 //  THEME
 struct TC{Color bg,hdrBg,text,sub,sep,accent,togOff,border,cardBg;};
-static TC GetTC(){
-    if(g_cfg.darkMode)return{
+static TC GetTC(bool dark){
+    if(dark)return{
         Color(255,20,20,32),Color(255,26,26,42),Color(255,228,228,240),
         Color(255,120,120,148),Color(255,38,38,58),Color(255,72,148,255),
         Color(255,55,55,78),Color(255,45,45,68),Color(255,28,28,44)};
@@ -191,9 +651,10 @@ static TC GetTC(){
 }
 
 //  BCF ICON
+// The pixels come from bcf_icon.h; this only wraps them in an HICON.
 static HICON CreateBCFIcon()
 {
-    const int SZ = 32;
+    const int SZ = BCF_ICON_SZ;
 
     BITMAPV5HEADER bh = {};
     bh.bV5Size        = sizeof(bh);
@@ -208,53 +669,14 @@ static HICON CreateBCFIcon()
     bh.bV5AlphaMask   = 0xFF000000;
 
     void*   pvBits = nullptr;
-    HDC     hdcS   = GetDC(NULL);
-    HDC     hdcM   = CreateCompatibleDC(hdcS);
-    HBITMAP hBmp   = CreateDIBSection(hdcM,(BITMAPINFO*)&bh,DIB_RGB_COLORS,&pvBits,NULL,0);
-    HBITMAP hOld   = (HBITMAP)SelectObject(hdcM,hBmp);
-
-    memset(pvBits, 0, SZ*SZ*4);
-
-    {
-        Graphics g(hdcM);
-        g.SetSmoothingMode(SmoothingModeAntiAlias);
-        g.SetTextRenderingHint(TextRenderingHintAntiAlias);
-        g.SetCompositingMode(CompositingModeSourceOver);
-
-        float m = 1.0f;
-        float D = SZ - m*2;
-
-        SolidBrush bgB(Color(255,18,18,30));
-        g.FillEllipse(&bgB, m, m, D, D);
-
-        Pen ring(Color(255,72,148,255), 1.8f);
-        g.DrawEllipse(&ring, m+0.9f, m+0.9f, D-1.8f, D-1.8f);
-
-        FontFamily ff(L"Arial");
-        Font font(&ff, 9, FontStyleBold, UnitPoint);
-        SolidBrush white(Color(255,240,240,255));
-        StringFormat sf;
-        sf.SetAlignment(StringAlignmentCenter);
-        sf.SetLineAlignment(StringAlignmentCenter);
-        g.DrawString(L"BCF", -1, &font, RectF(m, m, D, D), &sf, &white);
-    }
-
-    HBITMAP hMask = CreateBitmap(SZ, SZ, 1, 1, NULL);
-    {
-        HDC     hm  = CreateCompatibleDC(NULL);
-        HBITMAP ho  = (HBITMAP)SelectObject(hm, hMask);
-        PatBlt(hm, 0, 0, SZ, SZ, WHITENESS);
-        HBRUSH hbr = CreateSolidBrush(RGB(0,0,0));
-        HBRUSH hob = (HBRUSH)SelectObject(hm, hbr);
-        Ellipse(hm, 0, 0, SZ, SZ);
-        SelectObject(hm, hob); DeleteObject(hbr);
-        SelectObject(hm, ho); DeleteDC(hm);
-    }
+    HBITMAP hBmp   = CreateDIBSection(NULL,(BITMAPINFO*)&bh,DIB_RGB_COLORS,&pvBits,NULL,0);
+    if(!hBmp) return nullptr;
+    memcpy(pvBits, BCF_ICON.argb, sizeof(BCF_ICON.argb));
+    HBITMAP hMask  = CreateBitmap(SZ, SZ, 1, 1, BCF_ICON.mask);
 
     ICONINFO ii = {}; ii.fIcon = TRUE; ii.hbmColor = hBmp; ii.hbmMask = hMask;
     HICON hIcon = CreateIconIndirect(&ii);
-    SelectObject(hdcM, hOld); DeleteObject(hBmp); DeleteObject(hMask);
-    DeleteDC(hdcM); ReleaseDC(NULL, hdcS);
+    DeleteObject(hBmp); DeleteObject(hMask);
     return hIcon;
 }
 
@@ -265,58 +687,76 @@ static void CP_UpdateHexEdit()
     sprintf(buf,"%02X%02X%02X",GetRValue(c),GetGValue(c),GetBValue(c));
     g_cp.suppressEdit=true; SetWindowTextA(g_cp.hwndEdit,buf); g_cp.suppressEdit=false;
 }
+// Bounds of everything that moves with the colour, antialiasing fringe included.
+static RECT CP_SelSVRect(){
+    float sx=g_cp.rcSV.left+g_cp.sat*(g_cp.rcSV.right-g_cp.rcSV.left-1);
+    float sy=g_cp.rcSV.top+(1.f-g_cp.val)*(g_cp.rcSV.bottom-g_cp.rcSV.top-1);
+    RECT r={(LONG)floorf(sx-10),(LONG)floorf(sy-10),(LONG)ceilf(sx+11),(LONG)ceilf(sy+11)}; return r;
+}
+static RECT CP_SelHueRect(){
+    float sx=g_cp.rcHue.left+(g_cp.hue/360.f)*(g_cp.rcHue.right-g_cp.rcHue.left-1);
+    RECT r={(LONG)floorf(sx-4),g_cp.rcHue.top-4,(LONG)ceilf(sx+5),g_cp.rcHue.bottom+4}; return r;
+}
+static RECT CP_NewRect(){
+    RECT r={g_cp.rcNew.left-2,g_cp.rcNew.top-2,g_cp.rcNew.right+2,g_cp.rcOld.bottom+22}; return r;
+}
+// Invalidates the old and new selector bounds, the new swatch, and the SV square on a hue change.
+static void CP_Invalidate(bool hueChanged){
+    HWND h=g_cp.hwnd; if(!h)return;
+    RECT sv=CP_SelSVRect(), hue=CP_SelHueRect(), nw=CP_NewRect();
+    if(hueChanged){RECT q=g_cp.rcSV; InflateRect(&q,2,2); InvalidateRect(h,&q,FALSE);}
+    InvalidateRect(h,&g_cp.rcSelSV,FALSE);  InvalidateRect(h,&sv,FALSE);
+    InvalidateRect(h,&g_cp.rcSelHue,FALSE); InvalidateRect(h,&hue,FALSE);
+    InvalidateRect(h,&nw,FALSE);
+    g_cp.rcSelSV=sv; g_cp.rcSelHue=hue;
+}
 static void CP_UpdateSV(POINT pt){
     float w=(float)(g_cp.rcSV.right-g_cp.rcSV.left);
     float h=(float)(g_cp.rcSV.bottom-g_cp.rcSV.top);
     g_cp.sat=Clamp01((pt.x-g_cp.rcSV.left)/(w-1));
     g_cp.val=1.f-Clamp01((pt.y-g_cp.rcSV.top)/(h-1));
-    CP_UpdateHexEdit(); InvalidateRect(g_cp.hwnd,NULL,FALSE);
+    CP_UpdateHexEdit(); CP_Invalidate(false);
 }
 static void CP_UpdateHue(POINT pt){
     float w=(float)(g_cp.rcHue.right-g_cp.rcHue.left);
     g_cp.hue=Clamp01((pt.x-g_cp.rcHue.left)/(w-1))*360.f;
-    CP_UpdateHexEdit(); InvalidateRect(g_cp.hwnd,NULL,FALSE);
+    CP_UpdateHexEdit(); CP_Invalidate(true);
+}
+// Applies the latest drag position unless one was applied within the current refresh
+// period; in that case a timer picks it up when the period ends.
+static void CP_FlushDrag(bool force){
+    if(!g_cp.pending)return;
+    int64_t now=g_clock.NowNs(), period=RefreshPeriodNs(), wait=g_cp.lastFlushNs+period-now;
+    if(!force&&wait>0){
+        if(!g_cp.flushTimer){SetTimer(g_cp.hwnd,CP_FLUSH_TIMER,(UINT)((wait+999999)/1000000),NULL);g_cp.flushTimer=true;}
+        return;
+    }
+    g_cp.pending=false; g_cp.lastFlushNs=now;
+    if(g_cp.draggingSV) CP_UpdateSV(g_cp.pendingPt);
+    if(g_cp.draggingHue)CP_UpdateHue(g_cp.pendingPt);
 }
 
-//  COLOR PICKER — render
-static void RenderCP(HDC hdc)
+//  COLOR PICKER — layers
+static void CP_FreeLayer(HDC&dc,HBITMAP&bmp,HBITMAP&old)
 {
-    HDC memDC=CreateCompatibleDC(hdc);
-    HBITMAP bmp=CreateCompatibleBitmap(hdc,CP_W,CP_H);
-    HBITMAP old=(HBITMAP)SelectObject(memDC,bmp);
-
-    Graphics g(memDC);
-    g.SetSmoothingMode(SmoothingModeAntiAlias);
-    g.SetPixelOffsetMode(PixelOffsetModeHighQuality);
-    g.SetTextRenderingHint(TextRenderingHintClearTypeGridFit);
+    if(dc&&old)SelectObject(dc,old);
+    if(bmp)DeleteObject(bmp);
+    if(dc)DeleteDC(dc);
+    dc=nullptr; bmp=old=nullptr;
+}
+static void CP_FreeLayers()
+{
+    CP_FreeLayer(g_cp.chromeDC,g_cp.chromeBmp,g_cp.chromeOld);
+    CP_FreeLayer(g_cp.svDC,g_cp.svBmp,g_cp.svOld);
+    CP_FreeLayer(g_cp.backDC,g_cp.backBmp,g_cp.backOld);
+    g_cp.svBits=nullptr; g_cp.svHue=-1;
+}
 
-    // Background
+// Everything that does not depend on the current colour, drawn once per picker.
+static void CP_DrawChrome(Graphics&g)
+{
     SolidBrush bg(Color(255,22,22,36)); g.FillRectangle(&bg,0,0,CP_W,CP_H);
 
-    // SV Square
-    {
-        int w=g_cp.rcSV.right-g_cp.rcSV.left, h=g_cp.rcSV.bottom-g_cp.rcSV.top;
-        Bitmap svBmp(w,h,PixelFormat32bppARGB);
-        BitmapData bd; Rect rect(0,0,w,h);
-        svBmp.LockBits(&rect,ImageLockModeWrite,PixelFormat32bppARGB,&bd);
-        BYTE*px=(BYTE*)bd.Scan0;
-        for(int py=0;py<h;py++) for(int px2=0;px2<w;px2++){
-            COLORREF c=HSVtoRGB(g_cp.hue,(float)px2/(w-1),1.f-(float)py/(h-1));
-            int idx=py*bd.Stride+px2*4;
-            px[idx]=GetBValue(c);px[idx+1]=GetGValue(c);px[idx+2]=GetRValue(c);px[idx+3]=255;
-        }
-        svBmp.UnlockBits(&bd);
-        g.DrawImage(&svBmp,(float)g_cp.rcSV.left,(float)g_cp.rcSV.top,(float)w,(float)h);
-
-        Pen border(Color(255,60,60,80),1.f);
-        g.DrawRectangle(&border,(float)g_cp.rcSV.left,(float)g_cp.rcSV.top,(float)w,(float)h);
-   
-        float sx=g_cp.rcSV.left+g_cp.sat*(w-1);
-        float sy=g_cp.rcSV.top+(1.f-g_cp.val)*(h-1);
-        Pen po(Color(255,0,0,0),2.f);   g.DrawEllipse(&po,sx-8.f,sy-8.f,16.f,16.f);
-        Pen pi(Color(255,255,255,255),2.f); g.DrawEllipse(&pi,sx-6.5f,sy-6.5f,13.f,13.f);
-    }
-
     // Hue Bar
     {
         int w=g_cp.rcHue.right-g_cp.rcHue.left, h=g_cp.rcHue.bottom-g_cp.rcHue.top;
@@ -324,25 +764,16 @@ static void RenderCP(HDC hdc)
         BitmapData bd; Rect rect(0,0,w,h);
         hueBmp.LockBits(&rect,ImageLockModeWrite,PixelFormat32bppARGB,&bd);
         BYTE*px=(BYTE*)bd.Scan0;
-        for(int py=0;py<h;py++) for(int px2=0;px2<w;px2++){
-            COLORREF c=HSVtoRGB((float)px2/(w-1)*360.f,1,1);
-            int idx=py*bd.Stride+px2*4;
-            px[idx]=GetBValue(c);px[idx+1]=GetGValue(c);px[idx+2]=GetRValue(c);px[idx+3]=255;
-        }
+        HsvRamp rp={0,360,1,1,1,1};
+        HsvRowToBGRA((uint32_t*)px,w,rp);
+        for(int py=1;py<h;py++)memcpy(px+py*bd.Stride,px,(size_t)w*4);
         hueBmp.UnlockBits(&bd);
         g.DrawImage(&hueBmp,(float)g_cp.rcHue.left,(float)g_cp.rcHue.top,(float)w,(float)h);
         Pen border(Color(255,60,60,80),1.f);
         g.DrawRectangle(&border,(float)g_cp.rcHue.left,(float)g_cp.rcHue.top,(float)w,(float)h);
-        // Selector
-        float sx=g_cp.rcHue.left+(g_cp.hue/360.f)*(w-1);
-        Pen sw(Color(255,255,255,255),2.f);
-        g.DrawLine(&sw,sx,(float)g_cp.rcHue.top-2,sx,(float)g_cp.rcHue.bottom+2);
-        Pen sb(Color(255,0,0,0),1.f);
-        g.DrawLine(&sb,sx-1.5f,(float)g_cp.rcHue.top-2,sx-1.5f,(float)g_cp.rcHue.bottom+2);
-        g.DrawLine(&sb,sx+1.5f,(float)g_cp.rcHue.top-2,sx+1.5f,(float)g_cp.rcHue.bottom+2);
     }
 
-    // Preview Labels + Swatches
+    // Preview Labels + Original Swatch
     {
         FontFamily ff(L"Segoe UI");
         Font fSub(&ff,8,FontStyleRegular,UnitPoint);
@@ -352,36 +783,21 @@ static void RenderCP(HDC hdc)
 
         float ow=(float)(g_cp.rcOld.right-g_cp.rcOld.left);
         float oh=(float)(g_cp.rcOld.bottom-g_cp.rcOld.top);
-        float nw=(float)(g_cp.rcNew.right-g_cp.rcNew.left);
-
 
         g.DrawString(L"Original",-1,&fSub,PointF((float)g_cp.rcOld.left,(float)g_cp.rcOld.top-14),&subB);
         g.DrawString(L"New",     -1,&fSub,PointF((float)g_cp.rcNew.left,(float)g_cp.rcNew.top-14),&subB);
 
-        
         COLORREF origC=g_cp.orig;
         FillRR(g,CR(origC),(float)g_cp.rcOld.left,(float)g_cp.rcOld.top,ow,oh,6);
         DrawRR(g,Color(255,60,60,80),1.f,(float)g_cp.rcOld.left,(float)g_cp.rcOld.top,ow,oh,6);
 
-        
-        COLORREF newC=HSVtoRGB(g_cp.hue,g_cp.sat,g_cp.val);
-        FillRR(g,CR(newC),(float)g_cp.rcNew.left,(float)g_cp.rcNew.top,nw,oh,6);
-        DrawRR(g,Color(255,60,60,80),1.f,(float)g_cp.rcNew.left,(float)g_cp.rcNew.top,nw,oh,6);
-
-        
         char origHex[8]; sprintf(origHex,"#%02X%02X%02X",GetRValue(origC),GetGValue(origC),GetBValue(origC));
         wchar_t wOrigHex[8]; MultiByteToWideChar(CP_ACP,0,origHex,-1,wOrigHex,8);
         StringFormat sfHex; sfHex.SetAlignment(StringAlignmentCenter);
         float hexY=(float)g_cp.rcOld.bottom+5;
         g.DrawString(wOrigHex,-1,&fHex, RectF((float)g_cp.rcOld.left,hexY,ow,14),&sfHex,&hexB);
-
-        
-        char newHex[8]; sprintf(newHex,"#%02X%02X%02X",GetRValue(newC),GetGValue(newC),GetBValue(newC));
-        wchar_t wNewHex[8]; MultiByteToWideChar(CP_ACP,0,newHex,-1,wNewHex,8);
-        g.DrawString(wNewHex,-1,&fHex, RectF((float)g_cp.rcNew.left,hexY,nw,14),&sfHex,&hexB);
     }
 
-    
     {
         FillRR(g,Color(255,35,35,55), 10.f,303.f,280.f,28.f,8);
         DrawRR(g,Color(255,72,148,255),1.5f,10.f,303.f,280.f,28.f,8);
@@ -390,7 +806,6 @@ static void RenderCP(HDC hdc)
         g.DrawString(L"#",-1,&fN,PointF(18.f,307.f),&tb);
     }
 
-    
     {
         FontFamily ff(L"Segoe UI"); Font fB(&ff,10,FontStyleBold,UnitPoint);
         StringFormat sf; sf.SetAlignment(StringAlignmentCenter); sf.SetLineAlignment(StringAlignmentCenter);
@@ -406,9 +821,117 @@ static void RenderCP(HDC hdc)
         g.DrawString(L"Cancel",-1,&fB,RectF((float)g_cp.rcCancel.left,(float)g_cp.rcCancel.top,
                (float)(g_cp.rcCancel.right-g_cp.rcCancel.left),(float)(g_cp.rcCancel.bottom-g_cp.rcCancel.top)),&sf,&gb2);
     }
+}
+
+static bool CP_BuildLayers(HDC hdc)
+{
+    CP_FreeLayers();
+    int w=g_cp.rcSV.right-g_cp.rcSV.left, h=g_cp.rcSV.bottom-g_cp.rcSV.top;
+    BITMAPINFO bi={}; bi.bmiHeader.biSize=sizeof(bi.bmiHeader);
+    bi.bmiHeader.biWidth=w; bi.bmiHeader.biHeight=-h; bi.bmiHeader.biPlanes=1;
+    bi.bmiHeader.biBitCount=32; bi.bmiHeader.biCompression=BI_RGB;
+    void*bits=nullptr;
+    g_cp.svBmp    =CreateDIBSection(hdc,&bi,DIB_RGB_COLORS,&bits,NULL,0);
+    g_cp.chromeBmp=CreateCompatibleBitmap(hdc,CP_W,CP_H);
+    g_cp.backBmp  =CreateCompatibleBitmap(hdc,CP_W,CP_H);
+    g_cp.svDC=CreateCompatibleDC(hdc); g_cp.chromeDC=CreateCompatibleDC(hdc); g_cp.backDC=CreateCompatibleDC(hdc);
+    if(!g_cp.svBmp||!g_cp.chromeBmp||!g_cp.backBmp||!g_cp.svDC||!g_cp.chromeDC||!g_cp.backDC){
+        CP_FreeLayers(); return false;
+    }
+    g_cp.svBits=(uint32_t*)bits;
+    g_cp.svOld    =(HBITMAP)SelectObject(g_cp.svDC,g_cp.svBmp);
+    g_cp.chromeOld=(HBITMAP)SelectObject(g_cp.chromeDC,g_cp.chromeBmp);
+    g_cp.backOld  =(HBITMAP)SelectObject(g_cp.backDC,g_cp.backBmp);
+
+    Graphics g(g_cp.chromeDC);
+    g.SetSmoothingMode(SmoothingModeAntiAlias);
+    g.SetPixelOffsetMode(PixelOffsetModeHighQuality);
+    g.SetTextRenderingHint(TextRenderingHintClearTypeGridFit);
+    CP_DrawChrome(g);
+    return true;
+}
+
+// SV gradient, regenerated only when the hue changes.
+static void CP_EnsureSV()
+{
+    if(g_cp.svHue==g_cp.hue)return;
+    GdiFlush();
+    int w=g_cp.rcSV.right-g_cp.rcSV.left, h=g_cp.rcSV.bottom-g_cp.rcSV.top;
+    for(int py=0;py<h;py++){
+        float v=1.f-(float)py/(h-1);
+        HsvRamp rp={g_cp.hue,g_cp.hue,0,1,v,v};
+        HsvRowToBGRA(g_cp.svBits+(size_t)py*w,w,rp);
+    }
+    g_cp.svHue=g_cp.hue;
+}
+
+//  COLOR PICKER — render
+// Recomposes only the paint rect: chrome, then the SV gradient, then the parts that
+// follow the colour (selectors, new swatch, new hex).
+static void RenderCP(HDC hdc,const RECT&clip)
+{
+    if(!g_cp.backDC)return;
+    const int cw=clip.right-clip.left, ch=clip.bottom-clip.top;
+    BitBlt(g_cp.backDC,clip.left,clip.top,cw,ch,g_cp.chromeDC,clip.left,clip.top,SRCCOPY);
+
+    RECT svClip;
+    if(IntersectRect(&svClip,&clip,&g_cp.rcSV)){
+        CP_EnsureSV();
+        BitBlt(g_cp.backDC,svClip.left,svClip.top,svClip.right-svClip.left,svClip.bottom-svClip.top,
+               g_cp.svDC,svClip.left-g_cp.rcSV.left,svClip.top-g_cp.rcSV.top,SRCCOPY);
+    }
+
+    Graphics g(g_cp.backDC);
+    g.SetClip(Rect(clip.left,clip.top,cw,ch));
+    g.SetSmoothingMode(SmoothingModeAntiAlias);
+    g.SetPixelOffsetMode(PixelOffsetModeHighQuality);
+    g.SetTextRenderingHint(TextRenderingHintClearTypeGridFit);
+
+    // SV Square
+    {
+        int w=g_cp.rcSV.right-g_cp.rcSV.left, h=g_cp.rcSV.bottom-g_cp.rcSV.top;
+        Pen border(Color(255,60,60,80),1.f);
+        g.DrawRectangle(&border,(float)g_cp.rcSV.left,(float)g_cp.rcSV.top,(float)w,(float)h);
+
+        float sx=g_cp.rcSV.left+g_cp.sat*(w-1);
+        float sy=g_cp.rcSV.top+(1.f-g_cp.val)*(h-1);
+        Pen po(Color(255,0,0,0),2.f);   g.DrawEllipse(&po,sx-8.f,sy-8.f,16.f,16.f);
+        Pen pi(Color(255,255,255,255),2.f); g.DrawEllipse(&pi,sx-6.5f,sy-6.5f,13.f,13.f);
+    }
+
+    // Hue Selector
+    {
+        int w=g_cp.rcHue.right-g_cp.rcHue.left;
+        float sx=g_cp.rcHue.left+(g_cp.hue/360.f)*(w-1);
+        Pen sw(Color(255,255,255,255),2.f);
+        g.DrawLine(&sw,sx,(float)g_cp.rcHue.top-2,sx,(float)g_cp.rcHue.bottom+2);
+        Pen sb(Color(255,0,0,0),1.f);
+        g.DrawLine(&sb,sx-1.5f,(float)g_cp.rcHue.top-2,sx-1.5f,(float)g_cp.rcHue.bottom+2);
+        g.DrawLine(&sb,sx+1.5f,(float)g_cp.rcHue.top-2,sx+1.5f,(float)g_cp.rcHue.bottom+2);
+    }
+
+    // New Swatch + Hex
+    RECT nr=CP_NewRect(), tmp;
+    if(IntersectRect(&tmp,&clip,&nr)){
+        FontFamily ff(L"Segoe UI");
+        Font fHex(&ff,8,FontStyleBold,UnitPoint);
+        SolidBrush hexB(Color(255,150,170,210));
+        float nw=(float)(g_cp.rcNew.right-g_cp.rcNew.left);
+        float oh=(float)(g_cp.rcOld.bottom-g_cp.rcOld.top);
+
+        COLORREF newC=HSVtoRGB(g_cp.hue,g_cp.sat,g_cp.val);
+        FillRR(g,CR(newC),(float)g_cp.rcNew.left,(float)g_cp.rcNew.top,nw,oh,6);
+        DrawRR(g,Color(255,60,60,80),1.f,(float)g_cp.rcNew.left,(float)g_cp.rcNew.top,nw,oh,6);
+
+        char newHex[8]; sprintf(newHex,"#%02X%02X%02X",GetRValue(newC),GetGValue(newC),GetBValue(newC));
+        wchar_t wNewHex[8]; MultiByteToWideChar(CP_ACP,0,newHex,-1,wNewHex,8);
+        StringFormat sfHex; sfHex.SetAlignment(StringAlignmentCenter);
+        float hexY=(float)g_cp.rcOld.bottom+5;
+        g.DrawString(wNewHex,-1,&fHex, RectF((float)g_cp.rcNew.left,hexY,nw,14),&sfHex,&hexB);
+    }
 
-    BitBlt(hdc,0,0,CP_W,CP_H,memDC,0,0,SRCCOPY);
-    SelectObject(memDC,old); DeleteObject(bmp); DeleteDC(memDC);
+    g.Flush(FlushIntentionSync);
+    BitBlt(hdc,clip.left,clip.top,cw,ch,g_cp.backDC,clip.left,clip.top,SRCCOPY);
 }
 
 //  COLOR PICKER — WndProc
@@ -428,9 +951,11 @@ LRESULT CALLBACK ColorPickerProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
         SendMessageA(g_cp.hwndEdit,WM_SETFONT,(WPARAM)GetStockObject(DEFAULT_GUI_FONT),TRUE);
         SendMessageA(g_cp.hwndEdit,EM_SETLIMITTEXT,6,0);
         CP_UpdateHexEdit();
+        {HDC hdc=GetDC(hwnd); CP_BuildLayers(hdc); ReleaseDC(hwnd,hdc);}
+        g_cp.rcSelSV=CP_SelSVRect(); g_cp.rcSelHue=CP_SelHueRect();
         return 0;
 
-    case WM_PAINT:{PAINTSTRUCT ps;HDC hdc=BeginPaint(hwnd,&ps);RenderCP(hdc);EndPaint(hwnd,&ps);return 0;}
+    case WM_PAINT:{PAINTSTRUCT ps;HDC hdc=BeginPaint(hwnd,&ps);RenderCP(hdc,ps.rcPaint);EndPaint(hwnd,&ps);return 0;}
     case WM_ERASEBKGND: return 1;
 
     case WM_CTLCOLOREDIT:{
@@ -447,7 +972,7 @@ LRESULT CALLBACK ColorPickerProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
         else if(PtInRect(&g_cp.rcHue,pt)){g_cp.draggingHue=true;SetCapture(hwnd);CP_UpdateHue(pt);}
         else if(PtInRect(&g_cp.rcOK,pt)){
             *g_cp.target=HSVtoRGB(g_cp.hue,g_cp.sat,g_cp.val);
-            SaveSettings(); InvalidateRect(g_hwndSettings,NULL,FALSE);
+            SaveSettings(); SW_InvalidateCtl(g_cp.target==&g_cfg.ringColor?g_rcRing:g_rcOutline);
             DestroyWindow(hwnd); EnableWindow(g_hwndSettings,TRUE); SetForegroundWindow(g_hwndSettings);
         }
         else if(PtInRect(&g_cp.rcCancel,pt)){
@@ -455,13 +980,17 @@ LRESULT CALLBACK ColorPickerProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
         }
         return 0;
     }
-    case WM_MOUSEMOVE:{
-        POINT pt={GET_X_LPARAM(lParam),GET_Y_LPARAM(lParam)};
-        if(g_cp.draggingSV) CP_UpdateSV(pt);
-        if(g_cp.draggingHue)CP_UpdateHue(pt);
+    case WM_MOUSEMOVE:
+        if(g_cp.draggingSV||g_cp.draggingHue){
+            g_cp.pendingPt.x=GET_X_LPARAM(lParam); g_cp.pendingPt.y=GET_Y_LPARAM(lParam);
+            g_cp.pending=true; CP_FlushDrag(false);
+        }
+        return 0;
+    case WM_TIMER:
+        if(wParam==CP_FLUSH_TIMER){KillTimer(hwnd,CP_FLUSH_TIMER);g_cp.flushTimer=false;CP_FlushDrag(true);}
         return 0;
-    }
     case WM_LBUTTONUP:
+        CP_FlushDrag(true);
         g_cp.draggingSV=g_cp.draggingHue=false; ReleaseCapture(); return 0;
 
     case WM_COMMAND:
@@ -469,8 +998,9 @@ LRESULT CALLBACK ColorPickerProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
             char buf[16]; GetWindowTextA(g_cp.hwndEdit,buf,sizeof(buf));
             if(strlen(buf)==6){
                 unsigned long hex=strtoul(buf,NULL,16);
+                float oldHue=g_cp.hue;
                 RGBtoHSV(RGB((hex>>16)&0xFF,(hex>>8)&0xFF,hex&0xFF),g_cp.hue,g_cp.sat,g_cp.val);
-                InvalidateRect(hwnd,NULL,FALSE);
+                CP_Invalidate(g_cp.hue!=oldHue);
             }
         }
         return 0;
@@ -479,7 +1009,7 @@ LRESULT CALLBACK ColorPickerProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
         if(wParam==VK_ESCAPE||wParam==VK_RETURN){
             if(wParam==VK_RETURN){
                 *g_cp.target=HSVtoRGB(g_cp.hue,g_cp.sat,g_cp.val);
-                SaveSettings(); InvalidateRect(g_hwndSettings,NULL,FALSE);
+                SaveSettings(); SW_InvalidateCtl(g_cp.target==&g_cfg.ringColor?g_rcRing:g_rcOutline);
             }
             DestroyWindow(hwnd); EnableWindow(g_hwndSettings,TRUE); SetForegroundWindow(g_hwndSettings);
         }
@@ -488,7 +1018,9 @@ LRESULT CALLBACK ColorPickerProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
     case WM_CLOSE:
         DestroyWindow(hwnd); EnableWindow(g_hwndSettings,TRUE); SetForegroundWindow(g_hwndSettings);
         return 0;
-    case WM_DESTROY: g_cp.hwnd=nullptr; return 0;
+    case WM_DESTROY:
+        if(g_cp.flushTimer){KillTimer(hwnd,CP_FLUSH_TIMER);g_cp.flushTimer=false;}
+        g_cp.pending=false; CP_FreeLayers(); g_cp.hwnd=nullptr; return 0;
     }
     return DefWindowProc(hwnd,msg,wParam,lParam);
 }
@@ -499,8 +1031,9 @@ static void OpenColorPicker(COLORREF*target)
     if(g_cp.hwnd){SetForegroundWindow(g_cp.hwnd);return;}
     g_cp.target=target; g_cp.orig=*target;
     RGBtoHSV(*target,g_cp.hue,g_cp.sat,g_cp.val);
-    g_cp.draggingSV=g_cp.draggingHue=false;
+    g_cp.draggingSV=g_cp.draggingHue=false; g_cp.pending=false; g_cp.lastFlushNs=0;
 
+    DPI_AWARENESS_CONTEXT dpiPrev=BeginDpiUnaware();
     RECT rc={0,0,CP_W,CP_H};
     AdjustWindowRect(&rc,WS_CAPTION|WS_POPUP|WS_SYSMENU,FALSE);
     int ww=rc.right-rc.left,wh=rc.bottom-rc.top;
@@ -509,120 +1042,179 @@ static void OpenColorPicker(COLORREF*target)
 
     g_cp.hwnd=CreateWindowExA(0,"CF_ColorPicker","Pick a Color",
         WS_CAPTION|WS_POPUP|WS_SYSMENU,x,y,ww,wh,g_hwndSettings,NULL,GetModuleHandle(NULL),NULL);
+    EndDpiUnaware(dpiPrev);
     EnableWindow(g_hwndSettings,FALSE);
     ShowWindow(g_cp.hwnd,SW_SHOW);
     SetForegroundWindow(g_cp.hwnd);
 }
 
-//  SETTINGS WINDOW — DRAW
-static void DrawSettings(HDC hdc)
-{
-    HDC memDC=CreateCompatibleDC(hdc);
-    HBITMAP bmp=CreateCompatibleBitmap(hdc,SW_W,SW_H);
-    HBITMAP old=(HBITMAP)SelectObject(memDC,bmp);
+//  SETTINGS WINDOW — RESOURCES
+// Fonts, formats and theme brushes, created on first paint and kept until shutdown.
+struct SettingsRes {
+    FontFamily*  ff       = nullptr;
+    FontFamily*  ffA      = nullptr;
+    Font*        fTitle   = nullptr;
+    Font*        fNorm    = nullptr;
+    Font*        fSub     = nullptr;
+    Font*        fBtnS    = nullptr;
+    Font*        fLogo    = nullptr;
+    Font*        fGH      = nullptr;
+    StringFormat*sfCenter = nullptr;
+    SolidBrush*  bText[2] = {}, *bSub[2] = {}, *bAccent[2] = {};   // [darkMode]
+};
+static SettingsRes g_sres;
+
+static void SW_EnsureRes(){
+    if(g_sres.ff)return;
+    g_sres.ff =new FontFamily(L"Segoe UI");
+    g_sres.ffA=new FontFamily(L"Arial");
+    g_sres.fTitle=new Font(g_sres.ff,13,FontStyleBold,UnitPoint);
+    g_sres.fNorm =new Font(g_sres.ff,10,FontStyleRegular,UnitPoint);
+    g_sres.fSub  =new Font(g_sres.ff, 9,FontStyleRegular,UnitPoint);
+    g_sres.fBtnS =new Font(g_sres.ff,10,FontStyleBold,UnitPoint);
+    g_sres.fGH   =new Font(g_sres.ff, 9,FontStyleBold,UnitPoint);
+    g_sres.fLogo =new Font(g_sres.ffA,8,FontStyleBold,UnitPoint);
+    g_sres.sfCenter=new StringFormat();
+    g_sres.sfCenter->SetAlignment(StringAlignmentCenter); g_sres.sfCenter->SetLineAlignment(StringAlignmentCenter);
+    for(int d=0;d<2;d++){
+        TC t=GetTC(d!=0);
+        g_sres.bText[d]=new SolidBrush(t.text); g_sres.bSub[d]=new SolidBrush(t.sub); g_sres.bAccent[d]=new SolidBrush(t.accent);
+    }
+}
+static void SW_FreeRes(){
+    if(!g_sres.ff)return;
+    for(int d=0;d<2;d++){delete g_sres.bText[d];delete g_sres.bSub[d];delete g_sres.bAccent[d];}
+    delete g_sres.sfCenter;
+    delete g_sres.fTitle;delete g_sres.fNorm;delete g_sres.fSub;delete g_sres.fBtnS;delete g_sres.fGH;delete g_sres.fLogo;
+    delete g_sres.ffA;delete g_sres.ff;
+    g_sres=SettingsRes();
+}
 
-    Graphics g(memDC);
+//  SETTINGS WINDOW — LAYERS
+// A chrome layer per theme holds everything that only changes with the theme; each control
+// has a small layer re-rendered only when its state key changes; a back buffer composes
+// the paint rect from them.
+struct UiLayer {
+    HDC      dc  = nullptr;
+    HBITMAP  bmp = nullptr, old = nullptr;
+    uint32_t key = 0xFFFFFFFF;        // state the layer was drawn for
+};
+static bool Layer_Ensure(UiLayer&l,HDC ref,int w,int h){
+    if(l.dc)return true;
+    l.bmp=CreateCompatibleBitmap(ref,w,h); l.dc=CreateCompatibleDC(ref);
+    if(!l.bmp||!l.dc){if(l.bmp)DeleteObject(l.bmp);if(l.dc)DeleteDC(l.dc);l=UiLayer();return false;}
+    l.old=(HBITMAP)SelectObject(l.dc,l.bmp); l.key=0xFFFFFFFF;
+    return true;
+}
+static void Layer_Free(UiLayer&l){
+    if(l.dc){SelectObject(l.dc,l.old);DeleteDC(l.dc);}
+    if(l.bmp)DeleteObject(l.bmp);
+    l=UiLayer();
+}
+static void Layer_Graphics(Graphics&g){
     g.SetSmoothingMode(SmoothingModeAntiAlias);
     g.SetTextRenderingHint(TextRenderingHintClearTypeGridFit);
     g.SetPixelOffsetMode(PixelOffsetModeHighQuality);
+}
+
+enum { SC_RING, SC_OUTLINE, SC_SLOW, SC_NORM, SC_FAST, SC_MOVE, SC_BOOT, SC_COUNT };
+struct SettingsCache {
+    UiLayer back;
+    UiLayer chrome[2];                // [darkMode]
+    UiLayer ctl[SC_COUNT];
+};
+static SettingsCache g_sc;
+
+static RECT* SW_CtlRect(int i){
+    static RECT* r[SC_COUNT]={&g_rcRing,&g_rcOutline,&g_rcSlow,&g_rcNorm,&g_rcFast,&g_rcMove,&g_rcBoot};
+    return r[i];
+}
+static uint32_t SW_CtlKey(int i){
+    uint32_t dark=g_cfg.darkMode?1u:0u;
+    switch(i){
+    case SC_RING:    return (g_cfg.ringColor&0xFFFFFF)|dark<<24;
+    case SC_OUTLINE: return (g_cfg.outlineColor&0xFFFFFF)|dark<<24;
+    case SC_MOVE:    return (g_cfg.moveCancel?1u:0u)|dark<<1;
+    case SC_BOOT:    return (g_cfg.startOnBoot?1u:0u)|dark<<1;
+    default:         return (g_cfg.speed==i-SC_SLOW?1u:0u)|dark<<1;
+    }
+}
 
-    TC t=GetTC();
+// Fixed layout; the hit-test rects used by SettingsWndProc.
+static const float SW_SWX=(float)(SW_W-82), SW_SWW=58, SW_SWH=30;
+static const float SW_BY=238, SW_BH=34, SW_BGAP=7, SW_BW=(SW_W-40-SW_BGAP*2)/3.f;
+static void SW_Layout(){
+    const float iconSz=26.f,iconX=(float)(SW_W-46),iconY=20.f;
+    SetRect(&g_rcTheme,(int)iconX-2,(int)iconY-2,(int)(iconX+iconSz+4),(int)(iconY+iconSz+4));
+    SetRect(&g_rcRing,   (int)SW_SWX, 79,(int)(SW_SWX+SW_SWW), 79+(int)SW_SWH);
+    SetRect(&g_rcOutline,(int)SW_SWX,144,(int)(SW_SWX+SW_SWW),144+(int)SW_SWH);
+    RECT* spR[]={&g_rcSlow,&g_rcNorm,&g_rcFast};
+    for(int i=0;i<3;i++){
+        float bx=20.f+i*(SW_BW+SW_BGAP);
+        SetRect(spR[i],(int)bx,(int)SW_BY,(int)(bx+SW_BW),(int)(SW_BY+SW_BH));
+    }
+    SetRect(&g_rcMove,SW_W-64,295,SW_W-64+44,319);
+    SetRect(&g_rcBoot,SW_W-64,369,SW_W-64+44,393);
+    SetRect(&g_rcGithub,20,433,SW_W-20,469);
+}
+
+static void SW_DrawChrome(Graphics&g,bool dark)
+{
+    TC t=GetTC(dark); const int d=dark?1:0;
+    const SettingsRes&R=g_sres;
 
     SolidBrush bgB(t.bg); g.FillRectangle(&bgB,0,0,SW_W,SW_H);
 
     {SolidBrush hB(t.hdrBg); g.FillRectangle(&hB,0,0,SW_W,66);}
     {Pen sep(t.sep,1); g.DrawLine(&sep,0.f,66.f,(float)SW_W,66.f);}
 
-    FontFamily ff(L"Segoe UI");
-    Font fTitle(&ff,13,FontStyleBold,UnitPoint);
-    Font fNorm (&ff,10,FontStyleRegular,UnitPoint);
-    Font fSub  (&ff, 9,FontStyleRegular,UnitPoint);
-    Font fBtnS (&ff,10,FontStyleBold,UnitPoint);
-    Font fLink (&ff, 9,FontStyleUnderline,UnitPoint);
-    SolidBrush bText(t.text),bSub(t.sub),bAccent(t.accent);
-
     {
         float lx=14.f,ly=15.f,lsz=36.f;
-    
         SolidBrush logoBg(Color(255,30,30,50));
         g.FillEllipse(&logoBg,lx,ly,lsz,lsz);
         Pen logoRing(Color(255,72,148,255),2.f);
         g.DrawEllipse(&logoRing,lx+1.f,ly+1.f,lsz-2.f,lsz-2.f);
-       
-        FontFamily ffA(L"Arial"); Font fLogo(&ffA,8,FontStyleBold,UnitPoint);
         SolidBrush logoTxt(Color(255,220,230,255));
-        StringFormat sfL; sfL.SetAlignment(StringAlignmentCenter); sfL.SetLineAlignment(StringAlignmentCenter);
-        g.DrawString(L"BCF",-1,&fLogo,RectF(lx,ly,lsz,lsz),&sfL,&logoTxt);
+        g.DrawString(L"BCF",-1,R.fLogo,RectF(lx,ly,lsz,lsz),R.sfCenter,&logoTxt);
     }
 
-    g.DrawString(L"Better Cursor Finder",-1,&fTitle,PointF(58,17),&bText);
-    g.DrawString(L"v2.0",-1,&fSub,PointF(60,40),&bSub);
+    g.DrawString(L"Better Cursor Finder",-1,R.fTitle,PointF(58,17),R.bText[d]);
+    g.DrawString(L"v2.0",-1,R.fSub,PointF(60,40),R.bSub[d]);
 
     float iconSz=26.f,iconX=(float)(SW_W-46),iconY=20.f;
     FillRR(g,t.border,iconX-2,iconY-2,iconSz+4,iconSz+4,(iconSz+4)/2);
-    if(g_cfg.darkMode) DrawSun (g,iconX+iconSz/2,iconY+iconSz/2,iconSz,Color(255,255,210,60));
-    else               DrawMoon(g,iconX+iconSz/2,iconY+iconSz/2,iconSz,Color(255,160,160,220),t.hdrBg);
-    SetRect(&g_rcTheme,(int)iconX-2,(int)iconY-2,(int)(iconX+iconSz+4),(int)(iconY+iconSz+4));
+    if(dark) DrawSun (g,iconX+iconSz/2,iconY+iconSz/2,iconSz,Color(255,255,210,60));
+    else     DrawMoon(g,iconX+iconSz/2,iconY+iconSz/2,iconSz,Color(255,160,160,220),t.hdrBg);
 
-    float swX=(float)(SW_W-82),swW=58,swH=30;
     auto sepLine=[&](float y){Pen p(t.sep,1);g.DrawLine(&p,20.f,y,(float)(SW_W-20),y);};
-    auto swatch=[&](COLORREF col,float y,RECT&rc){
-        float sy=y-2;
-        FillRR(g,CR(col),swX,sy,swW,swH,8);
-        DrawRR(g,t.border,1.5f,swX,sy,swW,swH,8);
-        SetRect(&rc,(int)swX,(int)sy,(int)(swX+swW),(int)(sy+swH));
-    };
-
-    // Ring Color
+
     float y=78;
-    g.DrawString(L"Ring Color",-1,&fNorm,PointF(20,y),&bText);
-    g.DrawString(L"Change the ring's color",-1,&fSub,PointF(20,y+20),&bSub);
-    swatch(g_cfg.ringColor,y+3,g_rcRing);
+    g.DrawString(L"Ring Color",-1,R.fNorm,PointF(20,y),R.bText[d]);
+    g.DrawString(L"Change the ring's color",-1,R.fSub,PointF(20,y+20),R.bSub[d]);
     sepLine(130);
 
-    // Outline Color
     y=143;
-    g.DrawString(L"Outline Color",-1,&fNorm,PointF(20,y),&bText);
-    g.DrawString(L"Color of the outline around the ring",-1,&fSub,PointF(20,y+20),&bSub);
-    swatch(g_cfg.outlineColor,y+3,g_rcOutline);
+    g.DrawString(L"Outline Color",-1,R.fNorm,PointF(20,y),R.bText[d]);
+    g.DrawString(L"Color of the outline around the ring",-1,R.fSub,PointF(20,y+20),R.bSub[d]);
     sepLine(195);
 
-    // Animation Speed
     y=208;
-    g.DrawString(L"Animation Speed",-1,&fNorm,PointF(20,y),&bText);
-    float bY=y+30,bH=34,bGap=7,bW=(SW_W-40-bGap*2)/3.f;
-    const wchar_t* spL[]={L"Slow",L"Normal",L"Fast"};
-    RECT* spR[]={&g_rcSlow,&g_rcNorm,&g_rcFast};
-    for(int i=0;i<3;i++){
-        float bx=20.f+i*(bW+bGap); bool sel=(g_cfg.speed==i);
-        FillRR(g,sel?t.accent:t.cardBg,bx,bY,bW,bH,8);
-        DrawRR(g,sel?t.accent:t.border,1.5f,bx,bY,bW,bH,8);
-        SolidBrush bt(sel?Color(255,255,255,255):t.text);
-        StringFormat sf; sf.SetAlignment(StringAlignmentCenter); sf.SetLineAlignment(StringAlignmentCenter);
-        g.DrawString(spL[i],-1,sel?&fBtnS:&fNorm,RectF(bx,bY,bW,bH),&sf,&bt);
-        SetRect(spR[i],(int)bx,(int)bY,(int)(bx+bW),(int)(bY+bH));
-    }
+    g.DrawString(L"Animation Speed",-1,R.fNorm,PointF(20,y),R.bText[d]);
     sepLine(278);
 
-    // Move cancel toggle
     y=291;
-    g.DrawString(L"Cancel on mouse move",-1,&fNorm,PointF(20,y),&bText);
-    g.DrawString(L"Stop animation if the mouse moves",-1,&fSub,PointF(20,y+20),&bSub);
-    DrawToggle(g,(float)(SW_W-64),y+4,g_cfg.moveCancel,t.accent,t.togOff);
-    SetRect(&g_rcMove,SW_W-64,(int)(y+4),SW_W-64+44,(int)(y+28));
+    g.DrawString(L"Cancel on mouse move",-1,R.fNorm,PointF(20,y),R.bText[d]);
+    g.DrawString(L"Stop animation if the mouse moves",-1,R.fSub,PointF(20,y+20),R.bSub[d]);
     sepLine(352);
 
-    // Launch at startup
     y=365;
-    g.DrawString(L"Launch at startup",-1,&fNorm,PointF(20,y),&bText);
-    g.DrawString(L"Start automatically with Windows",-1,&fSub,PointF(20,y+20),&bSub);
-    DrawToggle(g,(float)(SW_W-64),y+4,g_cfg.startOnBoot,t.accent,t.togOff);
-    SetRect(&g_rcBoot,SW_W-64,(int)(y+4),SW_W-64+44,(int)(y+28));
+    g.DrawString(L"Launch at startup",-1,R.fNorm,PointF(20,y),R.bText[d]);
+    g.DrawString(L"Start automatically with Windows",-1,R.fSub,PointF(20,y+20),R.bSub[d]);
     sepLine(425);
 
     {
         float gbX=20.f, gbY=433.f, gbW=(float)(SW_W-40), gbH=36.f;
-        Color ghBg = g_cfg.darkMode ? Color(255,28,28,46) : Color(255,215,218,238);
+        Color ghBg = dark ? Color(255,28,28,46) : Color(255,215,218,238);
         FillRR(g,ghBg,gbX,gbY,gbW,gbH,10);
         DrawRR(g,t.border,1.5f,gbX,gbY,gbW,gbH,10);
 
@@ -642,27 +1234,102 @@ static void DrawSettings(HDC hdc)
             PointF(gx+gr*.62f,gy+gr*.1f)
         };
         g.FillPolygon(&ghW,body,7);
+        g.DrawString(L"mattytheprofessional",-1,R.fGH,RectF(gbX+32.f,gbY,gbW-34.f,gbH),R.sfCenter,R.bAccent[d]);
+    }
 
-        Font fGH(&ff,9,FontStyleBold,UnitPoint);
-        StringFormat sfGH; sfGH.SetAlignment(StringAlignmentCenter); sfGH.SetLineAlignment(StringAlignmentCenter);
-        g.DrawString(L"mattytheprofessional",-1,&fGH,
-            RectF(gbX+32.f,gbY,gbW-34.f,gbH),&sfGH,&bAccent);
+    g.DrawString(L"System tray - right-click for options",-1,R.fSub,RectF(0,474,SW_W,18),R.sfCenter,R.bSub[d]);
+}
 
-        SetRect(&g_rcGithub,(int)gbX,(int)gbY,(int)(gbX+gbW),(int)(gbY+gbH));
+// One control in window coordinates; the caller translates into the control's layer.
+static void SW_DrawControl(Graphics&g,int i,bool dark)
+{
+    TC t=GetTC(dark); const int d=dark?1:0;
+    const RECT&rc=*SW_CtlRect(i);
+    switch(i){
+    case SC_RING: case SC_OUTLINE:{
+        COLORREF col=i==SC_RING?g_cfg.ringColor:g_cfg.outlineColor;
+        FillRR(g,CR(col),SW_SWX,(float)rc.top,SW_SWW,SW_SWH,8);
+        DrawRR(g,t.border,1.5f,SW_SWX,(float)rc.top,SW_SWW,SW_SWH,8);
+        break;
+    }
+    case SC_MOVE: DrawToggle(g,(float)rc.left,(float)rc.top,g_cfg.moveCancel,t.accent,t.togOff);  break;
+    case SC_BOOT: DrawToggle(g,(float)rc.left,(float)rc.top,g_cfg.startOnBoot,t.accent,t.togOff); break;
+    default:{
+        static const wchar_t* spL[]={L"Slow",L"Normal",L"Fast"};
+        int s=i-SC_SLOW; bool sel=(g_cfg.speed==s);
+        float bx=20.f+s*(SW_BW+SW_BGAP);
+        FillRR(g,sel?t.accent:t.cardBg,bx,SW_BY,SW_BW,SW_BH,8);
+        DrawRR(g,sel?t.accent:t.border,1.5f,bx,SW_BY,SW_BW,SW_BH,8);
+        SolidBrush white(Color(255,255,255,255));
+        g.DrawString(spL[s],-1,sel?g_sres.fBtnS:g_sres.fNorm,RectF(bx,SW_BY,SW_BW,SW_BH),g_sres.sfCenter,
+                     sel?(Brush*)&white:(Brush*)g_sres.bText[d]);
     }
+    }
+}
 
-    StringFormat sfC; sfC.SetAlignment(StringAlignmentCenter); sfC.SetLineAlignment(StringAlignmentCenter);
-    g.DrawString(L"System tray - right-click for options",-1,&fSub,RectF(0,474,SW_W,18),&sfC,&bSub);
+static bool SW_EnsureChrome(HDC ref,bool dark){
+    UiLayer&l=g_sc.chrome[dark?1:0];
+    if(!Layer_Ensure(l,ref,SW_W,SW_H))return false;
+    if(l.key==0)return true;             // chrome has no state beyond its theme
+    SW_EnsureRes();
+    Graphics g(l.dc); Layer_Graphics(g);
+    SW_DrawChrome(g,dark);
+    l.key=0;
+    return true;
+}
+static void SW_EnsureControl(HDC ref,int i){
+    RECT pr=SW_PadRect(*SW_CtlRect(i));
+    UiLayer&l=g_sc.ctl[i];
+    if(!Layer_Ensure(l,ref,pr.right-pr.left,pr.bottom-pr.top))return;
+    uint32_t key=SW_CtlKey(i);
+    if(l.key==key)return;
+    const bool dark=g_cfg.darkMode;
+    BitBlt(l.dc,0,0,pr.right-pr.left,pr.bottom-pr.top,g_sc.chrome[dark?1:0].dc,pr.left,pr.top,SRCCOPY);
+    Graphics g(l.dc); Layer_Graphics(g);
+    g.TranslateTransform(-(float)pr.left,-(float)pr.top);
+    SW_DrawControl(g,i,dark);
+    l.key=key;
+}
 
-    BitBlt(hdc,0,0,SW_W,SW_H,memDC,0,0,SRCCOPY);
-    SelectObject(memDC,old); DeleteObject(bmp); DeleteDC(memDC);
+// Builds the current theme's chrome and every control layer so the first show is a blit.
+static void SW_Prewarm(){
+    if(!g_hwndSettings||!Gdip_Ensure())return;
+    HDC hdc=GetDC(g_hwndSettings);
+    if(Layer_Ensure(g_sc.back,hdc,SW_W,SW_H)&&SW_EnsureChrome(hdc,g_cfg.darkMode))
+        for(int i=0;i<SC_COUNT;i++)SW_EnsureControl(hdc,i);
+    ReleaseDC(g_hwndSettings,hdc);
+}
+static void SW_FreeCache(){
+    Layer_Free(g_sc.back);
+    for(auto&l:g_sc.chrome)Layer_Free(l);
+    for(auto&l:g_sc.ctl)Layer_Free(l);
+    SW_FreeRes();
+}
+
+//  SETTINGS WINDOW — DRAW
+static void DrawSettings(HDC hdc,const RECT&clip)
+{
+    const bool dark=g_cfg.darkMode;
+    if(!Layer_Ensure(g_sc.back,hdc,SW_W,SW_H)||!SW_EnsureChrome(hdc,dark))return;
+    const int cw=clip.right-clip.left, ch=clip.bottom-clip.top;
+    BitBlt(g_sc.back.dc,clip.left,clip.top,cw,ch,g_sc.chrome[dark?1:0].dc,clip.left,clip.top,SRCCOPY);
+    for(int i=0;i<SC_COUNT;i++){
+        RECT pr=SW_PadRect(*SW_CtlRect(i)), part;
+        if(!IntersectRect(&part,&pr,&clip))continue;
+        SW_EnsureControl(hdc,i);
+        BitBlt(g_sc.back.dc,part.left,part.top,part.right-part.left,part.bottom-part.top,
+               g_sc.ctl[i].dc,part.left-pr.left,part.top-pr.top,SRCCOPY);
+    }
+    BitBlt(hdc,clip.left,clip.top,cw,ch,g_sc.back.dc,clip.left,clip.top,SRCCOPY);
 }
 
 //  SETTINGS — WndProc
 LRESULT CALLBACK SettingsWndProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
 {
     switch(msg){
-    case WM_PAINT:{PAINTSTRUCT ps;HDC hdc=BeginPaint(hwnd,&ps);DrawSettings(hdc);EndPaint(hwnd,&ps);return 0;}
+    case WM_CREATE: SW_Layout(); return 0;
+    case WM_BCF_PREWARM: SW_Prewarm(); return 0;
+    case WM_PAINT:{PAINTSTRUCT ps;HDC hdc=BeginPaint(hwnd,&ps);DrawSettings(hdc,ps.rcPaint);EndPaint(hwnd,&ps);return 0;}
     case WM_ERASEBKGND: return 1;
 
     case WM_SETCURSOR:{
@@ -673,16 +1340,20 @@ LRESULT CALLBACK SettingsWndProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
 
     case WM_LBUTTONDOWN:{
         POINT pt={GET_X_LPARAM(lParam),GET_Y_LPARAM(lParam)};
-        auto repaint=[&]{InvalidateRect(hwnd,NULL,FALSE);};
+        auto speed=[&](int s){
+            if(g_cfg.speed==s)return;
+            SW_InvalidateCtl(*SW_CtlRect(SC_SLOW+g_cfg.speed)); g_cfg.speed=s; SaveSettings();
+            SW_InvalidateCtl(*SW_CtlRect(SC_SLOW+s));
+        };
 
-        if(PtInRect(&g_rcTheme,pt)){g_cfg.darkMode=!g_cfg.darkMode;SaveSettings();repaint();return 0;}
+        if(PtInRect(&g_rcTheme,pt)){g_cfg.darkMode=!g_cfg.darkMode;SaveSettings();InvalidateRect(hwnd,NULL,FALSE);return 0;}
         if(PtInRect(&g_rcRing,   pt)){OpenColorPicker(&g_cfg.ringColor);   return 0;}
         if(PtInRect(&g_rcOutline,pt)){OpenColorPicker(&g_cfg.outlineColor);return 0;}
-        if(PtInRect(&g_rcSlow,pt)){g_cfg.speed=0;SaveSettings();repaint();return 0;}
-        if(PtInRect(&g_rcNorm,pt)){g_cfg.speed=1;SaveSettings();repaint();return 0;}
-        if(PtInRect(&g_rcFast,pt)){g_cfg.speed=2;SaveSettings();repaint();return 0;}
-        if(PtInRect(&g_rcMove,pt)){g_cfg.moveCancel=!g_cfg.moveCancel;SaveSettings();repaint();return 0;}
-        if(PtInRect(&g_rcBoot,pt)){g_cfg.startOnBoot=!g_cfg.startOnBoot;ApplyStartup(g_cfg.startOnBoot);SaveSettings();repaint();return 0;}
+        if(PtInRect(&g_rcSlow,pt)){speed(0);return 0;}
+        if(PtInRect(&g_rcNorm,pt)){speed(1);return 0;}
+        if(PtInRect(&g_rcFast,pt)){speed(2);return 0;}
+        if(PtInRect(&g_rcMove,pt)){g_cfg.moveCancel=!g_cfg.moveCancel;SaveSettings();SW_InvalidateCtl(g_rcMove);return 0;}
+        if(PtInRect(&g_rcBoot,pt)){g_cfg.startOnBoot=!g_cfg.startOnBoot;ApplyStartup(g_cfg.startOnBoot);SaveSettings();SW_InvalidateCtl(g_rcBoot);return 0;}
         if(PtInRect(&g_rcGithub,pt)){ShellExecuteA(NULL,"open","https://github.com/mattytheprofessional",NULL,NULL,SW_SHOW);return 0;}
         return 0;
     }
@@ -697,90 +1368,745 @@ LRESULT CALLBACK SettingsWndProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
 }
 
 //  ANIMATION
+// Everything down to RENDER THREAD runs on the render thread, except SyncRawMouse and
+// OnTap, which belong to the UI thread and only send commands.
+// Re-creates the surface (and the atlas baked for it) after a display or DPI change, or
+// when the cursor is on a monitor with another DPI than the surface was made for.
+static void EnsureOverlaySurface(POINT at){
+    int dpi=DpiAt(at);
+    if(g_ov.dc&&!g_ovDpiDirty&&g_ov.dpi==dpi)return;
+    g_ovDpiDirty=false;
+    if(Surf_Ensure(g_ov,MulDiv(OV_SIZE,dpi,96),dpi)) RebuildAtlas();
+}
+static bool g_spotAnim = false;     // the running animation is a spotlight
 static void ClearAndHide()
 {
-    HDC hdcS=GetDC(NULL);HDC hdcM=CreateCompatibleDC(hdcS);
+    if(g_spotAnim){
+        Spot_Present(g_spot,IRect(),0);
+        ShowWindow(g_hwndSpot,SW_HIDE);
+        g_spotAnim=false;
+        return;
+    }
+    if(g_ov.dc){
+        Surf_Back(g_ov);
+        Surf_Present(g_ov,g_hwndRing,g_cursor,IRect());
+    }
+    ShowWindow(g_hwndRing,SW_HIDE);
+}
+static FramePacer g_pacer;
+static FrameStats g_stats;
+// What the UI thread reports for IPC_GET_STATS; republished as each animation starts and ends.
+static SnapshotBuffer<StatsCounters> g_statsPub;
+static void PublishStats(){g_statsPub.Publish(Stats_Counters(g_stats));}
+static MotionPredictor g_motion;    // fed by raw input and each frame's own cursor read
+static FrameGovernor g_gov;         // sets g_pacer.divisor and the ring's quality per frame
+
+//  TRACE
+// Opt-in recording for tools/bcf_trace_replay. Each thread pushes into its own ring of
+// g_trace; the UI thread drains them into the file. The pacer reads the clock through
+// g_paceClock so a tick can record what its frame was scheduled from.
+static TraceRecorder g_trace;
+static TraceClock    g_paceClock;
+static char          g_tracePath[MAX_PATH+48];
+static void TraceRender(uint8_t type,int64_t tNs,int32_t x=0,int32_t y=0,uint8_t a=0){
+    if(!Trace_On(g_trace))return;
+    TraceEvent e; e.type=type; e.tNs=tNs; e.x=x; e.y=y; e.a=a;
+    Trace_Push(g_trace,g_trace.render,e);
+}
+static void TraceConfig(){
+    if(!Trace_On(g_trace))return;
+    TraceEvent e; e.type=TR_CONFIG; e.tNs=g_clock.NowNs();
+    e.a=(uint8_t)g_rcfg.speed; e.b=(uint8_t)(g_rcfg.moveCancel|g_rcfg.mode<<1|g_rcfg.power<<2);
+    e.c=(uint8_t)g_rcfg.prediction;
+    Trace_Push(g_trace,g_trace.render,e);
+}
+static void TraceGov(int64_t tNs){
+    if(!Trace_On(g_trace))return;
+    GovStep s=Gov_Current(g_gov);
+    TraceEvent e; e.type=TR_GOV; e.tNs=tNs;
+    e.a=(uint8_t)g_gov.level; e.b=(uint8_t)s.divisor; e.c=s.quality; e.periodNs=g_gov.periodNs;
+    Trace_Push(g_trace,g_trace.render,e);
+}
+
+// The frame timer only runs while animating or while a trail is on screen; otherwise the
+// render thread sleeps until a command arrives. It is one-shot and is armed for the earlier
+// of the two wakes: the one the pacer asks for and the trail's next frame.
+static int64_t g_animWakeNs  = 0;       // 0: not waiting
+static int64_t g_trailWakeNs = 0;
+static const int64_t TIMER_SLACK_NS = 250000;
+static void RearmFrameTimer(){
+    if(!g_frameTimer)return;
+    int64_t wake=!g_animWakeNs?g_trailWakeNs:!g_trailWakeNs?g_animWakeNs:std::min(g_animWakeNs,g_trailWakeNs);
+    if(!wake){CancelWaitableTimer(g_frameTimer);return;}
+    LARGE_INTEGER due; due.QuadPart=-(LONGLONG)std::max<int64_t>((wake-g_clock.NowNs())/100,1);
+    SetWaitableTimer(g_frameTimer,&due,0,NULL,NULL,FALSE);
+}
+static void ArmFrameTimer(bool on,int64_t wakeNs=0){
+    g_animWakeNs=on?(wakeNs?wakeNs:g_clock.NowNs()):0;
+    RearmFrameTimer();
+}
+// Mouse buttons count as combo / cancel keys, but the keyboard hook cannot see them, so raw
+// mouse input is registered while Ctrl is held or the ring is on screen, and all the time
+// in trail and shake modes and while a trace records, which need every pointer report.
+// UI thread.
+static void SyncRawMouse(){
+    bool want=(g_kbHook&&(g_tap.ctrlWas||g_animating))||g_cfg.trail||g_cfg.shake||Trace_On(g_trace);
+    if(want==g_rawMouse)return;
+    RAWINPUTDEVICE rid={0x01,0x02,(DWORD)(want?RIDEV_INPUTSINK:RIDEV_REMOVE),want?g_hwndOverlay:NULL};
+    if(RegisterRawInputDevices(&rid,1,sizeof(rid)))g_rawMouse=want;
+}
+static void EndAnimation(TraceEnd reason){
+    TraceRender(TR_END,g_clock.NowNs(),0,0,reason);
+    g_animating=false;ArmFrameTimer(false);ClearAndHide();
+    PostMessageA(g_hwndOverlay,WM_BCF_ANIM,0,0);
+    const PaceStats&ps=g_pacer.stats;
+    g_stats.missed+=ps.missed; Stats_Drain(g_stats); PublishStats();
+    char buf[128];
+    sprintf(buf,"BCF: %llu frames, %llu skipped, %llu missed, interval %.2f ms +/- %.3f\n",
+            ps.frames,ps.skipped,ps.missed,ps.meanNs/1e6,PaceJitterNs(ps)/1e6);
+    OutputDebugStringA(buf);
+}
+static void CancelAnimation(TraceEnd reason){if(!g_animating)return;g_stats.cancelled++;EndAnimation(reason);}
+
+//  AUTO CONTRAST
+// The screen under the overlay is captured when the ring starts and again every
+// CONTRAST_RESAMPLE_NS once the pointer has moved a quarter of the overlay, and the ring
+// colours follow ContrastPick. BitBlt without CAPTUREBLT leaves layered windows out, so the
+// ring never measures itself. A capture slower than the governor's frame budget stops the
+// resampling for the rest of that animation.
+static const int     CONTRAST_STEP        = 4;            // rows measured: every 4th
+static const int64_t CONTRAST_RESAMPLE_NS = 100000000;
+struct CaptureSurface {
+    HDC      dc     = nullptr;
+    HBITMAP  bmp    = nullptr;
+    HBITMAP  oldBmp = nullptr;
+    uint32_t*bits   = nullptr;
+    int      size   = 0;
+};
+struct ContrastStats { uint64_t captures = 0, slow = 0, switches = 0; int64_t totalNs = 0, maxNs = 0; };
+static CaptureSurface g_cap;
+static ContrastChoice g_contrast     = CC_CONFIG;
+static ContrastStats  g_contrastStats;
+static int64_t        g_contrastAt   = 0;
+static POINT          g_contrastPt   = {};
+static bool           g_contrastSlow = false;
+
+static void Cap_Destroy(CaptureSurface&s){
+    if(!s.dc)return;
+    if(s.oldBmp)SelectObject(s.dc,s.oldBmp);
+    if(s.bmp)DeleteObject(s.bmp);
+    DeleteDC(s.dc);
+    s.dc=nullptr; s.bmp=s.oldBmp=nullptr; s.bits=nullptr; s.size=0;
+}
+static bool Cap_Ensure(CaptureSurface&s,int size){
+    if(s.dc&&s.size==size)return true;
+    Cap_Destroy(s);
+    s.dc=CreateCompatibleDC(NULL); if(!s.dc)return false;
     BITMAPINFO bmi={};bmi.bmiHeader.biSize=sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth=OV_SIZE;bmi.bmiHeader.biHeight=-OV_SIZE;
+    bmi.bmiHeader.biWidth=size;bmi.bmiHeader.biHeight=-size;
     bmi.bmiHeader.biPlanes=1;bmi.bmiHeader.biBitCount=32;bmi.bmiHeader.biCompression=BI_RGB;
-    void*pv=nullptr;HBITMAP hb=CreateDIBSection(hdcM,&bmi,DIB_RGB_COLORS,&pv,NULL,0);
-    HBITMAP ho=(HBITMAP)SelectObject(hdcM,hb);
-    memset(pv,0,OV_SIZE*OV_SIZE*4);
-    POINT ptS={0,0};SIZE szW={OV_SIZE,OV_SIZE};
-    POINT ptD={g_cursor.x-OV_SIZE/2,g_cursor.y-OV_SIZE/2};
-    BLENDFUNCTION bf={};bf.BlendOp=AC_SRC_OVER;bf.SourceConstantAlpha=255;bf.AlphaFormat=AC_SRC_ALPHA;
-    UpdateLayeredWindow(g_hwndOverlay,hdcS,&ptD,&szW,hdcM,&ptS,0,&bf,ULW_ALPHA);
-    SelectObject(hdcM,ho);DeleteObject(hb);DeleteDC(hdcM);ReleaseDC(NULL,hdcS);
-    ShowWindow(g_hwndOverlay,SW_HIDE);
+    void*pv=nullptr; s.bmp=CreateDIBSection(s.dc,&bmi,DIB_RGB_COLORS,&pv,NULL,0);
+    if(!s.bmp){Cap_Destroy(s);return false;}
+    s.bits=(uint32_t*)pv; s.oldBmp=(HBITMAP)SelectObject(s.dc,s.bmp); s.size=size;
+    return true;
+}
+static void ContrastSample(POINT at,int64_t now){
+    const int sz=g_ov.size;
+    if(!Cap_Ensure(g_cap,sz))return;
+    HDC screen=GetDC(NULL);
+    BitBlt(g_cap.dc,0,0,sz,sz,screen,at.x-sz/2,at.y-sz/2,SRCCOPY);
+    ReleaseDC(NULL,screen);
+    GdiFlush();
+    LumaStats bg; LumaMeasure(g_cap.bits,sz,sz,sz,CONTRAST_STEP,bg);
+    ContrastChoice c=ContrastPick(bg,g_rcfg.ringColor,g_rcfg.outlineColor,g_contrast);
+    const int64_t ns=g_clock.NowNs()-now;
+    ContrastStats&cs=g_contrastStats;
+    cs.captures++; cs.totalNs+=ns; cs.maxNs=std::max(cs.maxNs,ns);
+    if(ns>g_gov.pol.budgetNs){g_contrastSlow=true;cs.slow++;}
+    if(c!=g_contrast){g_contrast=c;cs.switches++;}
+    g_contrastAt=now; g_contrastPt=at;
+}
+static void ContrastTick(int64_t now){
+    if(!g_rcfg.autoContrast||g_spotAnim||g_contrastSlow||now-g_contrastAt<CONTRAST_RESAMPLE_NS)return;
+    const int q=g_ov.size/4;
+    if(abs(g_cursor.x-g_contrastPt.x)<q&&abs(g_cursor.y-g_contrastPt.y)<q)return;
+    ContrastSample(g_cursor,now);
+}
+// The configured colours with the current contrast choice applied.
+static RingStyle FrameRingStyle(){
+    RingStyle st=CurrentRingStyle();
+    ContrastColors(g_contrast,st.ringColor,st.outlineColor);
+    return st;
+}
+
+// Spotlight falls back to the ring when the desktop-sized surface cannot be had.
+static void StartAnimation(POINT at){
+    g_spotAnim=g_rcfg.mode==LOCATE_SPOTLIGHT&&Spot_Ensure(g_spot,at);
+    if(!g_spotAnim){EnsureOverlaySurface(at); if(!g_ov.dc)return;}
+    g_cursor=at;g_animStart=at;
+    g_contrast=CC_CONFIG; g_contrastSlow=false;
+    if(g_rcfg.autoContrast&&!g_spotAnim)ContrastSample(at,g_clock.NowNs());
+    Pacer_Start(g_pacer,&g_paceClock,GetDuration());
+    Gov_Start(g_gov,g_pacer.startNs); g_pacer.divisor=Gov_Current(g_gov).divisor;
+    Predict_Reset(g_motion); Predict_Add(g_motion,g_pacer.startNs,(float)at.x,(float)at.y);
+    TraceRender(TR_START,g_pacer.startNs,at.x,at.y); TraceGov(g_pacer.startNs);
+    g_animating=true;g_stats.animations++;PublishStats();
+    if(g_spotAnim){
+        const RECT&d=g_spot.desk;
+        SetWindowPos(g_hwndSpot,HWND_TOPMOST,d.left,d.top,d.right-d.left,d.bottom-d.top,
+                     SWP_NOACTIVATE|SWP_SHOWWINDOW);
+    }else
+        SetWindowPos(g_hwndRing,HWND_TOPMOST,
+                     g_cursor.x-g_ov.size/2,g_cursor.y-g_ov.size/2,g_ov.size,g_ov.size,
+                     SWP_NOACTIVATE|SWP_SHOWWINDOW);
+    ArmFrameTimer(true);
+    PostMessageA(g_hwndOverlay,WM_BCF_ANIM,1,0);
+}
+// UI thread. Battery saver does not always broadcast, so the source is also checked on
+// every trigger; a change is published before the start command.
+static PowerSource PowerNow(){
+    SYSTEM_POWER_STATUS ps;
+    if(!GetSystemPowerStatus(&ps))return POWER_AC;
+    if(ps.SystemStatusFlag&1)return POWER_SAVER;
+    return ps.ACLineStatus==0?POWER_BATTERY:POWER_AC;
+}
+static void SyncPower(){PowerSource p=PowerNow();if(p!=g_power){g_power=p;PublishConfig();}}
+// Ctrl went down: a tap may follow, so the spotlight surface is built while it is held.
+static void OnCtrlDown(){if(g_cfg.mode==LOCATE_SPOTLIGHT)Render_Send(RC_WARM);}
+static void OnTap(TapAction a){
+    if(a==TAP_TRIGGER){SyncPower();POINT p;GetCursorPos(&p);Render_Send(RC_START,p.x,p.y);}
+    else if(a==TAP_CANCEL)Render_Send(RC_CANCEL);
+}
+static void CheckMoveCancel(POINT cur){
+    if(!g_animating||!g_rcfg.moveCancel)return;
+    if(MovedPastCancel(cur.x-g_animStart.x,cur.y-g_animStart.y))CancelAnimation(END_MOVE);
+}
+// Returns the frame's cost for the governor.
+static int64_t RecordFrame(float progress,int64_t t0,int64_t t1,int64_t t2,int64_t t3){
+    FrameSample fs;
+    fs.ns[PH_SETUP]=(uint32_t)(t1-t0); fs.ns[PH_RASTER]=(uint32_t)(t2-t1);
+    fs.ns[PH_PRESENT]=(uint32_t)(t3-t2); fs.ns[PH_TOTAL]=(uint32_t)(t3-t0);
+    Stats_Record(g_stats,fs);
+    if(Trace_On(g_trace)){
+        TraceEvent e; e.type=TR_FRAME; e.tNs=t3; e.x=g_cursor.x; e.y=g_cursor.y; e.progress=progress;
+        for(int i=0;i<PH_COUNT;i++)e.ns[i]=fs.ns[i];
+        Trace_Push(g_trace,g_trace.render,e);
+    }
+    return t3-t0;
+}
+static int64_t RenderSpotFrame(float progress)
+{
+    SpotFrame sf=SpotFrameAt(progress);
+    if(sf.done){EndAnimation(END_DONE);return 0;}
+
+    int64_t t0=g_clock.NowNs();
+    SpotCircle c;
+    c.cx=(float)(g_cursor.x-g_spot.desk.left)+0.5f; c.cy=(float)(g_cursor.y-g_spot.desk.top)+0.5f;
+    c.r=sf.r*g_spot.tiles.style.scale;
+    GdiFlush();
+    int64_t t1=g_clock.NowNs();
+    IRect dirty=Spot_Update(g_spot.tiles,g_spot.bits,g_spot.tiles.w,c);
+    int64_t t2=g_clock.NowNs();
+    Spot_Present(g_spot,dirty,(BYTE)lroundf(sf.fade*255.f));
+    int64_t t3=g_clock.NowNs();
+    return RecordFrame(progress,t0,t1,t2,t3);
+}
+// Draws one frame; returns its cost, or 0 when the animation ended instead.
+static int64_t RenderFrame(float progress)
+{
+    if(g_spotAnim)return RenderSpotFrame(progress);
+    RingFrame rf=RingFrameAt(progress);
+    if(rf.done){EndAnimation(END_DONE);return 0;}
+
+    const int sz=g_ov.size; const float c=sz/2.f, r=rf.r*OverlayScale();
+    int64_t t0=g_clock.NowNs();
+    uint32_t*px=Surf_Back(g_ov);
+    int64_t t1=g_clock.NowNs();
+    IRect box;
+    // The atlas holds the configured colours only; adapted ones are always drawn live.
+    const AtlasFrame*f=g_contrast==CC_CONFIG?AtlasLookup(g_atlas,r,rf.alpha):nullptr;
+    if(!f&&g_contrast==CC_CONFIG&&Gov_Current(g_gov).quality==GOV_REDUCED)f=AtlasLookupNear(g_atlas,r,rf.alpha);
+    if(f) box=AtlasBlit(g_atlas,*f,px,sz);
+    else{
+        RingStyle st=FrameRingStyle();
+        if(Gov_Current(g_gov).quality==GOV_REDUCED)st.glow=0;    // live frames drop the glow
+        box=RasterRing(px,sz,sz,sz,c,c,r,rf.alpha,st);
+    }
+    int64_t t2=g_clock.NowNs();
+    Surf_Present(g_ov,g_hwndRing,g_cursor,box);
+    int64_t t3=g_clock.NowNs();
+    return RecordFrame(progress,t0,t1,t2,t3);
+}
+static void StatsPath(char*path){
+    char dir[MAX_PATH]; GetTempPathA(MAX_PATH,dir);
+    sprintf(path,"%sBCF_frame_stats.txt",dir);
+}
+// Tray "Dump frame stats": the render thread writes the report to %TEMP%, the UI thread
+// opens it.
+static void WriteFrameStats(){
+    char path[MAX_PATH+32]; StatsPath(path);
+    FILE*f=fopen(path,"w"); if(!f)return;
+    Stats_Write(g_stats,f);
+    fprintf(f,"\natlas %d of %d keys%s, %u KB (animation needs ~%u KB)   overlay %dpx @%d dpi   upload ratio %.3f\n",
+            g_atlas.baked,g_atlas.keys,AtlasComplete(g_atlas)?"":" (over budget, drawn live)",
+            (unsigned)(g_atlas.bytes/1024),(unsigned)(g_atlas.needBytes/1024),g_ov.size,g_ov.dpi,
+            DamageUploadRatio(g_ov.damage));
+    SpotStats ss=g_spot.past; const SpotStats&cur=g_spot.tiles.stats;
+    ss.frames+=cur.frames; ss.rastered+=cur.rastered; ss.filled+=cur.filled;
+    ss.uploadBytes+=cur.uploadBytes; ss.fullBytes+=cur.fullBytes;
+    if(ss.frames)
+        fprintf(f,"spotlight %llu frames, %llu tiles rastered, %llu filled, upload %.1f MB of %.1f MB\n",
+                ss.frames,ss.rastered,ss.filled,ss.uploadBytes/1048576.0,ss.fullBytes/1048576.0);
+    if(g_spot.builds)
+        fprintf(f,"spotlight surface %s, %.1f MB while built, built %u times, freed %u (after %d s idle)\n",
+                g_spot.dc?"resident":"not resident",(double)g_spot.tiles.w*g_spot.tiles.h*4/1048576.0,
+                g_spot.builds,g_spot.frees,(int)(SPOT_KEEP_NS/1000000000));
+    const GovStats&gs=g_gov.stats; GovStep st=Gov_Current(g_gov);
+    fprintf(f,"governor %s, step %d (every %d vblank%s, %s quality), %llu of %llu frames reduced, "
+              "%llu down %llu up %llu resets, deepest step %d\n",
+            GovPowerName(g_gov.power),g_gov.level,st.divisor,st.divisor>1?"s":"",
+            st.quality==GOV_FULL?"full":"reduced",gs.reduced,gs.frames,gs.down,gs.up,gs.resets,gs.deepest);
+    const ContrastStats&cs=g_contrastStats;
+    if(cs.captures)
+        fprintf(f,"auto contrast %llu captures, %.1f us mean, %.1f us max, %llu over budget, %llu switches, %s now\n",
+                cs.captures,cs.totalNs/1e3/cs.captures,cs.maxNs/1e3,cs.slow,cs.switches,ContrastName(g_contrast));
+    if(g_trailFrames)
+        fprintf(f,"trail %llu frames, %.1f segments/frame, %.1f us/frame\n",g_trailFrames,
+                (double)g_trailSegsDrawn/g_trailFrames,g_trailNs/1e3/g_trailFrames);
+    fprintf(f,"render commands dropped %u   config v%u\n",g_chan.dropped.load(),g_rcfg.version);
+    fclose(f);
+    PostMessageA(g_hwndOverlay,WM_BCF_STATS,0,0);
+}
+// The ring is drawn where the pointer is predicted to be when the frame reaches the screen,
+// not where it was when the frame started. The tick is traced after what it drew, with both
+// cursor reads and the clock readings the pacer used.
+static void AnimTick(){
+    TraceEvent tk; tk.type=TR_TICK;
+    POINT cur;GetCursorPos(&cur);
+    tk.tNs=g_clock.NowNs(); tk.x=cur.x; tk.y=cur.y;
+    CheckMoveCancel(cur);
+    if(g_animating){
+        PaceFrame f=Pacer_Next(g_pacer);
+        tk.a=(uint8_t)(TICK_PACED|(g_paceClock.vblankOk?TICK_VBLANK:0));
+        tk.nowNs=g_paceClock.nowNs; tk.periodNs=g_paceClock.periodNs; tk.vblankNs=g_paceClock.vblankNs;
+        if(f.render){
+            GetCursorPos(&cur); int64_t t=g_clock.NowNs(); Predict_Add(g_motion,t,(float)cur.x,(float)cur.y);
+            tk.a|=TICK_DRAWN; tk.x2=cur.x; tk.y2=cur.y; tk.t2=t;
+            float px,py; Predict_At(g_motion,f.presentNs,g_rcfg.prediction/100.f,px,py);
+            g_cursor={(LONG)lroundf(px),(LONG)lroundf(py)};
+            ContrastTick(t);
+            if(int64_t cost=RenderFrame(f.progress)){
+                int64_t period=g_paceClock.vblankOk?g_paceClock.periodNs:g_pacer.fallbackNs;
+                Gov_Frame(g_gov,t,cost,g_pacer.stats.missed,period);
+                g_pacer.divisor=Gov_Current(g_gov).divisor;
+            }
+        }
+        if(g_animating)ArmFrameTimer(true,f.wakeNs);
+    }
+    Trace_Push(g_trace,g_trace.render,tk);
 }
-static void CancelAnimation(){if(!g_animating)return;g_animating=false;ClearAndHide();}
 
-static void StartAnimation(){
-    GetCursorPos(&g_cursor);g_animStart=g_cursor;
-    g_animating=true;g_startTime=GetTickCount();
-    SetWindowPos(g_hwndOverlay,HWND_TOPMOST,
-                 g_cursor.x-OV_SIZE/2,g_cursor.y-OV_SIZE/2,OV_SIZE,OV_SIZE,
-                 SWP_NOACTIVATE|SWP_SHOWWINDOW);
+//  TRAIL
+// Every pointer report lands in g_trail while trail mode is on; the tail is only shown once
+// the pointer moves faster than the style's minimum speed, then drawn once per refresh
+// period until its last segment has faded. It runs beside the locate animation, in its own
+// window, and is not traced.
+static TrailHistory g_trail;
+static TrailStyle   g_trailStyle;
+static TrailSegment g_trailSegs[TRAIL_CAP];
+static bool         g_trailOn = false;  // window up and ticking
+
+static void TrailHide(){
+    if(!g_trailOn)return;
+    g_trailOn=false; g_trailWakeNs=0; RearmFrameTimer();
+    ShowWindow(g_hwndTrail,SW_HIDE);
+    if(g_trailSurf.dc)TrailSurf_Clear(g_trailSurf);
+}
+static void TrailInput(int x,int y,int64_t tNs){
+    if(!g_rcfg.trail)return;
+    Trail_Add(g_trail,tNs,(float)x+0.5f,(float)y+0.5f);
+    if(g_trailOn)return;
+    g_trailStyle.color=g_rcfg.ringColor; g_trailStyle.scale=OverlayScale();
+    if(Trail_Speed(g_trail)<g_trailStyle.minSpeed*g_trailStyle.scale)return;
+    g_trailOn=true; g_trailWakeNs=g_clock.NowNs(); RearmFrameTimer();
+}
+// A flick across several screens is clipped to the TRAIL_MAX_PX square around the pointer.
+static void TrailTick(){
+    const int64_t now=g_clock.NowNs();
+    int n=Trail_Build(g_trail,now,g_trailStyle,g_trailSegs,TRAIL_CAP);
+    if(!n){TrailHide();return;}
+    IRect box=Trail_Bounds(g_trailSegs,n);
+    const int hx=(int)g_trailSegs[0].x0, hy=(int)g_trailSegs[0].y0, half=TRAIL_MAX_PX/2;
+    box.x0=std::max(box.x0,hx-half); box.x1=std::min(box.x1,hx+half);
+    box.y0=std::max(box.y0,hy-half); box.y1=std::min(box.y1,hy+half);
+    TrailSurface&s=g_trailSurf;
+    if(!TrailSurf_Ensure(s,box.x1-box.x0,box.y1-box.y0)){TrailHide();return;}
+    TrailSurf_Clear(s);
+    s.drawn=RasterCapsules(s.bits,box.x1-box.x0,box.y1-box.y0,s.w,(float)box.x0,(float)box.y0,
+                           g_trailSegs,n,g_trailStyle.color);
+    TrailSurf_Present(s,box);
+    if(!IsWindowVisible(g_hwndTrail))
+        SetWindowPos(g_hwndTrail,HWND_TOPMOST,0,0,0,0,SWP_NOMOVE|SWP_NOSIZE|SWP_NOACTIVATE|SWP_SHOWWINDOW);
+    g_trailFrames++; g_trailSegsDrawn+=(uint64_t)n; g_trailNs+=(uint64_t)(g_clock.NowNs()-now);
+    g_trailWakeNs=now+(g_paceClock.vblankOk?g_paceClock.periodNs:g_pacer.fallbackNs);
+    RearmFrameTimer();
+}
+// A wake can come early for one of the two clients; each only runs once its own time is due.
+static void OnFrameTimer(){
+    const int64_t now=g_clock.NowNs()+TIMER_SLACK_NS;
+    const bool anim=g_animating&&(!g_frameTimer||now>=g_animWakeNs);
+    const bool trail=g_trailOn&&(!g_frameTimer||now>=g_trailWakeNs);
+    if(anim)AnimTick();
+    if(trail)TrailTick();
+    if(!anim&&!trail)RearmFrameTimer();
+}
+
+//  RENDER THREAD
+// Builds and sends the spotlight surface at alpha 0 so a tap can start on it, and restarts
+// the idle countdown.
+static void SpotWarm(){
+    if(g_rcfg.mode!=LOCATE_SPOTLIGHT||g_animating)return;
+    if(Spot_Ensure(g_spot,CursorPos())&&!g_spot.uploaded)Spot_Present(g_spot,IRect(),0);
+    g_spotFreeAt=0;
+}
+// Drops the surface and shrinks the window so the copy it holds goes too.
+static void SpotFree(){
+    if(!g_spot.dc)return;
+    Spot_Destroy(g_spot); g_spotFreeAt=0;
+    SetWindowPos(g_hwndSpot,NULL,0,0,1,1,SWP_NOZORDER|SWP_NOMOVE|SWP_NOACTIVATE);
 }
-static bool AnyNewKeyPressed(){
-    for(int vk=1;vk<256;vk++){
-        if(vk==VK_CONTROL||vk==VK_LCONTROL||vk==VK_RCONTROL)continue;
-        if(g_preExisting[vk])continue;
-        if(GetAsyncKeyState(vk)&0x8000)return true;
+// Takes the newest config snapshot, once per wake before the commands: RC_CONFIG only wakes
+// the thread and can be dropped by a full queue, the snapshot cannot.
+static void ApplyConfig(){
+    if(!g_chan.config.Acquire())return;
+    g_rcfg=g_chan.config.Front();RebuildAtlas();
+    Gov_SetPower(g_gov,(PowerSource)g_rcfg.power); g_pacer.divisor=Gov_Current(g_gov).divisor;
+    if(g_rcfg.mode!=LOCATE_SPOTLIGHT&&!g_animating)SpotFree();
+    if(!g_rcfg.trail){TrailHide();Trail_Clear(g_trail);TrailSurf_Destroy(g_trailSurf);}
+    if(!g_rcfg.autoContrast){g_contrast=CC_CONFIG;Cap_Destroy(g_cap);}
+    TraceConfig();
+}
+// Applies one command; false on RC_QUIT.
+static bool Render_Command(const RenderCmd&c){
+    switch(c.type){
+    case RC_START:  StartAnimation(POINT{c.x,c.y}); break;
+    case RC_CANCEL: TraceRender(TR_CANCEL,g_clock.NowNs()); CancelAnimation(END_KEY); break;
+    case RC_CURSOR:
+        TraceRender(TR_MOVE,c.tNs,c.x,c.y);
+        if(g_animating)Predict_Add(g_motion,c.tNs,(float)c.x,(float)c.y);
+        CheckMoveCancel(POINT{c.x,c.y});
+        TrailInput(c.x,c.y,c.tNs);
+        break;
+    case RC_TRAIL:  TrailInput(c.x,c.y,c.tNs); break;
+    case RC_DUMP:   WriteFrameStats(); break;
+    case RC_WARM:   SpotWarm(); break;
+    case RC_CONFIG: break;          // ApplyConfig already ran for this wake
+    case RC_QUIT:   return false;
     }
-    return false;
+    return true;
 }
-static void CheckCancel(){
-    if(!g_animating)return;
-    if(g_cfg.moveCancel){
-        POINT cur;GetCursorPos(&cur);
-        int dx=cur.x-g_animStart.x,dy=cur.y-g_animStart.y;
-        if(dx*dx+dy*dy>MOVE_THR*MOVE_THR){CancelAnimation();return;}
+// The ring window gets the display broadcasts itself, so surface rebuilds stay on this thread.
+static LRESULT CALLBACK RingWndProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam){
+    switch(msg){
+    case WM_DISPLAYCHANGE:
+    case WM_SETTINGCHANGE:
+    case WM_DPICHANGED:g_ovDpiDirty=true;g_spotDirty=true;break;
     }
-    if(AnyNewKeyPressed())CancelAnimation();
+    return DefWindowProc(hwnd,msg,wParam,lParam);
 }
-static void RenderFrame(float progress)
+// Frees the spotlight surface once it has sat idle for SPOT_KEEP_NS; returns the ms until
+// that is due, INFINITE when unarmed.
+static DWORD SpotIdle(){
+    if(!g_spot.dc||g_spotAnim){g_spotFreeAt=0;return INFINITE;}
+    const int64_t now=g_clock.NowNs();
+    if(!g_spotFreeAt)g_spotFreeAt=now+SPOT_KEEP_NS;
+    if(now<g_spotFreeAt)return (DWORD)((g_spotFreeAt-now)/1000000+1);
+    SpotFree();
+    OutputDebugStringA("BCF: spotlight surface freed while idle\n");
+    return INFINITE;
+}
+static DWORD WINAPI RenderThreadProc(LPVOID param)
 {
-    float r=ANIM_MAX_R*(1.f-EaseOutQuint(progress));
-    if(r<ANIM_MIN_R){g_animating=false;ClearAndHide();return;}
-    float alpha;
-    if(progress<0.06f)alpha=progress/0.06f;
-    else if(progress<0.72f)alpha=1.f;
-    else alpha=1.f-(progress-0.72f)/0.28f;
-    alpha=Clamp01(alpha);
-
-    BYTE rR=GetRValue(g_cfg.ringColor),rG=GetGValue(g_cfg.ringColor),rB=GetBValue(g_cfg.ringColor);
-    BYTE oR=GetRValue(g_cfg.outlineColor),oG=GetGValue(g_cfg.outlineColor),oB=GetBValue(g_cfg.outlineColor);
-
-    HDC hdcS=GetDC(NULL);HDC hdcM=CreateCompatibleDC(hdcS);
-    BITMAPINFO bmi={};bmi.bmiHeader.biSize=sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth=OV_SIZE;bmi.bmiHeader.biHeight=-OV_SIZE;
-    bmi.bmiHeader.biPlanes=1;bmi.bmiHeader.biBitCount=32;bmi.bmiHeader.biCompression=BI_RGB;
-    void*pv=nullptr;HBITMAP hb=CreateDIBSection(hdcM,&bmi,DIB_RGB_COLORS,&pv,NULL,0);
-    HBITMAP ho=(HBITMAP)SelectObject(hdcM,hb);
-    memset(pv,0,OV_SIZE*OV_SIZE*4);
-    {
-        Graphics gfx(hdcM);gfx.SetSmoothingMode(SmoothingModeAntiAlias);
-        gfx.SetPixelOffsetMode(PixelOffsetModeHighQuality);
-        float cx=OV_SIZE/2.f,cy=OV_SIZE/2.f;
-        {Pen p(Color((BYTE)(alpha*14),rR,rG,rB),18.f);gfx.DrawEllipse(&p,cx-r,cy-r,r*2,r*2);}
-        {Pen p(Color((BYTE)(alpha*36),rR,rG,rB), 9.f);gfx.DrawEllipse(&p,cx-r,cy-r,r*2,r*2);}
-        {Pen p(Color((BYTE)(alpha*78),rR,rG,rB),4.5f);gfx.DrawEllipse(&p,cx-r,cy-r,r*2,r*2);}
-        {Pen p(Color((BYTE)(alpha*210),oR,oG,oB),STROKE_W+3.f);gfx.DrawEllipse(&p,cx-r,cy-r,r*2,r*2);}
-        {Pen p(Color((BYTE)(alpha*228),rR,rG,rB),STROKE_W);gfx.DrawEllipse(&p,cx-r,cy-r,r*2,r*2);}
-        float ir=r-(STROKE_W+2.2f);
-        if(ir>1.f){Pen p(Color((BYTE)(alpha*210),oR,oG,oB),STROKE_W+2.f);gfx.DrawEllipse(&p,cx-ir,cy-ir,ir*2,ir*2);}
-    }
-    POINT ptS={0,0};SIZE szW={OV_SIZE,OV_SIZE};
-    POINT ptD={g_cursor.x-OV_SIZE/2,g_cursor.y-OV_SIZE/2};
-    BLENDFUNCTION bf={};bf.BlendOp=AC_SRC_OVER;bf.SourceConstantAlpha=255;bf.AlphaFormat=AC_SRC_ALPHA;
-    UpdateLayeredWindow(g_hwndOverlay,hdcS,&ptD,&szW,hdcM,&ptS,0,&bf,ULW_ALPHA);
-    SelectObject(hdcM,ho);DeleteObject(hb);DeleteDC(hdcM);ReleaseDC(NULL,hdcS);
+    HINSTANCE hInst=(HINSTANCE)param;
+    SetThreadPriority(GetCurrentThread(),THREAD_PRIORITY_ABOVE_NORMAL);
+    WNDCLASSEXA wc={};wc.cbSize=sizeof(wc);wc.lpfnWndProc=RingWndProc;
+    wc.hInstance=hInst;wc.lpszClassName="CF_Ring";RegisterClassExA(&wc);
+    g_hwndRing=CreateWindowExA(
+        WS_EX_LAYERED|WS_EX_TRANSPARENT|WS_EX_TOPMOST|WS_EX_TOOLWINDOW|WS_EX_NOACTIVATE,
+        "CF_Ring","",WS_POPUP,0,0,OV_SIZE,OV_SIZE,NULL,NULL,hInst,NULL);
+    g_hwndSpot=CreateWindowExA(
+        WS_EX_LAYERED|WS_EX_TRANSPARENT|WS_EX_TOPMOST|WS_EX_TOOLWINDOW|WS_EX_NOACTIVATE,
+        "CF_Ring","",WS_POPUP,0,0,1,1,NULL,NULL,hInst,NULL);
+    g_hwndTrail=CreateWindowExA(
+        WS_EX_LAYERED|WS_EX_TRANSPARENT|WS_EX_TOPMOST|WS_EX_TOOLWINDOW|WS_EX_NOACTIVATE,
+        "CF_Ring","",WS_POPUP,0,0,1,1,NULL,NULL,hInst,NULL);
+    g_frameTimer=CreateWaitableTimerExW(NULL,NULL,CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,TIMER_ALL_ACCESS);
+    if(!g_frameTimer)g_frameTimer=CreateWaitableTimerW(NULL,FALSE,NULL);
+    if(g_chan.config.Acquire())g_rcfg=g_chan.config.Front();
+    EnsureOverlaySurface(CursorPos());
+
+    // Wakes on a command, the frame timer or a message for the ring window; without a
+    // waitable timer it falls back to ticking every FRAME_MS while animating or trailing.
+    HANDLE h[2]={g_renderWake,g_frameTimer};
+    const DWORD n=g_frameTimer?2:1;
+    bool running=true;
+    MSG msg;
+    while(running){
+        const bool ticking=!g_frameTimer&&(g_animating||g_trailOn);
+        const DWORD idle=SpotIdle();
+        DWORD wait=MsgWaitForMultipleObjectsEx(n,h,ticking?FRAME_MS:idle,QS_ALLINPUT,MWMO_INPUTAVAILABLE);
+        while(PeekMessageA(&msg,NULL,0,0,PM_REMOVE))DispatchMessageA(&msg);
+        ApplyConfig();
+        RenderCmd c;
+        while(running&&g_chan.cmds.Pop(c))running=Render_Command(c);
+        if(running&&((ticking&&wait==WAIT_TIMEOUT)||(g_frameTimer&&wait==WAIT_OBJECT_0+1)))OnFrameTimer();
+    }
+    if(g_animating)EndAnimation(END_QUIT);
+    Surf_Destroy(g_ov);
+    Spot_Destroy(g_spot);
+    TrailSurf_Destroy(g_trailSurf);
+    Cap_Destroy(g_cap);
+    DestroyWindow(g_hwndRing);
+    DestroyWindow(g_hwndSpot);
+    DestroyWindow(g_hwndTrail);
+    if(g_frameTimer)CloseHandle(g_frameTimer);
+    return 0;
+}
+
+//  INPUT
+// Ctrl-tap steps, traced with the input, the animating flag they saw and their outcome.
+static TapAction TapKey(int vk,bool down){
+    bool anim=g_animating;
+    TapAction a=Tap_Key(g_tap,vk,down,anim);
+    if(Trace_On(g_trace)){
+        TraceEvent e; e.type=TR_KEY; e.tNs=g_clock.NowNs(); e.a=(uint8_t)vk; e.b=down; e.c=anim; e.d=(uint8_t)a;
+        Trace_Push(g_trace,g_trace.ui,e);
+    }
+    return a;
+}
+// Identical idle ticks leave the detector as it was, so only changes and actions are traced.
+static TapAction TapPoll(const KeyBits&held){
+    static KeyBits lastHeld; static bool lastAnim=false;
+    bool anim=g_animating;
+    TapAction a=Tap_Poll(g_tap,held,anim);
+    if(Trace_On(g_trace)&&(a!=TAP_NONE||anim!=lastAnim||memcmp(&held,&lastHeld,sizeof(held)))){
+        TraceEvent e; e.type=TR_POLL; e.tNs=g_clock.NowNs(); e.keys=held; e.c=anim; e.d=(uint8_t)a;
+        Trace_Push(g_trace,g_trace.ui,e);
+    }
+    lastHeld=held; lastAnim=anim;
+    return a;
+}
+// Tray "Record input trace": starts with the detector's state and the render config so a
+// replay can begin mid-session; stopping shows the file in Explorer.
+static void ToggleTrace(){
+    if(g_trace.file){
+        KillTimer(g_hwndOverlay,TRACE_TIMER);
+        Trace_End(g_trace); SyncRawMouse();
+        char args[MAX_PATH+64]; sprintf(args,"/select,\"%s\"",g_tracePath);
+        ShellExecuteA(NULL,"open","explorer.exe",args,NULL,SW_SHOWNORMAL);
+        return;
+    }
+    char dir[MAX_PATH]; GetTempPathA(MAX_PATH,dir);
+    SYSTEMTIME st; GetLocalTime(&st);
+    sprintf(g_tracePath,"%sBCF_trace_%04d%02d%02d_%02d%02d%02d.bcft",dir,
+            st.wYear,st.wMonth,st.wDay,st.wHour,st.wMinute,st.wSecond);
+    if(!Trace_Begin(g_trace,fopen(g_tracePath,"wb")))return;
+    TraceEvent e; e.type=TR_TAP; e.tNs=g_clock.NowNs();
+    e.keys=g_tap.down; e.known=g_tap.known; e.a=g_tap.ctrlWas; e.b=g_tap.comboDetected;
+    Trace_Push(g_trace,g_trace.ui,e);
+    PublishConfig();
+    SetTimer(g_hwndOverlay,TRACE_TIMER,TRACE_DRAIN_MS,NULL);
+    SyncRawMouse();
+}
+
+//  IPC
+// Commands from other processes arrive on a named pipe. Each connection is served on its
+// own thread with overlapped I/O that the stop event aborts, and each request is sent to
+// the UI thread, so it runs exactly like a tray or Ctrl-tap action and the render thread
+// never waits on a client. The pipe is per session, like the single-instance mutex.
+static const DWORD IPC_CONNECT_MS = 1000;
+struct IpcCall { const IpcMessage*q; IpcMessage*r; };
+
+static void PipeName(char*out,size_t n){
+    DWORD sid=0; ProcessIdToSessionId(GetCurrentProcessId(),&sid);
+    snprintf(out,n,"\\\\.\\pipe\\BCF_v2_%lu",(unsigned long)sid);
+}
+// Waits for overlapped I/O on `ov`; false when it failed or `stop` was set first.
+static bool PipeWait(HANDLE pipe,OVERLAPPED&ov,HANDLE stop,DWORD&got){
+    HANDLE h[2]={ov.hEvent,stop};
+    if(WaitForMultipleObjects(2,h,FALSE,INFINITE)!=WAIT_OBJECT_0){
+        CancelIo(pipe); GetOverlappedResult(pipe,&ov,&got,TRUE); return false;
+    }
+    return GetOverlappedResult(pipe,&ov,&got,FALSE)!=FALSE;
+}
+struct PipeConn : IpcConn {
+    HANDLE pipe, ev, stop;
+    PipeConn(HANDLE p,HANDLE s):pipe(p),ev(CreateEventA(NULL,TRUE,FALSE,NULL)),stop(s){}
+    ~PipeConn() override {DisconnectNamedPipe(pipe);CloseHandle(pipe);if(ev)CloseHandle(ev);}
+    bool Io(bool rd,uint8_t*b,size_t n){
+        while(n){
+            OVERLAPPED ov={}; ov.hEvent=ev; DWORD got=0;
+            BOOL done=rd?ReadFile(pipe,b,(DWORD)n,NULL,&ov):WriteFile(pipe,b,(DWORD)n,NULL,&ov);
+            if(!done&&GetLastError()!=ERROR_IO_PENDING)return false;
+            if(!PipeWait(pipe,ov,stop,got)||!got)return false;
+            b+=got; n-=got;
+        }
+        return true;
+    }
+    bool Read(void*p,size_t n) override {return Io(true,(uint8_t*)p,n);}
+    bool Write(const void*p,size_t n) override {return Io(false,(uint8_t*)p,n);}
+};
+struct PipeListener : IpcListener {
+    char   name[64] = {};
+    HANDLE stop = nullptr;
+    bool   first = true;    // the first instance must be ours, not one another process made
+    const char* Name() override {return "pipe";}
+    // A client that gives up before it is connected is skipped; only stop ends the loop.
+    IpcConn* Accept() override {
+        while(WaitForSingleObject(stop,0)==WAIT_TIMEOUT){
+            HANDLE p=CreateNamedPipeA(name,PIPE_ACCESS_DUPLEX|FILE_FLAG_OVERLAPPED|(first?FILE_FLAG_FIRST_PIPE_INSTANCE:0),
+                                      PIPE_TYPE_BYTE|PIPE_READMODE_BYTE|PIPE_WAIT|PIPE_REJECT_REMOTE_CLIENTS,
+                                      IPC_MAX_CONNS+1,256,256,0,NULL);
+            if(p==INVALID_HANDLE_VALUE){if(first)return nullptr;WaitForSingleObject(stop,50);continue;}
+            first=false;
+            PipeConn*c=new PipeConn(p,stop);
+            OVERLAPPED ov={}; ov.hEvent=c->ev; DWORD got=0;
+            if(c->ev&&(ConnectNamedPipe(p,&ov)||GetLastError()==ERROR_PIPE_CONNECTED||
+                       (GetLastError()==ERROR_IO_PENDING&&PipeWait(p,ov,stop,got))))return c;
+            delete c;
+        }
+        return nullptr;
+    }
+    void Stop() override {SetEvent(stop);}
+};
+// Client side, for a second launch: plain blocking I/O.
+struct HandleConn : IpcConn {
+    HANDLE h;
+    explicit HandleConn(HANDLE x):h(x){}
+    ~HandleConn() override {CloseHandle(h);}
+    bool Read(void*p,size_t n) override {
+        for(uint8_t*b=(uint8_t*)p;n;){DWORD got=0;if(!ReadFile(h,b,(DWORD)n,&got,NULL)||!got)return false;b+=got;n-=got;}
+        return true;
+    }
+    bool Write(const void*p,size_t n) override {DWORD put=0;return WriteFile(h,p,(DWORD)n,&put,NULL)&&put==n;}
+};
+static PipeListener g_pipe;
+static IpcServer    g_ipc;
+static WPARAM       g_ipcCookie = 0;    // WM_BCF_IPC from any other sender is ignored
+
+// IPC thread: blocks until the UI thread has run the command. Ipc_Stop is only called once
+// no thread is left waiting here (see the quit path), so this never deadlocks.
+static void IpcHandle(void*,const IpcMessage&q,IpcMessage&r){
+    IpcCall call={&q,&r};
+    SendMessageA(g_hwndOverlay,WM_BCF_IPC,g_ipcCookie,(LPARAM)&call);
+}
+static void OnIpc(const IpcMessage&q,IpcMessage&r){
+    switch(q.op){
+    case IPC_START: OnTap(TAP_TRIGGER); break;
+    case IPC_CANCEL:OnTap(TAP_CANCEL); break;
+    case IPC_SET_COLOR:{
+        uint32_t ring,outline;
+        if(!Ipc_GetColor(q,ring,outline)){r.op=IPC_BAD_ARGS;break;}
+        g_cfg.ringColor=ring; g_cfg.outlineColor=outline; SaveSettings();
+        SW_InvalidateCtl(g_rcRing); SW_InvalidateCtl(g_rcOutline);
+        break;}
+    case IPC_GET_STATS:{
+        IpcStats s;
+        s.animating=g_animating; s.mode=(uint8_t)g_cfg.mode;
+        s.ringColor=g_cfg.ringColor; s.outlineColor=g_cfg.outlineColor;
+        g_statsPub.Acquire();
+        const StatsCounters&c=g_statsPub.Front();
+        s.animations=c.animations; s.cancelled=c.cancelled; s.missed=c.missed;
+        s.requests=g_ipc.requests;
+        Ipc_PutStats(r,s);
+        break;}
+    }
+}
+// A second launch with arguments hands its command to the running instance instead of
+// exiting silently; the exit code is 0 on success and --stats prints to the console it
+// was started from. The first instance may still be starting, so a missing pipe is retried.
+static int ForwardCommand(const char*args){
+    IpcMessage q, r;
+    if(!args||!*args)return 0;
+    const bool parsed=Ipc_ParseArgs(args,q);
+    if(AttachConsole(ATTACH_PARENT_PROCESS)){freopen("CONOUT$","w",stdout);freopen("CONOUT$","w",stderr);}
+    if(!parsed){fprintf(stderr,"usage: BetterCursorFinder [--start | --cancel | --ping | --stats | --color RRGGBB [RRGGBB]]\n");return 2;}
+    char name[64]; PipeName(name,sizeof(name));
+    HANDLE h=INVALID_HANDLE_VALUE;
+    for(int tries=0;tries<20;tries++){
+        h=CreateFileA(name,GENERIC_READ|GENERIC_WRITE,0,NULL,OPEN_EXISTING,0,NULL);
+        if(h!=INVALID_HANDLE_VALUE)break;
+        DWORD e=GetLastError();
+        if(e==ERROR_PIPE_BUSY){if(!WaitNamedPipeA(name,IPC_CONNECT_MS))break;}
+        else if(e==ERROR_FILE_NOT_FOUND)Sleep(50);
+        else break;
+    }
+    if(h==INVALID_HANDLE_VALUE){fprintf(stderr,"BCF is running but not accepting commands\n");return 1;}
+    HandleConn c(h);
+    if(!Ipc_Call(c,q,r)){fprintf(stderr,"BCF did not reply\n");return 1;}
+    if(r.op!=IPC_OK){fprintf(stderr,"BCF: %s\n",IpcStatusName(r.op));return 1;}
+    IpcStats s;
+    auto rgb=[](uint32_t c){return (c&0xFF)<<16|(c&0xFF00)|(c>>16&0xFF);};
+    if(q.op==IPC_GET_STATS&&Ipc_GetStats(r,s))
+        printf("animating=%u mode=%u ring=%06X outline=%06X animations=%llu cancelled=%llu missed=%llu requests=%llu\n",
+               s.animating,s.mode,rgb(s.ringColor),rgb(s.outlineColor),(unsigned long long)s.animations,
+               (unsigned long long)s.cancelled,(unsigned long long)s.missed,(unsigned long long)s.requests);
+    return 0;
+}
+
+// Low-level keyboard hook: feeds every transition to the Ctrl-tap state machine and posts
+// the outcome back to the overlay window so the hook itself returns immediately.
+static LRESULT CALLBACK KeyboardHookProc(int code,WPARAM wParam,LPARAM lParam){
+    if(code==HC_ACTION){
+        const KBDLLHOOKSTRUCT*k=(const KBDLLHOOKSTRUCT*)lParam;
+        bool down=(wParam==WM_KEYDOWN||wParam==WM_SYSKEYDOWN), ctrlWas=g_tap.ctrlWas;
+        TapAction a=TapKey((int)k->vkCode,down);
+        if(a!=TAP_NONE||g_tap.ctrlWas!=ctrlWas)
+            PostMessageA(g_hwndOverlay,WM_BCF_TAP,(WPARAM)a,g_tap.ctrlWas&&!ctrlWas);
+    }
+    return CallNextHookEx(NULL,code,wParam,lParam);
+}
+// Polling fallback: one pass over the async key state packed into a bitset, shared by the
+// combo and cancel checks. Skipped entirely (one call) while Ctrl is up and nothing animates.
+static KeyBits SnapshotKeys(){
+    KeyBits k;
+    if(!(GetAsyncKeyState(VK_CONTROL)&0x8000)&&!g_tap.ctrlWas&&!g_animating)return k;
+    for(int vk=1;vk<256;vk++) if(GetAsyncKeyState(vk)&0x8000)KeyBits_Set(k,vk,true);
+    return k;
+}
+static void OnRawMouse(HRAWINPUT h){
+    RAWINPUT ri; UINT sz=sizeof(ri);
+    if(GetRawInputData(h,RID_INPUT,&ri,&sz,sizeof(RAWINPUTHEADER))==(UINT)-1||ri.header.dwType!=RIM_TYPEMOUSE)return;
+    static const struct{USHORT dn,up;int vk;} btn[]={
+        {RI_MOUSE_LEFT_BUTTON_DOWN,  RI_MOUSE_LEFT_BUTTON_UP,  VK_LBUTTON},
+        {RI_MOUSE_RIGHT_BUTTON_DOWN, RI_MOUSE_RIGHT_BUTTON_UP, VK_RBUTTON},
+        {RI_MOUSE_MIDDLE_BUTTON_DOWN,RI_MOUSE_MIDDLE_BUTTON_UP,VK_MBUTTON},
+        {RI_MOUSE_BUTTON_4_DOWN,     RI_MOUSE_BUTTON_4_UP,     VK_XBUTTON1},
+        {RI_MOUSE_BUTTON_5_DOWN,     RI_MOUSE_BUTTON_5_UP,     VK_XBUTTON2}};
+    // Motion while the ring is up goes straight to the render thread, timestamped for the
+    // predictor and for the move-cancel check, and in trail mode always; the size guard
+    // keeps a 1 kHz mouse from crowding out start / cancel. A shake starts the ring.
+    if(ri.data.mouse.lLastX||ri.data.mouse.lLastY){
+        POINT p;GetCursorPos(&p);const int64_t t=g_clock.NowNs();
+        if(Trace_On(g_trace)){
+            TraceEvent e; e.type=TR_POINTER; e.tNs=t; e.x=p.x; e.y=p.y;
+            Trace_Push(g_trace,g_trace.ui,e);
+        }
+        if((g_animating||g_cfg.trail)&&g_chan.cmds.Size()<32)Render_Send(g_animating?RC_CURSOR:RC_TRAIL,p.x,p.y,t);
+        if(g_cfg.shake&&Shake_Add(g_shake,t,(float)p.x,(float)p.y)&&!g_animating)OnTap(TAP_TRIGGER);
+    }
+    // Without the hook the polling fallback already sees the buttons.
+    USHORT f=ri.data.mouse.usButtonFlags;
+    if(g_kbHook)for(const auto&b:btn){
+        if(f&b.dn)OnTap(TapKey(b.vk,true));
+        if(f&b.up)OnTap(TapKey(b.vk,false));
+    }
+    SyncRawMouse();
 }
 
 //  SETTINGS
 static void ShowSettings(){
-    if(!g_hwndSettings)return;
+    if(!g_hwndSettings||!Gdip_Ensure())return;
     if(g_settingsOpen){
         
         if(IsIconic(g_hwndSettings)) ShowWindow(g_hwndSettings,SW_RESTORE);
@@ -815,33 +2141,79 @@ LRESULT CALLBACK OverlayWndProc(HWND hwnd,UINT msg,WPARAM wParam,LPARAM lParam)
     switch(msg){
     case WM_TRAY:
         if(lParam==WM_LBUTTONUP){ShowSettings();return 0;}
+        // Hovering the icon is the first hint the settings window may open: warm it then.
+        if(lParam==WM_MOUSEMOVE&&!g_gdipToken){PostMessageA(g_hwndSettings,WM_BCF_PREWARM,0,0);return 0;}
         if(lParam==WM_RBUTTONUP){
             POINT pt;GetCursorPos(&pt);SetForegroundWindow(hwnd);
             HMENU menu=CreatePopupMenu();
             AppendMenuA(menu,MF_STRING,1,"BCF Settings");
+            HMENU pred=CreatePopupMenu();
+            // No Full: at 125 Hz it is no better than Off (bcf_predict_eval); BCF.ini still takes 100.
+            static const struct{int pct;const char*name;} levels[]={{0,"Off"},{50,"Half"},{75,"Strong"}};
+            for(int i=0;i<3;i++)
+                AppendMenuA(pred,MF_STRING|(g_cfg.prediction==levels[i].pct?MF_CHECKED:0),10+i,levels[i].name);
+            AppendMenuA(menu,MF_POPUP,(UINT_PTR)pred,"Cursor prediction");
+            HMENU mode=CreatePopupMenu();
+            AppendMenuA(mode,MF_STRING|(g_cfg.mode==LOCATE_RING?MF_CHECKED:0),20,"Ring");
+            AppendMenuA(mode,MF_STRING|(g_cfg.mode==LOCATE_SPOTLIGHT?MF_CHECKED:0),21,"Spotlight");
+            AppendMenuA(menu,MF_POPUP,(UINT_PTR)mode,"Locate mode");
+            HMENU glow=CreatePopupMenu();
+            static const struct{int v;const char*name;} radii[]={{0,"Off"},{5,"Tight"},{9,"Normal"},{16,"Wide"}},
+                                                        strengths[]={{25,"Faint"},{45,"Medium"},{80,"Strong"}};
+            for(int i=0;i<4;i++)
+                AppendMenuA(glow,MF_STRING|(g_cfg.glowRadius==radii[i].v?MF_CHECKED:0),30+i,radii[i].name);
+            AppendMenuA(glow,MF_SEPARATOR,0,NULL);
+            for(int i=0;i<3;i++)
+                AppendMenuA(glow,MF_STRING|(g_cfg.glowStrength==strengths[i].v?MF_CHECKED:0)|(g_cfg.glowRadius?0:MF_GRAYED),
+                            34+i,strengths[i].name);
+            AppendMenuA(menu,MF_POPUP,(UINT_PTR)glow,"Glow");
+            AppendMenuA(menu,MF_STRING|(g_cfg.trail?MF_CHECKED:0),5,"Cursor trail");
+            AppendMenuA(menu,MF_STRING|(g_cfg.autoContrast?MF_CHECKED:0),6,"Auto contrast");
+            AppendMenuA(menu,MF_STRING|(g_cfg.shake?MF_CHECKED:0),7,"Shake to find");
+            AppendMenuA(menu,MF_STRING,3,"Dump frame stats");
+            AppendMenuA(menu,MF_STRING|(g_trace.file?MF_CHECKED:0),4,"Record input trace");
             AppendMenuA(menu,MF_SEPARATOR,0,NULL);
             AppendMenuA(menu,MF_STRING,2,"Shutdown BCF");
             int cmd=TrackPopupMenu(menu,TPM_RETURNCMD|TPM_NONOTIFY,pt.x,pt.y,0,hwnd,NULL);
             DestroyMenu(menu);
             if(cmd==1)ShowSettings();
             if(cmd==2)PostQuitMessage(0);
+            if(cmd==3)Render_Send(RC_DUMP);
+            if(cmd==4)ToggleTrace();
+            if(cmd>=10&&cmd<=12){g_cfg.prediction=levels[cmd-10].pct;SaveSettings();}
+            if(cmd==5){g_cfg.trail=!g_cfg.trail;SaveSettings();SyncRawMouse();}
+            if(cmd==6){g_cfg.autoContrast=!g_cfg.autoContrast;SaveSettings();}
+            if(cmd==7){g_cfg.shake=!g_cfg.shake;Shake_Reset(g_shake);SaveSettings();SyncRawMouse();}
+            if(cmd>=20&&cmd<=21){g_cfg.mode=cmd-20;SaveSettings();}
+            if(cmd>=30&&cmd<=33){g_cfg.glowRadius=radii[cmd-30].v;SaveSettings();}
+            if(cmd>=34&&cmd<=36){g_cfg.glowStrength=strengths[cmd-34].v;SaveSettings();}
             return 0;
         }
         return 0;
+    case WM_BCF_TAP:if(lParam)OnCtrlDown();OnTap((TapAction)wParam);SyncRawMouse();return 0;
+    case WM_BCF_ANIM:SyncRawMouse();return 0;
+    case WM_BCF_IPC:if(g_ipcCookie&&wParam==g_ipcCookie){const IpcCall&c=*(const IpcCall*)lParam;OnIpc(*c.q,*c.r);}return 0;
+    case WM_BCF_STATS:{
+        char path[MAX_PATH+32];StatsPath(path);
+        if(FILE*f=fopen(path,"a")){WriteStartupStats(f);fclose(f);}
+        ShellExecuteA(NULL,"open",path,NULL,NULL,SW_SHOWNORMAL);return 0;}
+    case WM_INPUT:OnRawMouse((HRAWINPUT)lParam);break;
+    case WM_TIMER:if(wParam==TRACE_TIMER)Trace_Drain(g_trace);return 0;
+    case WM_POWERBROADCAST:if(wParam==PBT_APMPOWERSTATUSCHANGE)SyncPower();return TRUE;
+    case WM_ENDSESSION:if(wParam)Store_Flush(g_store);return 0;
     case WM_DESTROY:PostQuitMessage(0);return 0;
     }
     return DefWindowProc(hwnd,msg,wParam,lParam);
 }
 
 //  ENTRY POINT
-int WINAPI WinMain(HINSTANCE hInst,HINSTANCE,LPSTR,int)
+int WINAPI WinMain(HINSTANCE hInst,HINSTANCE,LPSTR cmdLine,int)
 {
+    DeclareDpiAwareness();
     HANDLE hMutex=CreateMutexA(NULL,TRUE,"BCF_v2_Mutex");
-    if(GetLastError()==ERROR_ALREADY_EXISTS){CloseHandle(hMutex);return 0;}
+    if(GetLastError()==ERROR_ALREADY_EXISTS){int rc=ForwardCommand(cmdLine);CloseHandle(hMutex);return rc;}
 
     LoadSettings();
-    GdiplusStartupInput gi;ULONG_PTR token;GdiplusStartup(&token,&gi,NULL);
-
     g_hBCFIcon=CreateBCFIcon();
 
     // Overlay window 
@@ -852,18 +2224,33 @@ int WINAPI WinMain(HINSTANCE hInst,HINSTANCE,LPSTR,int)
         "CF_Overlay","",WS_POPUP,0,0,OV_SIZE,OV_SIZE,NULL,NULL,hInst,NULL);
     ShowWindow(g_hwndOverlay,SW_HIDE);
 
+    // Render thread: gets the first config snapshot before it starts.
+    g_renderWake=CreateEventA(NULL,FALSE,FALSE,NULL);
+    g_paceClock.inner=&g_clock;
+    g_power=PowerNow();
+    PublishConfig();
+    g_renderThread=CreateThread(NULL,0,RenderThreadProc,hInst,0,NULL);
+
+    // Command channel for other processes.
+    PipeName(g_pipe.name,sizeof(g_pipe.name));
+    g_pipe.stop=CreateEventA(NULL,TRUE,FALSE,NULL);
+    g_ipcCookie=(WPARAM)(g_clock.NowNs()*6364136223846793005ULL)|1;
+    if(g_pipe.stop)Ipc_Start(g_ipc,&g_pipe,IpcHandle,nullptr);
+
     // Tray icon
     g_nid.cbSize=sizeof(NOTIFYICONDATA);g_nid.hWnd=g_hwndOverlay;g_nid.uID=TRAY_ID;
     g_nid.uFlags=NIF_ICON|NIF_TIP|NIF_MESSAGE;g_nid.uCallbackMessage=WM_TRAY;
     g_nid.hIcon=g_hBCFIcon;
     lstrcpyA(g_nid.szTip,"Better Cursor Finder - Left-click: Settings");
     Shell_NotifyIconA(NIM_ADD,&g_nid);
+    Startup_Tray();
 
     // Settings window
     WNDCLASSEXA wcs={};wcs.cbSize=sizeof(wcs);wcs.lpfnWndProc=SettingsWndProc;
     wcs.hInstance=hInst;wcs.lpszClassName="CF_Settings";
     wcs.hCursor=LoadCursor(NULL,IDC_ARROW);RegisterClassExA(&wcs);
    
+    DPI_AWARENESS_CONTEXT dpiPrev=BeginDpiUnaware();
     RECT adjRC={0,0,SW_W,SW_H};
     AdjustWindowRect(&adjRC,WS_OVERLAPPED|WS_CAPTION|WS_SYSMENU|WS_MINIMIZEBOX,FALSE);
     int winW=adjRC.right-adjRC.left, winH=adjRC.bottom-adjRC.top;
@@ -871,6 +2258,7 @@ int WINAPI WinMain(HINSTANCE hInst,HINSTANCE,LPSTR,int)
     g_hwndSettings=CreateWindowExA(0,"CF_Settings","Better Cursor Finder",
         WS_OVERLAPPED|WS_CAPTION|WS_SYSMENU|WS_MINIMIZEBOX,
         0,0,winW,winH,NULL,NULL,hInst,NULL);
+    EndDpiUnaware(dpiPrev);
     
     SendMessageA(g_hwndSettings,WM_SETICON,ICON_SMALL,(LPARAM)g_hBCFIcon);
     SendMessageA(g_hwndSettings,WM_SETICON,ICON_BIG,  (LPARAM)g_hBCFIcon);
@@ -884,45 +2272,49 @@ int WINAPI WinMain(HINSTANCE hInst,HINSTANCE,LPSTR,int)
     wcp.hInstance=hInst;wcp.lpszClassName="CF_ColorPicker";
     wcp.hCursor=LoadCursor(NULL,IDC_ARROW);RegisterClassExA(&wcp);
 
-    // Main loop
+    // Main loop: event-driven when the keyboard hook installs, polling otherwise. Frames
+    // are timed and drawn by the render thread either way.
+    g_kbHook=SetWindowsHookExA(WH_KEYBOARD_LL,KeyboardHookProc,hInst,0);
+    const bool eventDriven=g_kbHook!=nullptr;
+    g_shake.pol.scale=ScreenDpi()/96.f;
+    SyncRawMouse();
+
     MSG msg;
     while(true){
+        if(eventDriven) MsgWaitForMultipleObjectsEx(0,NULL,INFINITE,QS_ALLINPUT,MWMO_INPUTAVAILABLE);
         while(PeekMessageA(&msg,NULL,0,0,PM_REMOVE)){
             if(msg.message==WM_QUIT){
+                // Answer any command already sent to this thread while the IPC threads wind down.
+                g_pipe.Stop();
+                while(Ipc_Running(g_ipc)){
+                    MsgWaitForMultipleObjects(0,NULL,FALSE,10,QS_SENDMESSAGE);
+                    PeekMessageA(&msg,NULL,0,0,PM_NOREMOVE|PM_QS_SENDMESSAGE);
+                }
+                Ipc_Stop(g_ipc);
+                if(g_pipe.stop)CloseHandle(g_pipe.stop);
                 Shell_NotifyIconA(NIM_DELETE,&g_nid);
+                if(g_kbHook)UnhookWindowsHookEx(g_kbHook);
+                if(g_renderThread){
+                    Render_Send(RC_QUIT);
+                    WaitForSingleObject(g_renderThread,2000);CloseHandle(g_renderThread);
+                }
+                if(g_renderWake)CloseHandle(g_renderWake);
+                if(g_trace.file){KillTimer(g_hwndOverlay,TRACE_TIMER);Trace_End(g_trace);}
                 if(g_hBCFIcon)DestroyIcon(g_hBCFIcon);
-                GdiplusShutdown(token);CloseHandle(hMutex);return 0;
+                SW_FreeCache();
+                Store_Stop(g_store);
+                if(g_gdipToken)GdiplusShutdown(g_gdipToken);
+                CloseHandle(hMutex);return 0;
             }
             TranslateMessage(&msg);DispatchMessageA(&msg);
         }
 
-        bool ctrlDown=(GetAsyncKeyState(VK_CONTROL)&0x8000)!=0;
+        if(eventDriven)continue;
 
-        if(ctrlDown&&!g_ctrlWas){
-            g_comboDetected=false;
-            memset(g_preExisting,0,sizeof(g_preExisting));
-            for(int vk=1;vk<256;vk++) if(GetAsyncKeyState(vk)&0x8000)g_preExisting[vk]=true;
-        }
-        if(ctrlDown){
-            for(int vk=1;vk<256;vk++){
-                if(vk==VK_CONTROL||vk==VK_LCONTROL||vk==VK_RCONTROL)continue;
-                if(g_preExisting[vk])continue;
-                if(GetAsyncKeyState(vk)&0x8000){g_comboDetected=true;break;}
-            }
-        }
-        if(!ctrlDown&&g_ctrlWas){
-            if(!g_comboDetected)StartAnimation();
-            g_comboDetected=false;
-        }
-        g_ctrlWas=ctrlDown;
-
-        CheckCancel();
-        if(g_animating){
-            DWORD elapsed=GetTickCount()-g_startTime;
-            float progress=std::min((float)elapsed/GetDuration(),1.f);
-            GetCursorPos(&g_cursor);
-            RenderFrame(progress);
-        }
-        Sleep(6);
+        const bool ctrlWas=g_tap.ctrlWas;
+        TapAction a=TapPoll(SnapshotKeys());
+        if(g_tap.ctrlWas&&!ctrlWas)OnCtrlDown();
+        OnTap(a);
+        Sleep(FRAME_MS);
     }
 }
\ No newline at end of file
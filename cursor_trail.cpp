@@ -0,0 +1,149 @@
+//  cursor_trail.cpp  –  Better Cursor Finder (BCF)
+//  Coverage of a pixel is clamp(r + 0.5 - distance to the segment) times the segment alpha.
+//  The rasterizer walks the union of the segment boxes row by row; per row each segment
+//  contributes only the x span its capsule can reach, so diagonal segments don't pay for
+//  their whole bounding box.
+
+#include "cursor_trail.h"
+#include <algorithm>
+#include <cmath>
+
+void Trail_Clear(TrailHistory&h){h.head=0;h.count=0;}
+
+static inline const TrailSample&Back(const TrailHistory&h,int i)   // i = 0 is the newest
+{
+    return h.s[(h.head-1-i+TRAIL_CAP)%TRAIL_CAP];
+}
+
+void Trail_Add(TrailHistory&h,int64_t tNs,float x,float y)
+{
+    if(h.count){
+        const TrailSample&p=Back(h,0);
+        if(tNs<p.tNs)return;
+        if(fabsf(x-p.x)<0.5f&&fabsf(y-p.y)<0.5f&&h.count>1){
+            TrailSample&q=h.s[(h.head-1+TRAIL_CAP)%TRAIL_CAP]; q.tNs=tNs; return;
+        }
+    }
+    h.s[h.head]={tNs,x,y};
+    h.head=(h.head+1)%TRAIL_CAP;
+    if(h.count<TRAIL_CAP)h.count++;
+}
+
+static inline float SegSpeed(const TrailSample&a,const TrailSample&b)
+{
+    float dt=(float)(a.tNs-b.tNs)*1e-9f;
+    return dt>0?hypotf(a.x-b.x,a.y-b.y)/dt:0.f;
+}
+
+float Trail_Speed(const TrailHistory&h){return h.count<2?0.f:SegSpeed(Back(h,0),Back(h,1));}
+
+int Trail_Build(const TrailHistory&h,int64_t nowNs,const TrailStyle&st,TrailSegment*out,int max)
+{
+    const float life=st.lifeMs*1e6f, r0=st.width*st.scale*0.5f, vMin=st.minSpeed*st.scale;
+    const float step2=std::max(1.f,r0*r0), maxLen=st.maxLength*st.scale;
+    float len=0;
+    int n=0;
+    for(int i=0,j=1;j<h.count&&n<max;j++){
+        const TrailSample&a=Back(h,i), &b=Back(h,j);
+        // High-rate mice report sub-pixel steps; merge them until a segment is worth drawing.
+        float ex=a.x-b.x, ey=a.y-b.y, d2=ex*ex+ey*ey;
+        if(d2<step2&&j+1<h.count)continue;
+        i=j; len+=sqrtf(d2);
+        // The older end decides the fade, by age or by distance from the pointer.
+        float age=std::max((float)(nowNs-b.tNs)/life,len/maxLen);
+        if(age>=1.f)break;
+        float f=1.f-std::max(0.f,age);
+        float v=std::min(1.f,SegSpeed(a,b)/vMin);
+        float al=st.alpha*f*f*v*v;
+        if(al<1.f/255.f)continue;
+        TrailSegment&s=out[n++];
+        s.x0=a.x; s.y0=a.y; s.x1=b.x; s.y1=b.y;
+        s.r=std::max(0.5f,r0*(0.35f+0.65f*f)); s.alpha=al;
+    }
+    return n;
+}
+
+static inline void SegBox(const TrailSegment&s,float&x0,float&y0,float&x1,float&y1)
+{
+    const float e=s.r+0.5f;
+    x0=std::min(s.x0,s.x1)-e; x1=std::max(s.x0,s.x1)+e;
+    y0=std::min(s.y0,s.y1)-e; y1=std::max(s.y0,s.y1)+e;
+}
+
+IRect Trail_Bounds(const TrailSegment*segs,int n)
+{
+    IRect b;
+    for(int i=0;i<n;i++){
+        float x0,y0,x1,y1; SegBox(segs[i],x0,y0,x1,y1);
+        IRect r; r.x0=(int)floorf(x0); r.y0=(int)floorf(y0); r.x1=(int)ceilf(x1)+1; r.y1=(int)ceilf(y1)+1;
+        if(IRectEmpty(b))b=r;
+        else{b.x0=std::min(b.x0,r.x0);b.y0=std::min(b.y0,r.y0);b.x1=std::max(b.x1,r.x1);b.y1=std::max(b.y1,r.y1);}
+    }
+    return b;
+}
+
+// Per-segment constants, so a pixel costs a clamp, a compare and (on the fringe only) a sqrt.
+struct Capsule {
+    float x0, y0, dx, dy, inv, e, e2, in2, a255;
+    explicit Capsule(const TrailSegment&s)
+        : x0(s.x0), y0(s.y0), dx(s.x1-s.x0), dy(s.y1-s.y0), e(s.r+0.5f), a255(s.alpha*255.f)
+    {
+        const float len2=dx*dx+dy*dy, ri=std::max(0.f,s.r-0.5f);
+        inv=len2>0?1.f/len2:0.f; e2=e*e; in2=ri*ri;
+    }
+    int Alpha(float px,float py)const{
+        const float fx=px-x0, fy=py-y0;
+        const float t=std::min(1.f,std::max(0.f,(fx*dx+fy*dy)*inv));
+        const float ex=fx-t*dx, ey=fy-t*dy, d2=ex*ex+ey*ey;
+        if(d2>=e2)return 0;
+        return (int)((d2<=in2?a255:(e-sqrtf(d2))*a255)+0.5f);
+    }
+};
+
+int Capsule_Alpha(float px,float py,const TrailSegment*segs,int n)
+{
+    int a=0;
+    for(int i=0;i<n;i++)a=std::max(a,Capsule(segs[i]).Alpha(px,py));
+    return a;
+}
+
+IRect RasterCapsules(uint32_t*bits,int w,int h,int stride,float ox,float oy,
+                     const TrailSegment*segs,int n,uint32_t color)
+{
+    if(n<=0)return IRect();
+    uint32_t lut[256];
+    const uint32_t b=color>>16&255, g=color>>8&255, r=color&255;
+    for(int a=0;a<256;a++)lut[a]=(uint32_t)a<<24|(r*a+127)/255<<16|(g*a+127)/255<<8|(b*a+127)/255;
+
+    IRect all=Trail_Bounds(segs,n);
+    const int ry0=std::max(0,(int)floorf((float)all.y0-oy)), ry1=std::min(h,(int)ceilf((float)all.y1-oy));
+    IRect box; box.x0=w; box.y0=h;
+    for(int y=ry0;y<ry1;y++){
+        const float py=(float)y+0.5f+oy;
+        uint32_t*row=bits+(size_t)y*stride;
+        for(int i=0;i<n;i++){
+            const TrailSegment&s=segs[i];
+            const float e=s.r+0.5f;
+            if(py<std::min(s.y0,s.y1)-e||py>std::max(s.y0,s.y1)+e)continue;
+            const Capsule c(s);
+            // Part of the segment within e of this row, widened by e: the capsule's x reach.
+            float ta=0.f, tb=1.f; const float dy=s.y1-s.y0;
+            if(fabsf(dy)>1e-6f){
+                ta=(py-e-s.y0)/dy; tb=(py+e-s.y0)/dy;
+                if(ta>tb)std::swap(ta,tb);
+                ta=std::max(0.f,ta); tb=std::min(1.f,tb);
+            }
+            const float xa=s.x0+ta*(s.x1-s.x0), xb=s.x0+tb*(s.x1-s.x0);
+            const int x0=std::max(0,(int)floorf(std::min(xa,xb)-e-ox)), x1=std::min(w,(int)ceilf(std::max(xa,xb)+e-ox)+1);
+            for(int x=x0;x<x1;x++){
+                const int a=c.Alpha((float)x+0.5f+ox,py);
+                if(a>(int)(row[x]>>24)){
+                    row[x]=lut[a];
+                    box.x0=std::min(box.x0,x); box.x1=std::max(box.x1,x+1);
+                    box.y0=std::min(box.y0,y); box.y1=y+1;
+                }
+            }
+        }
+    }
+    return IRectEmpty(box)?IRect():box;
+}
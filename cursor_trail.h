@@ -0,0 +1,50 @@
+//  cursor_trail.h  –  Better Cursor Finder (BCF)
+//  Trail mode: a fading tail drawn behind the pointer while it moves fast. Samples go into a
+//  fixed ring that overwrites its oldest entry; each frame the live part of it is turned into
+//  capsule segments (width and alpha tapering with age and slowing) in a caller-owned array,
+//  and one rasterizer call draws every segment. Nothing here allocates. No Windows headers.
+#pragma once
+#include "ring_raster.h"
+#include <cstdint>
+
+static const int TRAIL_CAP = 128;                 // samples kept; also the most segments a frame has
+
+struct TrailSample  { int64_t tNs = 0; float x = 0, y = 0; };
+
+struct TrailHistory {
+    TrailSample s[TRAIL_CAP];
+    int         head = 0;                         // next slot written
+    int         count = 0;
+};
+
+struct TrailStyle {
+    uint32_t color    = 0x00FFFFFF;               // COLORREF layout, 0x00BBGGRR
+    float    width    = 9.f;                      // logical px at the head of the trail
+    float    alpha    = 0.8f;                     // at the head, before the speed fade
+    float    lifeMs   = 180.f;                    // a sample is gone this long after it was taken
+    float    maxLength= 420.f;                    // logical px; fast flicks fade by distance instead
+    float    minSpeed = 1200.f;                   // px/s below which a segment fades out
+    float    scale    = 1.f;                      // DPI scale applied to the lengths and minSpeed
+};
+
+struct TrailSegment { float x0 = 0, y0 = 0, x1 = 0, y1 = 0, r = 0, alpha = 0; };
+
+void Trail_Clear(TrailHistory&h);
+// Samples closer than half a pixel to the previous one replace it instead of adding a segment.
+void Trail_Add  (TrailHistory&h,int64_t tNs,float x,float y);
+// Speed of the newest segment in px/s (0 without two samples).
+float Trail_Speed(const TrailHistory&h);
+
+// Writes the segments still visible at nowNs, newest first, into out[0..max); returns the count.
+// Runs of samples shorter than half the head width are merged into one segment.
+int   Trail_Build (const TrailHistory&h,int64_t nowNs,const TrailStyle&st,TrailSegment*out,int max);
+// Pixel bounds of the segments, anti-aliased fringe included.
+IRect Trail_Bounds(const TrailSegment*segs,int n);
+
+// Draws segments (offset by -ox,-oy) into premultiplied BGRA bits in one pass over their rows;
+// overlaps keep the larger coverage, so joints don't double up. Only pixels inside the
+// returned rect are written and nothing is cleared.
+IRect RasterCapsules(uint32_t*bits,int w,int h,int stride,float ox,float oy,
+                     const TrailSegment*segs,int n,uint32_t color);
+// Reference coverage (0..255) of one pixel, for tests and benchmarks.
+int   Capsule_Alpha(float px,float py,const TrailSegment*segs,int n);
@@ -0,0 +1,79 @@
+//  frame_governor.cpp  –  Better Cursor Finder (BCF)
+//  Step 0 is full quality at the power source's rate; every further step is reduced quality
+//  with the divisor one higher, down to minHz. The cost estimate restarts at each step so a
+//  level is judged on its own frames only.
+
+#include "frame_governor.h"
+#include <algorithm>
+#include <cmath>
+
+static float RefreshHz(const FrameGovernor&g){return g.periodNs>0?1e9f/(float)g.periodNs:60.f;}
+
+static int FloorDivisor(const FrameGovernor&g){
+    float cap=g.power==POWER_SAVER?g.pol.saverHz:g.power==POWER_BATTERY?g.pol.batteryHz:0.f;
+    if(cap<=0)return 1;
+    return std::max(1,(int)ceilf(RefreshHz(g)/cap-0.01f));
+}
+
+int Gov_MinLevel(const FrameGovernor&g){return g.power==POWER_SAVER?1:0;}
+int Gov_MaxLevel(const FrameGovernor&g){
+    int top=std::max(FloorDivisor(g),(int)floorf(RefreshHz(g)/g.pol.minHz+0.01f));
+    return 1+top-FloorDivisor(g);
+}
+
+GovStep Gov_StepAt(const FrameGovernor&g,int level)
+{
+    level=std::min(std::max(level,Gov_MinLevel(g)),Gov_MaxLevel(g));
+    GovStep s;
+    s.quality=level?GOV_REDUCED:GOV_FULL;
+    s.divisor=FloorDivisor(g)+(level?level-1:0);
+    return s;
+}
+
+static void Clamp(FrameGovernor&g){g.level=std::min(std::max(g.level,Gov_MinLevel(g)),Gov_MaxLevel(g));}
+
+static void Step(FrameGovernor&g,int d,int64_t tNs)
+{
+    g.level+=d; Clamp(g);
+    g.costNs=0; g.over=0; g.underSince=d>0?0:tNs;
+    (d>0?g.stats.down:g.stats.up)++;
+    g.stats.deepest=std::max(g.stats.deepest,g.level);
+}
+
+void Gov_SetPower(FrameGovernor&g,PowerSource p){g.power=p;Clamp(g);}
+
+void Gov_Start(FrameGovernor&g,int64_t tNs)
+{
+    if(!g.lastFrameNs||tNs-g.lastFrameNs>=g.pol.idleNs){
+        if(g.level!=Gov_MinLevel(g))g.stats.resets++;
+        g.level=Gov_MinLevel(g);
+    }
+    Clamp(g);
+    g.costNs=0; g.over=0; g.underSince=0; g.lastMissed=0;
+    g.stats.animations++;
+}
+
+void Gov_Frame(FrameGovernor&g,int64_t tNs,int64_t costNs,uint64_t missed,int64_t periodNs)
+{
+    if(periodNs>0&&periodNs!=g.periodNs){g.periodNs=periodNs;Clamp(g);}
+    g.stats.frames++; g.lastFrameNs=tNs;
+    if(Gov_Current(g).quality==GOV_REDUCED)g.stats.reduced++;
+    g.costNs=g.costNs>0?g.costNs+0.25*((double)costNs-g.costNs):(double)costNs;
+    const bool miss=missed>g.lastMissed; g.lastMissed=missed;
+
+    if(miss||g.costNs>(double)g.pol.budgetNs){
+        g.underSince=0;
+        if(++g.over>=g.pol.downFrames&&g.level<Gov_MaxLevel(g))Step(g,+1,tNs);
+        return;
+    }
+    g.over=0;
+    if(g.costNs>=(double)g.pol.budgetNs*g.pol.upFrac){g.underSince=0;return;}
+    if(!g.underSince)g.underSince=tNs;
+    else if(tNs-g.underSince>=g.pol.upHoldNs&&g.level>Gov_MinLevel(g))Step(g,-1,tNs);
+}
+
+const char*GovPowerName(int p)
+{
+    static const char*n[]={"ac","battery","saver"};
+    return p>=0&&p<3?n[p]:"?";
+}
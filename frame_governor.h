@@ -0,0 +1,60 @@
+//  frame_governor.h  –  Better Cursor Finder (BCF)
+//  Picks the animation frame rate (every Nth vblank) and render quality from measured frame
+//  cost, the refresh rate and the power source. Over-budget frames or missed vblanks walk
+//  down a ladder of cheaper steps; frames well under budget walk back up, and an animation
+//  that starts after an idle gap (no frames drawn) starts at the top again.
+//  No Windows headers.
+#pragma once
+#include <cstdint>
+
+enum PowerSource : uint8_t { POWER_AC, POWER_BATTERY, POWER_SAVER };
+enum GovQuality  : uint8_t {
+    GOV_FULL,           // atlas, live rasterization for keys it lacks
+    GOV_REDUCED,        // nearest baked frame within a radius step, else live without the glow
+};
+
+struct GovPolicy {
+    int64_t budgetNs   = 2000000;     // a frame must fit the pacer's render lead
+    float   upFrac     = 0.5f;        // cost under this share of the budget is headroom
+    int     downFrames = 3;           // consecutive bad frames before stepping down
+    int64_t upHoldNs   = 500000000;   // headroom held this long before stepping up
+    int64_t idleNs     = 3000000000;  // no frames for this long resets the ladder
+    float   minHz      = 30.f;        // never divide the refresh rate below this
+    float   batteryHz  = 60.f;        // frame rate cap on battery
+    float   saverHz    = 30.f;        // ... and with battery saver, which also reduces quality
+};
+
+struct GovStep { int divisor; GovQuality quality; };
+
+struct GovStats {
+    uint64_t frames = 0, animations = 0;
+    uint64_t down = 0, up = 0, resets = 0;
+    uint64_t reduced = 0;               // frames drawn at GOV_REDUCED
+    int      deepest = 0;               // lowest step reached
+};
+
+struct FrameGovernor {
+    GovPolicy   pol;
+    PowerSource power      = POWER_AC;
+    int64_t     periodNs   = 16666667;  // last refresh period seen
+    int         level      = 0;         // 0 = full rate, full quality
+    double      costNs     = 0;         // EWMA of the frame cost at this level, 0 = no sample yet
+    int         over       = 0;         // consecutive bad frames
+    int64_t     underSince = 0;         // start of the current headroom run, 0 = none
+    uint64_t    lastMissed = 0;         // pacer misses already counted this animation
+    int64_t     lastFrameNs = 0;
+    GovStats    stats;
+};
+
+// Ladder for the current power source and refresh period.
+int     Gov_MinLevel(const FrameGovernor&g);
+int     Gov_MaxLevel(const FrameGovernor&g);
+GovStep Gov_StepAt  (const FrameGovernor&g,int level);
+static inline GovStep Gov_Current(const FrameGovernor&g){return Gov_StepAt(g,g.level);}
+
+void Gov_SetPower(FrameGovernor&g,PowerSource p);
+void Gov_Start   (FrameGovernor&g,int64_t tNs);
+// After each drawn frame: its cost, the pacer's missed-vblank count for this animation and
+// the refresh period the frame was paced to.
+void Gov_Frame   (FrameGovernor&g,int64_t tNs,int64_t costNs,uint64_t missed,int64_t periodNs);
+const char*GovPowerName(int p);
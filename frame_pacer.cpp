@@ -0,0 +1,58 @@
+//  frame_pacer.cpp  –  Better Cursor Finder (BCF)
+//  Progress comes from the vblank a frame will be shown on rather than the time the loop
+//  happened to wake, so radius steps stay even at any refresh rate. A wake whose frame
+//  would land on a vblank that already got one, or sooner than the divisor allows, is
+//  skipped.
+
+#include "frame_pacer.h"
+#include <cmath>
+
+double PaceJitterNs(const PaceStats&s){return s.frames>2?sqrt(s.m2/(double)(s.frames-2)):0.0;}
+
+void Pacer_Start(FramePacer&p,PaceClock*clock,float durationMs)
+{
+    p.clock=clock;
+    p.startNs=clock->NowNs();
+    p.durationNs=(int64_t)(durationMs*1e6);
+    if(p.durationNs<1)p.durationNs=1;
+    p.lastPresentNs=0;
+    p.stats=PaceStats();
+}
+
+static void Record(PaceStats&s,int64_t prev,int64_t present,int64_t period,int divisor)
+{
+    s.frames++;
+    if(!prev)return;
+    int64_t dt=present-prev;
+    if(period>0&&dt>divisor*period+period/2)s.missed+=(uint64_t)((dt+period/2)/period-divisor);
+    if(dt>s.maxNs)s.maxNs=dt;
+    double n=(double)(s.frames-1), d=(double)dt-s.meanNs;      // intervals seen so far
+    s.meanNs+=d/n; s.m2+=d*((double)dt-s.meanNs);
+}
+
+PaceFrame Pacer_Next(FramePacer&p)
+{
+    const int64_t now=p.clock->NowNs();
+    int64_t period=0,vblank=0;
+    PaceFrame f;
+    if(p.clock->VBlank(period,vblank)&&period>0){
+        // First vblank we can still make after the render lead.
+        int64_t target=now+p.leadNs;
+        int64_t k=(target-vblank+period-1)/period;
+        if(target<vblank)k=-((vblank-target)/period);
+        f.presentNs=vblank+k*period;
+    } else {
+        period=p.fallbackNs;
+        f.presentNs=now+p.leadNs;
+    }
+    const int div=p.divisor>1?p.divisor:1;
+    f.render=f.presentNs>p.lastPresentNs&&(div==1||!p.lastPresentNs||f.presentNs>=p.lastPresentNs+div*period-period/2);
+    if(f.render){Record(p.stats,p.lastPresentNs,f.presentNs,period,div);p.lastPresentNs=f.presentNs;}
+    else p.stats.skipped++;
+
+    double t=(double)(f.presentNs-p.startNs)/(double)p.durationNs;
+    f.progress=(float)(t<0?0:t>1?1:t);
+    f.wakeNs=(f.render?f.presentNs:p.lastPresentNs)+div*period-p.leadNs-p.slackNs;
+    if(f.wakeNs<=now)f.wakeNs=now+period/4;
+    return f;
+}
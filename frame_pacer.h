@@ -0,0 +1,45 @@
+//  frame_pacer.h  –  Better Cursor Finder (BCF)
+//  Vblank-aligned frame scheduling for the locate animation. The clock is injected, so
+//  the scheduler runs against QueryPerformanceCounter + DWM on Windows and a scripted
+//  clock elsewhere. No Windows headers.
+#pragma once
+#include <cstdint>
+
+struct PaceClock {
+    virtual ~PaceClock(){}
+    virtual int64_t NowNs()=0;                                   // monotonic
+    // Refresh period and a recent vblank on the NowNs timeline; false when unknown.
+    virtual bool VBlank(int64_t&periodNs,int64_t&lastNs)=0;
+};
+
+struct PaceStats {
+    uint64_t frames   = 0;      // frames handed to the compositor
+    uint64_t skipped  = 0;      // wakes that would have presented on an already-used vblank
+    uint64_t missed   = 0;      // vblanks that were due a new frame and did not get one
+    double   meanNs   = 0;      // present-to-present interval
+    double   m2       = 0;      // Welford accumulator for the variance
+    int64_t  maxNs    = 0;
+};
+double PaceJitterNs(const PaceStats&s);                          // std-dev of the interval
+
+struct PaceFrame {
+    bool    render;             // false: nothing new would reach the screen, skip this wake
+    float   progress;           // 0..1 at the predicted present time
+    int64_t presentNs;          // predicted present (vblank) time
+    int64_t wakeNs;             // when to call Pacer_Next again
+};
+
+struct FramePacer {
+    PaceClock*clock         = nullptr;
+    int64_t   startNs       = 0;
+    int64_t   durationNs    = 1;
+    int64_t   fallbackNs    = 6000000;   // frame period when no vblank information exists
+    int64_t   leadNs        = 2000000;   // render + upload budget ahead of the vblank
+    int64_t   slackNs       = 1000000;   // how late a timer wake may be without losing the vblank
+    int       divisor       = 1;         // present on every Nth vblank (frame governor)
+    int64_t   lastPresentNs = 0;
+    PaceStats stats;
+};
+
+void      Pacer_Start(FramePacer&p,PaceClock*clock,float durationMs);
+PaceFrame Pacer_Next (FramePacer&p);
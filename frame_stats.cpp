@@ -0,0 +1,65 @@
+//  frame_stats.cpp  –  Better Cursor Finder (BCF)
+
+#include "frame_stats.h"
+
+const char*FramePhaseName(int ph)
+{
+    static const char*n[PH_COUNT]={"setup","raster","present","total"};
+    return ph>=0&&ph<PH_COUNT?n[ph]:"?";
+}
+
+// Values below 2^SUB map 1:1; above that, the top SUB+1 significant bits pick the bucket.
+static int BucketOf(uint32_t v)
+{
+    if(v<(1u<<HIST_SUB_BITS))return (int)v;
+    int e=31; while(!(v>>e))e--;
+    return ((e-HIST_SUB_BITS+1)<<HIST_SUB_BITS)|(int)((v>>(e-HIST_SUB_BITS))&((1u<<HIST_SUB_BITS)-1));
+}
+static uint32_t BucketTop(int b)
+{
+    int e=b>>HIST_SUB_BITS, m=b&((1<<HIST_SUB_BITS)-1);
+    if(!e)return (uint32_t)m;
+    uint64_t lo=(uint64_t)((1<<HIST_SUB_BITS)|m)<<(e-1);
+    uint64_t hi=lo+((uint64_t)1<<(e-1))-1;
+    return hi>0xFFFFFFFFu?0xFFFFFFFFu:(uint32_t)hi;
+}
+
+void Hist_Add(LatencyHist&h,uint32_t ns)
+{
+    h.count[BucketOf(ns)]++; h.total++; h.sumNs+=ns;
+    if(ns>h.maxNs)h.maxNs=ns;
+}
+
+uint32_t Hist_Percentile(const LatencyHist&h,double p)
+{
+    if(!h.total)return 0;
+    uint64_t want=(uint64_t)(p*(double)h.total+0.5); if(want<1)want=1;
+    uint64_t seen=0;
+    for(int b=0;b<HIST_BUCKETS;b++)
+        if((seen+=h.count[b])>=want){uint32_t t=BucketTop(b);return t<h.maxNs?t:h.maxNs;}
+    return h.maxNs;
+}
+
+void Stats_Drain(FrameStats&s)
+{
+    FrameSample f;
+    while(s.ring.Pop(f))
+        for(int i=0;i<PH_COUNT;i++)Hist_Add(s.hist[i],f.ns[i]);
+}
+
+void Stats_Write(FrameStats&s,FILE*f)
+{
+    Stats_Drain(s);
+    fprintf(f,"BCF frame stats\n");
+    fprintf(f,"animations %llu  cancelled %llu  frames %llu  missed vblanks %llu  dropped samples %llu\n\n",
+            (unsigned long long)s.animations.load(),(unsigned long long)s.cancelled.load(),
+            (unsigned long long)s.hist[PH_TOTAL].total,(unsigned long long)s.missed.load(),
+            (unsigned long long)s.dropped.load());
+    fprintf(f,"%-8s %10s %10s %10s %10s\n","phase","p50 us","p99 us","max us","mean us");
+    for(int i=0;i<PH_COUNT;i++){
+        const LatencyHist&h=s.hist[i];
+        double mean=h.total?(double)h.sumNs/(double)h.total:0;
+        fprintf(f,"%-8s %10.1f %10.1f %10.1f %10.1f\n",FramePhaseName(i),Hist_Percentile(h,0.5)/1e3,
+                Hist_Percentile(h,0.99)/1e3,h.maxNs/1e3,mean/1e3);
+    }
+}
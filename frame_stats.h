@@ -0,0 +1,46 @@
+//  frame_stats.h  –  Better Cursor Finder (BCF)
+//  Always-on frame timing, owned by the render thread: each frame pushes its per-phase
+//  durations into a bounded ring, and EndAnimation drains it into log-linear histograms so
+//  no frame pays for the fold. Other threads see only the published StatsCounters. The ring
+//  is the SPSC one from spsc_ring.h used by one thread; its ordering costs nothing on x86
+//  (Stats_Record is about 2 ns) and a full ring drops samples. No Windows headers.
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include "spsc_ring.h"
+
+enum FramePhase { PH_SETUP, PH_RASTER, PH_PRESENT, PH_TOTAL, PH_COUNT };
+const char*FramePhaseName(int ph);
+
+struct FrameSample { uint32_t ns[PH_COUNT] = {}; };
+
+// 8 linear sub-buckets per power of two: <= 12.5% error, 240 counters cover all of uint32.
+enum { HIST_SUB_BITS=3, HIST_BUCKETS=(32-HIST_SUB_BITS+1)<<HIST_SUB_BITS };
+struct LatencyHist {
+    uint32_t count[HIST_BUCKETS] = {};
+    uint64_t total = 0;
+    uint64_t sumNs = 0;
+    uint32_t maxNs = 0;
+};
+void     Hist_Add(LatencyHist&h,uint32_t ns);
+uint32_t Hist_Percentile(const LatencyHist&h,double p);     // p in 0..1; bucket upper bound
+
+struct FrameStats {
+    SpscRing<FrameSample,1024> ring;
+    LatencyHist hist[PH_COUNT];
+    std::atomic<uint64_t> dropped{0};      // samples lost to a full ring
+    std::atomic<uint64_t> missed{0};       // vblanks that passed without a new frame
+    std::atomic<uint64_t> cancelled{0};    // animations cut short by a key, click or move
+    std::atomic<uint64_t> animations{0};
+};
+static inline void Stats_Record(FrameStats&s,const FrameSample&f){if(!s.ring.Push(f))s.dropped++;}
+
+// The counters as one consistent set, for publishing to threads that do not own the stats.
+struct StatsCounters { uint64_t animations = 0, cancelled = 0, missed = 0; };
+static inline StatsCounters Stats_Counters(const FrameStats&s){
+    StatsCounters c; c.animations=s.animations.load(); c.cancelled=s.cancelled.load(); c.missed=s.missed.load();
+    return c;
+}
+void Stats_Drain(FrameStats&s);                             // consumer side
+void Stats_Write(FrameStats&s,FILE*f);                      // drains, then prints a report
@@ -0,0 +1,275 @@
+//  ipc_channel.cpp  –  Better Cursor Finder (BCF)
+//  Headers are validated before any payload is read, so a client speaking another version
+//  gets IPC_BAD_VERSION and a closed connection rather than a misparsed command. A message
+//  goes out in one write; on a local socket or pipe a round trip is two context switches.
+
+#include "ipc_channel.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#if !defined(_WIN32)
+  #include <cerrno>
+  #include <sys/socket.h>
+  #include <sys/stat.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif
+
+//  PROTOCOL
+static void PutU32(uint8_t*p,uint32_t v){for(int i=0;i<4;i++)p[i]=(uint8_t)(v>>8*i);}
+static void PutU64(uint8_t*p,uint64_t v){for(int i=0;i<8;i++)p[i]=(uint8_t)(v>>8*i);}
+static uint32_t GetU32(const uint8_t*p){uint32_t v=0;for(int i=0;i<4;i++)v|=(uint32_t)p[i]<<8*i;return v;}
+static uint64_t GetU64(const uint8_t*p){uint64_t v=0;for(int i=0;i<8;i++)v|=(uint64_t)p[i]<<8*i;return v;}
+
+static const int STATS_BYTES = 2+4*2+8*4;
+
+void Ipc_PutColor(IpcMessage&m,uint32_t ring,uint32_t outline)
+{
+    PutU32(m.data,ring&0xFFFFFF); PutU32(m.data+4,outline&0xFFFFFF); m.len=8;
+}
+bool Ipc_GetColor(const IpcMessage&m,uint32_t&ring,uint32_t&outline)
+{
+    if(m.len!=8)return false;
+    ring=GetU32(m.data); outline=GetU32(m.data+4);
+    return ring<=0xFFFFFF&&outline<=0xFFFFFF;
+}
+void Ipc_PutStats(IpcMessage&m,const IpcStats&s)
+{
+    uint8_t*p=m.data;
+    p[0]=s.animating; p[1]=s.mode; PutU32(p+2,s.ringColor); PutU32(p+6,s.outlineColor);
+    PutU64(p+10,s.animations); PutU64(p+18,s.cancelled); PutU64(p+26,s.missed); PutU64(p+34,s.requests);
+    m.len=STATS_BYTES;
+}
+bool Ipc_GetStats(const IpcMessage&m,IpcStats&s)
+{
+    if(m.len<STATS_BYTES)return false;      // newer versions may append fields
+    const uint8_t*p=m.data;
+    s.animating=p[0]; s.mode=p[1]; s.ringColor=GetU32(p+2); s.outlineColor=GetU32(p+6);
+    s.animations=GetU64(p+10); s.cancelled=GetU64(p+18); s.missed=GetU64(p+26); s.requests=GetU64(p+34);
+    return true;
+}
+
+// RRGGBB, with an optional leading '#', to 0x00BBGGRR.
+static bool ParseRgb(const char*s,size_t n,uint32_t&out)
+{
+    if(n&&*s=='#'){s++;n--;}
+    if(n!=6)return false;
+    uint32_t v=0;
+    for(size_t i=0;i<6;i++){
+        if(!isxdigit((unsigned char)s[i]))return false;
+        v=v<<4|(uint32_t)(isdigit((unsigned char)s[i])?s[i]-'0':(tolower((unsigned char)s[i])-'a'+10));
+    }
+    out=(v>>16&0xFF)|(v&0xFF00)|(v&0xFF)<<16;
+    return true;
+}
+
+bool Ipc_ParseArgs(const char*args,IpcMessage&req)
+{
+    const char*tok[4]; size_t len[4]; int n=0;
+    for(const char*p=args?args:"";*p;){
+        while(*p&&isspace((unsigned char)*p))p++;
+        if(!*p)break;
+        if(n==4)return false;
+        tok[n]=p; while(*p&&!isspace((unsigned char)*p))p++;
+        len[n]=(size_t)(p-tok[n]); n++;
+    }
+    if(!n)return false;
+    auto is=[&](const char*w){return len[0]==strlen(w)&&!memcmp(tok[0],w,len[0]);};
+    req=IpcMessage();
+    if(is("--color")){
+        uint32_t ring=0, outline=0;
+        if(n<2||n>3||!ParseRgb(tok[1],len[1],ring)||(n==3&&!ParseRgb(tok[2],len[2],outline)))return false;
+        req.op=IPC_SET_COLOR; Ipc_PutColor(req,ring,outline);
+        return true;
+    }
+    if(n!=1)return false;
+    if(is("--start"))      req.op=IPC_START;
+    else if(is("--cancel"))req.op=IPC_CANCEL;
+    else if(is("--ping"))  req.op=IPC_PING;
+    else if(is("--stats")) req.op=IPC_GET_STATS;
+    else return false;
+    return true;
+}
+
+const char*IpcStatusName(int status)
+{
+    static const char*n[]={"ok","bad version","bad op","bad args","busy"};
+    return status>=0&&status<5?n[status]:"?";
+}
+
+//  TRANSPORT
+int Ipc_Recv(IpcConn&c,IpcMessage&m)
+{
+    uint8_t h[3];
+    if(!c.Read(h,3))return 0;
+    if(h[0]!=IPC_VERSION||h[2]>IPC_MAX_PAYLOAD)return -1;
+    m.op=h[1]; m.len=h[2];
+    return !m.len||c.Read(m.data,m.len)?1:0;
+}
+bool Ipc_Send(IpcConn&c,const IpcMessage&m)
+{
+    uint8_t b[3+IPC_MAX_PAYLOAD];
+    const uint8_t len=m.len>IPC_MAX_PAYLOAD?(uint8_t)IPC_MAX_PAYLOAD:m.len;
+    b[0]=IPC_VERSION; b[1]=m.op; b[2]=len; memcpy(b+3,m.data,len);
+    return c.Write(b,3u+len);
+}
+bool Ipc_Call(IpcConn&c,const IpcMessage&req,IpcMessage&rep)
+{
+    return Ipc_Send(c,req)&&Ipc_Recv(c,rep)>0;
+}
+
+#if !defined(_WIN32)
+struct UnixSocketConn : IpcConn {
+    int fd; UnixSocketListener*owner;
+    UnixSocketConn(int f,UnixSocketListener*o):fd(f),owner(o){}
+    ~UnixSocketConn() override {
+        if(owner){
+            std::lock_guard<std::mutex> l(owner->mtx);
+            owner->active.erase(std::remove(owner->active.begin(),owner->active.end(),fd),owner->active.end());
+        }
+        close(fd);
+    }
+    bool Read(void*p,size_t n) override {
+        for(uint8_t*b=(uint8_t*)p;n;){
+            ssize_t r=recv(fd,b,n,0);
+            if(r<0&&errno==EINTR)continue;
+            if(r<=0)return false;
+            b+=r; n-=(size_t)r;
+        }
+        return true;
+    }
+    bool Write(const void*p,size_t n) override {
+#ifdef MSG_NOSIGNAL
+        const int flags=MSG_NOSIGNAL;
+#else
+        const int flags=0;
+#endif
+        for(const uint8_t*b=(const uint8_t*)p;n;){
+            ssize_t r=send(fd,b,n,flags);
+            if(r<0&&errno==EINTR)continue;
+            if(r<=0)return false;
+            b+=r; n-=(size_t)r;
+        }
+        return true;
+    }
+};
+
+static bool SocketAddr(const std::string&path,sockaddr_un&a)
+{
+    memset(&a,0,sizeof(a)); a.sun_family=AF_UNIX;
+    if(path.size()>=sizeof(a.sun_path))return false;
+    memcpy(a.sun_path,path.c_str(),path.size()+1);
+    return true;
+}
+
+UnixSocketListener::~UnixSocketListener()
+{
+    if(fd>=0){close(fd);unlink(path.c_str());}
+}
+
+bool UnixSocketListener::Open()
+{
+    sockaddr_un a;
+    if(!SocketAddr(path,a))return false;
+    struct stat st;
+    if(lstat(path.c_str(),&st)==0&&S_ISSOCK(st.st_mode))unlink(path.c_str());
+    fd=socket(AF_UNIX,SOCK_STREAM,0);
+    if(fd<0)return false;
+    if(bind(fd,(sockaddr*)&a,sizeof(a))!=0||listen(fd,4)!=0){close(fd);fd=-1;return false;}
+    return true;
+}
+
+IpcConn*UnixSocketListener::Accept()
+{
+    for(;;){
+        int c=accept(fd,nullptr,nullptr);
+        std::lock_guard<std::mutex> l(mtx);
+        if(stopped){if(c>=0)close(c);return nullptr;}
+        if(c<0){if(errno==EINTR||errno==ECONNABORTED)continue;return nullptr;}
+        active.push_back(c);
+        return new UnixSocketConn(c,this);
+    }
+}
+
+// Linux wakes accept() on shutdown of the listening socket; elsewhere a throwaway
+// connection does it.
+void UnixSocketListener::Stop()
+{
+    std::lock_guard<std::mutex> l(mtx);
+    if(stopped)return;
+    stopped=true;
+    for(int c:active)shutdown(c,SHUT_RDWR);
+    if(fd>=0&&shutdown(fd,SHUT_RDWR)!=0)
+        if(IpcConn*w=UnixSocket_Connect(path.c_str()))delete w;
+}
+
+IpcConn*UnixSocket_Connect(const char*path)
+{
+    sockaddr_un a;
+    if(!SocketAddr(path,a))return nullptr;
+    int fd=socket(AF_UNIX,SOCK_STREAM,0);
+    if(fd<0)return nullptr;
+#ifdef SO_NOSIGPIPE
+    int one=1; setsockopt(fd,SOL_SOCKET,SO_NOSIGPIPE,&one,sizeof(one));
+#endif
+    if(connect(fd,(sockaddr*)&a,sizeof(a))!=0){close(fd);return nullptr;}
+    return new UnixSocketConn(fd,nullptr);
+}
+#endif
+
+//  SERVER
+static void ServeConn(IpcServer&s,IpcConn*c,int slot)
+{
+    IpcMessage q, r; int got;
+    while((got=Ipc_Recv(*c,q))>0){
+        r=IpcMessage();
+        if(q.op>=IPC_OPS)r.op=IPC_BAD_OP;
+        else s.handler(s.ctx,q,r);
+        s.requests++;
+        if(!Ipc_Send(*c,r))break;
+    }
+    if(got<0){s.errors++;r=IpcMessage();r.op=IPC_BAD_VERSION;Ipc_Send(*c,r);}
+    delete c;
+    s.busy[slot].store(false,std::memory_order_release);
+}
+
+static void Serve(IpcServer&s)
+{
+    while(IpcConn*c=s.listener->Accept()){
+        int slot=0;
+        while(slot<IPC_MAX_CONNS&&s.busy[slot].load(std::memory_order_acquire))slot++;
+        if(slot==IPC_MAX_CONNS){
+            s.refused++;
+            IpcMessage r; r.op=IPC_BUSY; Ipc_Send(*c,r);
+            delete c; continue;
+        }
+        s.connections++;
+        if(s.conns[slot].joinable())s.conns[slot].join();      // finished; its slot is free
+        s.busy[slot]=true;
+        s.conns[slot]=std::thread(ServeConn,std::ref(s),c,slot);
+    }
+    s.accepting.store(false,std::memory_order_release);
+}
+
+void Ipc_Start(IpcServer&s,IpcListener*l,IpcHandler h,void*ctx)
+{
+    s.listener=l; s.handler=h; s.ctx=ctx; s.accepting=true;
+    s.worker=std::thread(Serve,std::ref(s));
+}
+
+void Ipc_Stop(IpcServer&s)
+{
+    if(!s.worker.joinable())return;
+    s.listener->Stop();
+    s.worker.join();
+    for(std::thread&t:s.conns)if(t.joinable())t.join();
+}
+
+bool Ipc_Running(const IpcServer&s)
+{
+    if(s.accepting.load(std::memory_order_acquire))return true;
+    for(const std::atomic<bool>&b:s.busy)if(b.load(std::memory_order_acquire))return true;
+    return false;
+}
@@ -0,0 +1,110 @@
+//  ipc_channel.h  –  Better Cursor Finder (BCF)
+//  Local command channel for other processes: macro tools, presenter remotes and a second
+//  launch of the app. A compact binary protocol of small framed messages over a pluggable
+//  stream transport, each connection served on its own thread. The Unix domain
+//  socket transport is portable; the named pipe transport lives in cursor_ring.cpp.
+//  No Windows headers.
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//  PROTOCOL
+// Every message is a 3-byte header (version, op or status, payload length) followed by the
+// payload; integers are little-endian. Requests carry an IpcOp, replies an IpcStatus.
+static const uint8_t IPC_VERSION     = 1;
+static const int     IPC_MAX_PAYLOAD = 64;
+static const int     IPC_MAX_CONNS   = 4;       // a further client gets IPC_BUSY and is closed
+
+enum IpcOp : uint8_t {
+    IPC_PING,           // no payload; checks the app is there
+    IPC_START,          // start the locate animation at the pointer
+    IPC_CANCEL,         // stop it
+    IPC_SET_COLOR,      // u32 ring, u32 outline, both 0x00BBGGRR; saved like a settings edit
+    IPC_GET_STATS,      // reply carries IpcStats
+    IPC_OPS
+};
+enum IpcStatus : uint8_t { IPC_OK, IPC_BAD_VERSION, IPC_BAD_OP, IPC_BAD_ARGS, IPC_BUSY };
+
+struct IpcMessage {
+    uint8_t op  = 0;                    // IpcOp in a request, IpcStatus in a reply
+    uint8_t len = 0;
+    uint8_t data[IPC_MAX_PAYLOAD] = {};
+};
+
+struct IpcStats {
+    uint8_t  animating = 0, mode = 0;
+    uint32_t ringColor = 0, outlineColor = 0;
+    uint64_t animations = 0, cancelled = 0, missed = 0;     // frame statistics counters
+    uint64_t requests = 0;                                   // served on the channel
+};
+
+void Ipc_PutColor(IpcMessage&m,uint32_t ring,uint32_t outline);
+bool Ipc_GetColor(const IpcMessage&m,uint32_t&ring,uint32_t&outline);
+void Ipc_PutStats(IpcMessage&m,const IpcStats&s);
+bool Ipc_GetStats(const IpcMessage&m,IpcStats&s);
+
+// Command line of a second launch: --start, --cancel, --ping, --stats or --color RRGGBB
+// [RRGGBB] (ring, then outline; the outline stays black when left out).
+bool        Ipc_ParseArgs(const char*args,IpcMessage&req);
+const char* IpcStatusName(int status);
+
+//  TRANSPORT
+struct IpcConn {
+    virtual ~IpcConn(){}
+    virtual bool Read(void*p,size_t n)=0;           // exactly n bytes; false on close or error
+    virtual bool Write(const void*p,size_t n)=0;
+};
+struct IpcListener {
+    virtual ~IpcListener(){}
+    virtual const char* Name()=0;
+    virtual IpcConn*    Accept()=0;                 // blocks; nullptr once stopped
+    virtual void        Stop()=0;                   // any thread: fails Accept and open reads
+};
+
+// 1 with a message, 0 when the peer closed, -1 on a malformed or other-version header.
+int  Ipc_Recv(IpcConn&c,IpcMessage&m);
+bool Ipc_Send(IpcConn&c,const IpcMessage&m);
+bool Ipc_Call(IpcConn&c,const IpcMessage&req,IpcMessage&rep);
+
+#if !defined(_WIN32)
+struct UnixSocketListener : IpcListener {
+    std::string path;
+    int         fd = -1;                // listening socket
+    std::vector<int> active;            // connections being served
+    bool        stopped = false;
+    std::mutex  mtx;
+    explicit UnixSocketListener(const std::string&p):path(p){}
+    ~UnixSocketListener() override;
+    bool        Open();                 // binds path, replacing a stale socket file
+    const char* Name() override {return "unix";}
+    IpcConn*    Accept() override;
+    void        Stop() override;
+};
+IpcConn* UnixSocket_Connect(const char*path);
+#endif
+
+//  SERVER
+// The handler fills the reply, rep.op starting as IPC_OK. It runs on the connection's
+// thread, so calls from different clients can overlap.
+typedef void (*IpcHandler)(void*ctx,const IpcMessage&req,IpcMessage&rep);
+
+struct IpcServer {
+    IpcListener*          listener = nullptr;
+    IpcHandler            handler  = nullptr;
+    void*                 ctx      = nullptr;
+    std::thread           worker;                   // accepts
+    std::thread           conns[IPC_MAX_CONNS];
+    std::atomic<bool>     busy[IPC_MAX_CONNS] = {};
+    std::atomic<bool>     accepting{false};
+    std::atomic<uint64_t> connections{0}, requests{0}, errors{0}, refused{0};
+};
+void Ipc_Start(IpcServer&s,IpcListener*l,IpcHandler h,void*ctx);
+void Ipc_Stop (IpcServer&s);            // stops the listener and joins every thread
+// False once a stopped server has no thread left running, so Ipc_Stop will not block. A
+// thread whose handler waits on the caller can be answered until then.
+bool Ipc_Running(const IpcServer&s);
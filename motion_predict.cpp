@@ -0,0 +1,40 @@
+//  motion_predict.cpp  –  Better Cursor Finder (BCF)
+
+#include "motion_predict.h"
+#include <cmath>
+
+void Predict_Reset(MotionPredictor&p)
+{
+    p.tNs=0; p.x=p.y=0; p.vx=p.vy=0; p.samples=0;
+}
+
+void Predict_Add(MotionPredictor&p,int64_t tNs,float x,float y)
+{
+    if(!p.samples||tNs-p.tNs>p.staleNs){
+        p.tNs=tNs; p.x=x; p.y=y; p.vx=p.vy=0; p.samples=1;
+        return;
+    }
+    int64_t dt=tNs-p.tNs;
+    if(dt<p.minDtNs){
+        // Same instant as the last sample (raw input and the frame's own read): take the
+        // newer position, leave the velocity alone.
+        if(dt>=0){p.x=x;p.y=y;}
+        return;
+    }
+    float ivx=(x-p.x)/(float)dt, ivy=(y-p.y)/(float)dt;
+    float w=1.f-expf(-(float)dt/(float)p.tauNs);
+    if(p.samples==1)w=1.f;
+    p.vx+=w*(ivx-p.vx); p.vy+=w*(ivy-p.vy);
+    p.tNs=tNs; p.x=x; p.y=y; p.samples++;
+}
+
+void Predict_At(const MotionPredictor&p,int64_t tNs,float amount,float&x,float&y)
+{
+    x=p.x; y=p.y;
+    if(p.samples<2||amount<=0)return;
+    int64_t lead=tNs-p.tNs;
+    if(lead<=0||lead>p.staleNs)return;
+    if(lead>p.maxLeadNs)lead=p.maxLeadNs;
+    float k=(float)lead*(amount>1?1:amount);
+    x+=p.vx*k; y+=p.vy*k;
+}
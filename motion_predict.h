@@ -0,0 +1,24 @@
+//  motion_predict.h  –  Better Cursor Finder (BCF)
+//  Constant-velocity pointer predictor: velocity is smoothed with a time-constant EMA over
+//  the reported positions and the last position is extrapolated to the time the frame will
+//  be presented. The lookahead is capped and a pointer that stops reporting is treated as
+//  stopped, so the ring never runs off on stale velocity. No Windows headers.
+#pragma once
+#include <cstdint>
+
+struct MotionPredictor {
+    int64_t tauNs     = 8000000;    // velocity smoothing time constant
+    int64_t maxLeadNs = 30000000;   // longest extrapolation
+    int64_t staleNs   = 30000000;   // no sample for this long: the pointer has stopped
+    int64_t minDtNs   = 250000;     // closer samples update the position only
+
+    int64_t tNs   = 0;              // time of the last sample; 0 before the first
+    float   x = 0, y = 0;
+    float   vx = 0, vy = 0;         // px per ns
+    uint32_t samples = 0;
+};
+
+void Predict_Reset(MotionPredictor&p);
+void Predict_Add  (MotionPredictor&p,int64_t tNs,float x,float y);
+// Position at tNs; amount 0..1 scales the extrapolation (0 = last reported position).
+void Predict_At   (const MotionPredictor&p,int64_t tNs,float amount,float&x,float&y);
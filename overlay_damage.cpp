@@ -0,0 +1,27 @@
+//  overlay_damage.cpp  –  Better Cursor Finder (BCF)
+
+#include "overlay_damage.h"
+
+static IRect Full(int size){IRect f; f.x1=f.y1=size; return f;}
+
+IRect DamageClearRect(const IRect&stale,int size){return IRectIntersect(stale,Full(size));}
+
+IRect DamageUploadRect(const IRect&drawn,int size)
+{
+    IRect u=IRectIntersect(drawn,Full(size));
+    if(IRectEmpty(u)){u.x0=u.y0=size/2; u.x1=u.y1=size/2+1;}
+    return u;
+}
+
+void DamageAccount(DamageStats&s,const IRect&clear,const IRect&upload,int size)
+{
+    s.frames++;
+    s.fullBytes  +=(uint64_t)size*size*4;
+    s.uploadBytes+=(uint64_t)IRectArea(upload)*4;
+    s.clearBytes +=(uint64_t)IRectArea(clear)*4;
+}
+
+double DamageUploadRatio(const DamageStats&s)
+{
+    return s.fullBytes?(double)s.uploadBytes/(double)s.fullBytes:0.0;
+}
@@ -0,0 +1,36 @@
+//  overlay_damage.h  –  Better Cursor Finder (BCF)
+//  Per-frame bounding box and damage bookkeeping for the layered overlay. No Windows headers.
+#pragma once
+#include "ring_raster.h"
+#include <cstdint>
+
+static inline IRect IRectUnion(const IRect&a,const IRect&b){
+    if(IRectEmpty(a))return b;
+    if(IRectEmpty(b))return a;
+    IRect r; r.x0=a.x0<b.x0?a.x0:b.x0; r.y0=a.y0<b.y0?a.y0:b.y0;
+    r.x1=a.x1>b.x1?a.x1:b.x1; r.y1=a.y1>b.y1?a.y1:b.y1; return r;
+}
+static inline IRect IRectIntersect(const IRect&a,const IRect&b){
+    IRect r; r.x0=a.x0>b.x0?a.x0:b.x0; r.y0=a.y0>b.y0?a.y0:b.y0;
+    r.x1=a.x1<b.x1?a.x1:b.x1; r.y1=a.y1<b.y1?a.y1:b.y1;
+    return IRectEmpty(r)?IRect():r;
+}
+
+struct DamageStats {
+    uint64_t frames      = 0;
+    uint64_t fullBytes   = 0;   // what full-surface uploads and clears would have cost
+    uint64_t uploadBytes = 0;
+    uint64_t clearBytes  = 0;
+};
+
+// Part of a back buffer that must be zeroed before it is drawn into again.
+IRect DamageClearRect(const IRect&stale,int size);
+
+// Part of the surface handed to the compositor for a frame that drew `drawn`. An empty
+// frame still uploads one transparent pixel so the window shrinks to nothing.
+IRect DamageUploadRect(const IRect&drawn,int size);
+
+void DamageAccount(DamageStats&s,const IRect&clear,const IRect&upload,int size);
+
+// Share of the full-surface upload bandwidth that was actually spent, 0..1.
+double DamageUploadRatio(const DamageStats&s);
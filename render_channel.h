@@ -0,0 +1,89 @@
+//  render_channel.h  –  Better Cursor Finder (BCF)
+//  What the UI thread hands the render thread: a bounded SPSC queue of commands and the
+//  ring configuration published as immutable snapshots through a triple buffer. Neither
+//  side ever blocks or allocates; waking the render thread is left to the caller.
+//  No Windows headers.
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "spsc_ring.h"
+
+enum RenderCmdType : uint32_t {
+    RC_START,           // begin the locate animation at (x,y)
+    RC_CANCEL,          // stop it now
+    RC_CONFIG,          // a new config snapshot was published; only wakes the render thread
+    RC_CURSOR,          // cursor moved to (x,y) while animating
+    RC_TRAIL,           // cursor moved to (x,y) with trail mode on and nothing animating
+    RC_DUMP,            // write the frame statistics report
+    RC_WARM,            // Ctrl went down: build the spotlight surface ahead of a tap
+    RC_QUIT,
+};
+struct RenderCmd {
+    RenderCmdType type = RC_CONFIG;
+    int32_t       x = 0, y = 0;
+    uint32_t      seq = 0;
+    int64_t       tNs = 0;      // RC_CURSOR, RC_TRAIL: when the position was read
+};
+
+enum LocateMode { LOCATE_RING, LOCATE_SPOTLIGHT };
+
+struct RenderConfig {
+    uint32_t ringColor    = 0x00FFFFFF;     // 0x00BBGGRR
+    uint32_t outlineColor = 0x00000000;
+    int      speed        = 1;
+    bool     moveCancel   = true;
+    int      prediction   = 50;             // % of the lookahead to the present time
+    int      mode         = LOCATE_RING;
+    int      power        = 0;              // PowerSource, tracked by the UI thread
+    bool     trail        = false;          // fading tail behind fast pointer motion
+    bool     autoContrast = false;          // ring colours follow the screen under it
+    int      glowRadius   = 9;              // logical px past the stroke, 0 for no glow
+    int      glowStrength = 45;             // % opacity of the glow at the ring
+    uint32_t version      = 0;              // bumped by every publish
+};
+
+// Triple buffer: the writer fills its private slot and swaps it with the shared middle one,
+// the reader swaps its slot with the middle one when the fresh bit is set. The reader
+// always sees a complete snapshot and never the slot being written.
+template<class T>
+struct SnapshotBuffer {
+    static const uint32_t FRESH = 4;
+    T slots[3];
+    alignas(64) std::atomic<uint32_t> mid{1};
+    alignas(64) uint32_t back  = 0;         // writer only
+    alignas(64) uint32_t front = 2;         // reader only
+
+    T&   Back(){return slots[back];}
+    void Publish(){back=mid.exchange(back|FRESH,std::memory_order_acq_rel)&3;}
+    void Publish(const T&v){slots[back]=v;Publish();}
+    // Moves to the newest snapshot; false when nothing was published since the last call.
+    bool Acquire(){
+        if(!(mid.load(std::memory_order_relaxed)&FRESH))return false;
+        front=mid.exchange(front,std::memory_order_acq_rel)&3;
+        return true;
+    }
+    const T& Front()const{return slots[front];}
+};
+
+struct RenderChannel {
+    SpscRing<RenderCmd,64>       cmds;
+    SnapshotBuffer<RenderConfig> config;
+    uint32_t                     sent      = 0;   // producer only
+    uint32_t                     published = 0;   // producer only
+    std::atomic<uint32_t>        dropped{0};      // commands rejected by a full queue
+};
+
+// Producer side. A full queue drops the command. The render thread acquires the config
+// snapshot on every wake rather than on RC_CONFIG, so a dropped RC_CONFIG only delays it
+// to the next wake (the caller still signals one).
+static inline bool Chan_Send(RenderChannel&c,RenderCmdType type,int32_t x=0,int32_t y=0,int64_t tNs=0){
+    RenderCmd m; m.type=type; m.x=x; m.y=y; m.seq=++c.sent; m.tNs=tNs;
+    if(c.cmds.Push(m))return true;
+    c.dropped.fetch_add(1,std::memory_order_relaxed);
+    return false;
+}
+static inline void Chan_Publish(RenderChannel&c,RenderConfig cfg){
+    static_assert(sizeof(RenderConfig)<=64,"keep snapshots small");
+    cfg.version=++c.published;
+    c.config.Publish(cfg);
+}
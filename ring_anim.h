@@ -0,0 +1,52 @@
+//  ring_anim.h  –  Better Cursor Finder (BCF)
+//  Radius / alpha schedule of the locate animation. No Windows headers.
+#pragma once
+#include <cmath>
+
+static const float ANIM_MAX_R = 88.0f;
+static const float ANIM_MIN_R = 3.0f;
+static const int   ANIM_MOVE_PX = 4;      // pointer travel from the start that cancels the ring
+
+static inline float Clamp01(float v){return v<0?0:v>1?1:v;}
+static inline float EaseOutQuint(float t){return 1.f-powf(1.f-Clamp01(t),5.f);}
+
+// Duration in ms for speed 0=slow 1=normal 2=fast.
+static inline float AnimDurationMs(int speed){switch(speed){case 0:return 1600;case 2:return 560;default:return 1050;}}
+
+static inline bool MovedPastCancel(int dx,int dy){return dx*dx+dy*dy>ANIM_MOVE_PX*ANIM_MOVE_PX;}
+
+struct RingFrame { float r, alpha; bool done; };
+
+// Unscaled radius and alpha at progress 0..1; done once the ring has shrunk past ANIM_MIN_R.
+static inline RingFrame RingFrameAt(float progress)
+{
+    RingFrame f;
+    f.r=ANIM_MAX_R*(1.f-EaseOutQuint(progress));
+    f.done=f.r<ANIM_MIN_R;
+    float a;
+    if(progress<0.06f)a=progress/0.06f;
+    else if(progress<0.72f)a=1.f;
+    else a=1.f-(progress-0.72f)/0.28f;
+    f.alpha=Clamp01(a);
+    return f;
+}
+
+// Spotlight mode: the clear circle closes in on the pointer, holds, and the dimming fades.
+static const float SPOT_MAX_R = 360.0f;
+static const float SPOT_MIN_R = 110.0f;
+
+struct SpotFrame { float r, fade; bool done; };
+
+// Unscaled circle radius and overall opacity 0..1 at progress 0..1.
+static inline SpotFrame SpotFrameAt(float progress)
+{
+    SpotFrame f;
+    f.r=SPOT_MIN_R+(SPOT_MAX_R-SPOT_MIN_R)*(1.f-EaseOutQuint(progress/0.45f));
+    f.done=progress>=1.f;
+    float a;
+    if(progress<0.08f)a=progress/0.08f;
+    else if(progress<0.7f)a=1.f;
+    else a=1.f-(progress-0.7f)/0.3f;
+    f.fade=Clamp01(a);
+    return f;
+}
@@ -0,0 +1,132 @@
+//  ring_atlas.cpp  –  Better Cursor Finder (BCF)
+//  Radius and alpha are both functions of progress, so the reachable keys form a curve
+//  through the (r, alpha) grid; only those keys are baked. Frames are stored as runs of
+//  non-transparent pixels, which skips the empty interior of large rings.
+
+#include "ring_atlas.h"
+#include "ring_anim.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static const int PROGRESS_STEPS = 8192;
+static const int MIN_GAP        = 8;      // transparent runs shorter than this stay inside a span
+
+static int RKey(const RingAtlas&a,float r){return (int)(r/a.rStep+.5f);}
+static int AKey(float alpha){return (int)(Clamp01(alpha)*(ATLAS_A_LEVELS-1)+.5f);}
+
+bool AtlasMatches(const RingAtlas&a,int size,const RingStyle&st)
+{
+    return a.size==size&&a.style.ringColor==st.ringColor&&a.style.outlineColor==st.outlineColor&&
+           a.style.stroke==st.stroke&&a.style.scale==st.scale&&a.style.linear==st.linear&&
+           a.style.glow==st.glow&&a.style.glowAlpha==st.glowAlpha;
+}
+
+static void Capture(RingAtlas&a,const uint32_t*scratch,const IRect&box)
+{
+    AtlasFrame f; f.firstSpan=(uint32_t)a.spans.size(); f.spanCount=0; f.box=box;
+    for(int y=box.y0;y<box.y1;y++){
+        const uint32_t*row=scratch+(size_t)y*a.size;
+        int x=box.x0;
+        while(x<box.x1){
+            while(x<box.x1&&!row[x])x++;
+            if(x>=box.x1)break;
+            int s=x,e=x;
+            for(int gap=0;x<box.x1&&gap<MIN_GAP;x++){
+                if(row[x]){e=x+1;gap=0;} else gap++;
+            }
+            x=e;
+            AtlasSpan sp={y,s,e-s,(uint32_t)a.pixels.size()};
+            a.pixels.insert(a.pixels.end(),row+s,row+e);
+            a.spans.push_back(sp); f.spanCount++;
+        }
+    }
+    a.frames.push_back(f);
+}
+
+static void Drop(RingAtlas&a)
+{
+    std::vector<int>().swap(a.index); std::vector<AtlasFrame>().swap(a.frames);
+    std::vector<AtlasSpan>().swap(a.spans); std::vector<uint32_t>().swap(a.pixels);
+    a.baked=0;
+}
+
+void AtlasBuild(RingAtlas&a,int size,const RingStyle&st)
+{
+    auto t0=std::chrono::steady_clock::now();
+    a.size=size; a.style=st; a.maxR=ANIM_MAX_R*st.scale; a.rStep=ATLAS_R_STEP*st.scale;
+    a.frames.clear(); a.spans.clear(); a.pixels.clear();
+    const int rLevels=RKey(a,a.maxR)+1;
+    a.index.assign((size_t)rLevels*ATLAS_A_LEVELS,-1);
+
+    // Reachable keys and their pixels: each frame is at most the annulus the ring reaches,
+    // which runs about 20% over what the spans store, so only a clear overrun skips the bake.
+    const float reach=RingReach(st), c=size/2.f;
+    std::vector<int> order;
+    double need=0;
+    for(int i=0;i<=PROGRESS_STEPS;i++){
+        RingFrame rf=RingFrameAt((float)i/PROGRESS_STEPS);
+        if(rf.done)break;
+        const int rk=RKey(a,rf.r*st.scale), key=rk*ATLAS_A_LEVELS+AKey(rf.alpha);
+        int&slot=a.index[(size_t)key];
+        if(slot!=-1)continue;
+        slot=-2; order.push_back(key);
+        const float ro=std::min(rk*a.rStep+reach,c), ri=std::max(rk*a.rStep-reach,0.f);
+        need+=3.14159265*(ro*ro-ri*ri)*sizeof(uint32_t);
+    }
+    a.keys=(int)order.size(); a.needBytes=(size_t)need; a.baked=0;
+    if(a.needBytes>ATLAS_MAX_BYTES/4*5)Drop(a);
+    else{
+        std::vector<uint32_t> scratch((size_t)size*size,0);
+        for(int key:order){
+            const int rk=key/ATLAS_A_LEVELS, ak=key%ATLAS_A_LEVELS;
+            a.index[(size_t)key]=(int)a.frames.size();
+            IRect box=RasterRing(scratch.data(),size,size,size,c,c,rk*a.rStep,(float)ak/(ATLAS_A_LEVELS-1),st);
+            Capture(a,scratch.data(),box);
+            for(int y=box.y0;y<box.y1;y++)
+                memset(scratch.data()+(size_t)y*size+box.x0,0,(size_t)(box.x1-box.x0)*4);
+            a.baked++;
+            if(a.pixels.size()*sizeof(uint32_t)>ATLAS_MAX_BYTES){Drop(a);break;}
+        }
+    }
+    a.frames.shrink_to_fit(); a.spans.shrink_to_fit(); a.pixels.shrink_to_fit();
+    a.bytes=a.index.capacity()*sizeof(int)+a.frames.capacity()*sizeof(AtlasFrame)+
+            a.spans.capacity()*sizeof(AtlasSpan)+a.pixels.capacity()*sizeof(uint32_t);
+    a.buildMs=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+}
+
+const AtlasFrame* AtlasLookup(const RingAtlas&a,float r,float alpha)
+{
+    if(a.index.empty()||r<0||r>a.maxR+a.rStep)return nullptr;
+    size_t k=(size_t)RKey(a,r)*ATLAS_A_LEVELS+AKey(alpha);
+    if(k>=a.index.size()||a.index[k]<0)return nullptr;
+    return &a.frames[a.index[k]];
+}
+
+const AtlasFrame* AtlasLookupNear(const RingAtlas&a,float r,float alpha)
+{
+    if(a.index.empty())return nullptr;
+    const int rLevels=(int)(a.index.size()/ATLAS_A_LEVELS);
+    const int rk=std::min(std::max(RKey(a,r),0),rLevels-1), ak=AKey(alpha);
+    for(int d=0;d<=ATLAS_NEAR_STEPS;d++)
+        for(int s=0;s<(d?2:1);s++){
+            int k=s?rk+d:rk-d;
+            if(k<0||k>=rLevels)continue;
+            for(int da=0;da<=2;da++)
+                for(int sa=0;sa<(da?2:1);sa++){
+                    int j=sa?ak+da:ak-da;
+                    if(j<0||j>=ATLAS_A_LEVELS)continue;
+                    int i=a.index[(size_t)k*ATLAS_A_LEVELS+j];
+                    if(i>=0)return &a.frames[i];
+                }
+        }
+    return nullptr;
+}
+
+IRect AtlasBlit(const RingAtlas&a,const AtlasFrame&f,uint32_t*bits,int stride)
+{
+    const AtlasSpan*sp=a.spans.data()+f.firstSpan;
+    for(uint32_t i=0;i<f.spanCount;i++,sp++)
+        memcpy(bits+(size_t)sp->y*stride+sp->x0,a.pixels.data()+sp->off,(size_t)sp->len*4);
+    return f.box;
+}
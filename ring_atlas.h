@@ -0,0 +1,50 @@
+//  ring_atlas.h  –  Better Cursor Finder (BCF)
+//  Pre-baked ring frames keyed by quantized radius and alpha, so animation playback is a
+//  handful of span memcpys instead of a rasterization. No Windows headers.
+#pragma once
+#include "ring_raster.h"
+#include <cstddef>
+#include <vector>
+
+static const float  ATLAS_R_STEP    = 0.25f;          // logical px, multiplied by the style scale
+static const int    ATLAS_A_LEVELS  = 64;
+static const size_t ATLAS_MAX_BYTES = 48u<<20;        // an animation that needs more is not baked
+static const int    ATLAS_NEAR_STEPS = 1;             // radius steps AtlasLookupNear may stray
+
+struct AtlasSpan  { int y, x0, len; uint32_t off; };
+struct AtlasFrame { uint32_t firstSpan, spanCount; IRect box; };
+
+struct RingAtlas {
+    int        size   = 0;                  // baked for a size x size surface, ring centred
+    RingStyle  style;
+    float      maxR   = 0;
+    float      rStep  = ATLAS_R_STEP;
+    std::vector<int>        index;          // key -> frame, -1 when the schedule never hits it
+    std::vector<AtlasFrame> frames;
+    std::vector<AtlasSpan>  spans;
+    std::vector<uint32_t>   pixels;
+    size_t     bytes   = 0;                 // heap footprint of the tables above
+    double     buildMs = 0;
+    int        keys    = 0;                 // keys the schedule reaches
+    int        baked   = 0;                 // keys held: all of them, or none when over budget
+    size_t     needBytes = 0;               // pixel bytes the whole animation takes, estimated
+};
+
+// Bakes every (radius, alpha) key the RingFrameAt schedule can reach, scaled by st.scale.
+// A partial atlas would drop the end of the animation (the bake runs largest rings first),
+// so when the pixels would exceed ATLAS_MAX_BYTES nothing is baked and every frame is
+// rasterized live; the estimate is checked before baking and the real size while baking.
+void AtlasBuild(RingAtlas&a,int size,const RingStyle&st);
+bool AtlasMatches(const RingAtlas&a,int size,const RingStyle&st);
+
+static inline bool AtlasComplete(const RingAtlas&a){return a.keys&&a.baked==a.keys;}
+
+// Frame for a scaled radius and alpha, or nullptr when that key was not baked.
+const AtlasFrame* AtlasLookup(const RingAtlas&a,float r,float alpha);
+// The baked frame nearest in radius, at most ATLAS_NEAR_STEPS away, within a couple of
+// alpha levels, for when live rasterization is not affordable; nullptr when nothing is that
+// near, and the caller rasterizes.
+const AtlasFrame* AtlasLookupNear(const RingAtlas&a,float r,float alpha);
+
+// Copies the frame's spans into a cleared surface of the baked size; returns the frame box.
+IRect AtlasBlit(const RingAtlas&a,const AtlasFrame&f,uint32_t*bits,int stride);
@@ -0,0 +1,41 @@
+//  ring_raster.h  –  Better Cursor Finder (BCF)
+//  Single-pass signed-distance rasterizer for the locate ring. No Windows headers.
+#pragma once
+#include <cstdint>
+
+//  RECT  (half-open, pixels)
+struct IRect { int x0=0, y0=0, x1=0, y1=0; };
+static inline bool IRectEmpty(const IRect&r){return r.x1<=r.x0||r.y1<=r.y0;}
+static inline int  IRectArea (const IRect&r){return IRectEmpty(r)?0:(r.x1-r.x0)*(r.y1-r.y0);}
+
+//  STYLE
+struct RingStyle {
+    uint32_t ringColor    = 0x00FFFFFF;   // COLORREF layout, 0x00BBGGRR
+    uint32_t outlineColor = 0x00000000;
+    float    stroke       = 2.5f;
+    float    scale        = 1.f;          // DPI scale applied to every stroke width
+    bool     linear       = true;         // mix the two colours in linear light, not in sRGB
+    float    glow         = 9.f;          // logical px the glow reaches past the stroke, 0 for none
+    float    glowAlpha    = .45f;         // glow opacity where it is densest, at the ring
+};
+
+enum RasterPath { RP_AUTO, RP_SCALAR, RP_SSE2, RP_AVX2 };
+
+RasterPath  RasterBestPath();
+const char* RasterPathName(RasterPath p);
+
+// Farthest any layer (glow included) reaches beyond the ring radius, AA fringe included.
+float RingReach(const RingStyle&st);
+
+// Draws the glow, outline, ring and inner outline centred at (cx,cy) into premultiplied
+// BGRA bits (stride in pixels). Only the row spans the ring covers are written; the
+// returned rect bounds them and everything outside it is left for the caller to clear.
+IRect RasterRing(uint32_t*bits,int w,int h,int stride,float cx,float cy,float r,float alpha,
+                 const RingStyle&st,RasterPath path=RP_AUTO);
+// Reference value of one pixel in double precision, with the exact sRGB functions on the
+// linear path, for tests and benchmarks. The glow comes from the same cached profile.
+uint32_t RingPixel(int x,int y,float cx,float cy,float r,float alpha,const RingStyle&st);
+
+// Glow profiles are blurred the first time a radius bucket is drawn; this builds every
+// bucket up to radius maxR (surface px) ahead of time and returns how many were new.
+int RingGlowWarm(const RingStyle&st,float maxR);
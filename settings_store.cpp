@@ -0,0 +1,189 @@
+//  settings_store.cpp  –  Better Cursor Finder (BCF)
+//  Clicks submit a full snapshot; the worker writes the newest one once submissions have
+//  been quiet for the debounce interval, so a burst of toggles costs one write.
+
+#include "settings_store.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+  #include <io.h>
+#else
+  #include <unistd.h>
+  #include <sys/stat.h>
+#endif
+
+//  VALUES
+static int Find(const SettingsValues&s,const char*name)
+{
+    for(int i=0;i<s.count;i++)if(!strcmp(s.v[i].name,name))return i;
+    return -1;
+}
+bool Settings_Get(const SettingsValues&s,const char*name,uint32_t&out)
+{
+    int i=Find(s,name); if(i<0)return false;
+    out=s.v[i].value; return true;
+}
+void Settings_Set(SettingsValues&s,const char*name,uint32_t value)
+{
+    int i=Find(s,name);
+    if(i<0){
+        if(s.count>=SETTINGS_MAX||strlen(name)>=sizeof(s.v[0].name))return;
+        i=s.count++; strcpy(s.v[i].name,name);
+    }
+    s.v[i].value=value;
+}
+bool Settings_Equal(const SettingsValues&a,const SettingsValues&b)
+{
+    if(a.count!=b.count)return false;
+    for(int i=0;i<a.count;i++){
+        uint32_t v; if(!Settings_Get(b,a.v[i].name,v)||v!=a.v[i].value)return false;
+    }
+    return true;
+}
+
+void Settings_AddMissing(SettingsValues&s,const SettingsValues&from)
+{
+    for(int i=0;i<from.count;i++)if(Find(s,from.v[i].name)<0)Settings_Set(s,from.v[i].name,from.v[i].value);
+}
+
+std::string Settings_ToIni(const SettingsValues&s)
+{
+    std::string out="; Better Cursor Finder settings\n[BCF]\n";
+    char line[64];
+    snprintf(line,sizeof(line),"Version=%d\n",SETTINGS_VERSION); out+=line;
+    for(int i=0;i<s.count;i++){snprintf(line,sizeof(line),"%s=0x%08X\n",s.v[i].name,(unsigned)s.v[i].value);out+=line;}
+    return out;
+}
+
+bool Settings_FromIni(const char*text,SettingsValues&s)
+{
+    bool inSection=false, sawVersion=false;
+    for(const char*p=text;*p;){
+        const char*e=p; while(*e&&*e!='\n')e++;
+        const char*a=p,*b=e;
+        while(a<b&&(*a==' '||*a=='\t'))a++;
+        while(b>a&&(b[-1]=='\r'||b[-1]==' '||b[-1]=='\t'))b--;
+        p=*e?e+1:e;
+        if(a==b||*a==';'||*a=='#')continue;
+        if(*a=='['){inSection=(b-a==5&&!strncmp(a,"[BCF]",5));continue;}
+        if(!inSection)continue;
+        const char*eq=a; while(eq<b&&*eq!='=')eq++;
+        if(eq==b)continue;
+        const char*ke=eq; while(ke>a&&(ke[-1]==' '||ke[-1]=='\t'))ke--;
+        char key[32],val[32];
+        size_t kl=(size_t)(ke-a), vl=(size_t)(b-eq-1);
+        if(!kl||kl>=sizeof(key)||vl>=sizeof(val))continue;
+        memcpy(key,a,kl); key[kl]=0; memcpy(val,eq+1,vl); val[vl]=0;
+        char*end; unsigned long v=strtoul(val,&end,0);
+        if(end==val)continue;
+        if(!strcmp(key,"Version")){sawVersion=true;continue;}
+        Settings_Set(s,key,(uint32_t)v);
+    }
+    return sawVersion;
+}
+
+//  INI FILE
+bool FileExists(const std::string&path)
+{
+#if defined(_WIN32)
+    DWORD a=GetFileAttributesA(path.c_str());
+    return a!=INVALID_FILE_ATTRIBUTES&&!(a&FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat st; return stat(path.c_str(),&st)==0&&S_ISREG(st.st_mode);
+#endif
+}
+
+bool IniFileBackend::Load(SettingsValues&s)
+{
+    FILE*f=fopen(path.c_str(),"rb"); if(!f)return false;
+    std::string text; char buf[1024]; size_t n;
+    while((n=fread(buf,1,sizeof(buf),f))>0)text.append(buf,n);
+    fclose(f);
+    return Settings_FromIni(text.c_str(),s);
+}
+
+bool IniFileBackend::Save(const SettingsValues&s)
+{
+    const std::string text=Settings_ToIni(s), tmp=path+".tmp";
+    FILE*f=fopen(tmp.c_str(),"wb"); if(!f)return false;
+    bool ok=fwrite(text.data(),1,text.size(),f)==text.size()&&fflush(f)==0;
+#if defined(_WIN32)
+    ok=ok&&_commit(_fileno(f))==0;
+#else
+    ok=ok&&fsync(fileno(f))==0;
+#endif
+    ok=fclose(f)==0&&ok;
+    if(!ok){remove(tmp.c_str());return false;}
+#if defined(_WIN32)
+    return MoveFileExA(tmp.c_str(),path.c_str(),MOVEFILE_REPLACE_EXISTING|MOVEFILE_WRITE_THROUGH)!=0;
+#else
+    return rename(tmp.c_str(),path.c_str())==0;
+#endif
+}
+
+//  STORE
+static void Worker(SettingsStore*st)
+{
+    std::unique_lock<std::mutex> lk(st->mtx);
+    for(;;){
+        st->cv.wait(lk,[&]{return st->dirty||st->stopping;});
+        if(!st->dirty)return;
+        // Keep pushing the deadline back while submits keep coming.
+        while(!st->stopping&&st->cv.wait_until(lk,st->due)!=std::cv_status::timeout){}
+        if(!st->stopping&&std::chrono::steady_clock::now()<st->due)continue;
+        SettingsValues snap=st->pending; st->dirty=false;
+        st->inflight=snap; st->saving=true;
+        lk.unlock();
+        bool ok=st->backend->Save(snap);
+        lk.lock();
+        st->saving=false;
+        if(ok){st->saved=snap;st->writes++;}
+        else{
+            st->failures++;
+            if(!st->dirty&&!st->stopping){
+                st->pending=snap; st->dirty=true;
+                st->due=std::chrono::steady_clock::now()+std::chrono::milliseconds(st->debounceMs);
+            }
+        }
+        st->cv.notify_all();
+    }
+}
+
+void Store_Start(SettingsStore&st,SettingsBackend*backend,const SettingsValues&saved,int debounceMs)
+{
+    st.backend=backend; st.saved=saved; st.debounceMs=debounceMs;
+    st.dirty=st.saving=st.stopping=false;
+    st.worker=std::thread(Worker,&st);
+}
+
+void Store_Submit(SettingsStore&st,const SettingsValues&s)
+{
+    std::lock_guard<std::mutex> lk(st.mtx);
+    st.submits++;
+    // While a save runs the backend is about to hold `inflight`, not `saved`.
+    if(!st.dirty&&Settings_Equal(s,st.saving?st.inflight:st.saved))return;
+    st.pending=s; st.dirty=true;
+    st.due=std::chrono::steady_clock::now()+std::chrono::milliseconds(st.debounceMs);
+    st.cv.notify_all();
+}
+
+void Store_Flush(SettingsStore&st)
+{
+    std::unique_lock<std::mutex> lk(st.mtx);
+    if(!st.worker.joinable())return;
+    const uint64_t failures=st.failures;
+    st.due=std::chrono::steady_clock::now();
+    st.cv.notify_all();
+    st.cv.wait(lk,[&]{return (!st.dirty&&!st.saving)||st.failures!=failures;});
+}
+
+void Store_Stop(SettingsStore&st)
+{
+    if(!st.worker.joinable())return;
+    {std::lock_guard<std::mutex> lk(st.mtx); st.stopping=true; st.cv.notify_all();}
+    st.worker.join();
+}
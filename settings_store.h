@@ -0,0 +1,77 @@
+//  settings_store.h  –  Better Cursor Finder (BCF)
+//  Named 32-bit settings values, pluggable backends and a debounced background writer.
+//  The INI file backend is portable; the registry backend lives in cursor_ring.cpp.
+//  No Windows headers.
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+static const int SETTINGS_VERSION = 1;
+static const int SETTINGS_MAX     = 32;
+
+//  VALUES
+struct SettingValue   { char name[24]; uint32_t value; };
+struct SettingsValues { int count = 0; SettingValue v[SETTINGS_MAX]; };
+
+bool Settings_Get  (const SettingsValues&s,const char*name,uint32_t&out);
+void Settings_Set  (SettingsValues&s,const char*name,uint32_t value);
+bool Settings_Equal(const SettingsValues&a,const SettingsValues&b);
+void Settings_AddMissing(SettingsValues&s,const SettingsValues&from);   // from's names s lacks
+
+// "[BCF]" section with Version= and one Name=0x... line per value. Keys this version does
+// not know are kept as values, so an app that saves them back with Settings_AddMissing
+// leaves a newer version's settings in a shared file alone; other sections are skipped and
+// not written back.
+std::string Settings_ToIni(const SettingsValues&s);
+bool        Settings_FromIni(const char*text,SettingsValues&s);
+
+//  BACKENDS
+struct SettingsBackend {
+    virtual ~SettingsBackend(){}
+    virtual const char* Name()=0;
+    virtual bool Load(SettingsValues&s)=0;
+    virtual bool Save(const SettingsValues&s)=0;     // called from the store's worker
+};
+
+// Writes to path.tmp, flushes it to disk, then renames over path, so a crash leaves either
+// the old or the new file and never a torn one.
+struct IniFileBackend : SettingsBackend {
+    std::string path;
+    explicit IniFileBackend(const std::string&p):path(p){}
+    const char* Name() override {return "ini";}
+    bool Load(SettingsValues&s) override;
+    bool Save(const SettingsValues&s) override;
+};
+bool FileExists(const std::string&path);
+
+//  STORE
+struct SettingsStore {
+    SettingsBackend*        backend    = nullptr;
+    int                     debounceMs = 400;
+    std::thread             worker;
+    std::mutex              mtx;
+    std::condition_variable cv;
+    SettingsValues          pending, saved;
+    SettingsValues          inflight;             // what the worker is writing while `saving`
+    bool                    dirty      = false;
+    bool                    saving     = false;
+    bool                    stopping   = false;
+    std::chrono::steady_clock::time_point due;
+    uint64_t                submits    = 0;       // Store_Submit calls
+    uint64_t                writes     = 0;       // backend saves actually issued
+    uint64_t                failures   = 0;
+};
+
+// `saved` is what the backend already holds (normally the loaded values); submits equal to
+// it, or to the values being written at the time, are dropped without a write. A failed save
+// is retried after another debounce unless newer values replaced it.
+void Store_Start (SettingsStore&st,SettingsBackend*backend,const SettingsValues&saved,int debounceMs);
+void Store_Submit(SettingsStore&st,const SettingsValues&s);
+// Writes anything pending now and waits until it and any save in progress are done, or
+// until a save fails.
+void Store_Flush (SettingsStore&st);
+void Store_Stop  (SettingsStore&st);              // flush, then join the worker
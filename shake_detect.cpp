@@ -0,0 +1,74 @@
+//  shake_detect.cpp  –  Better Cursor Finder (BCF)
+//  A stroke ends when the pointer is turnPx back from F and heading away from it at more
+//  than 90 degrees to S->F. Strokes are judged once, as they end; the run only keeps the
+//  qualifying ones, so the trigger check looks at a fixed number of entries.
+
+#include "shake_detect.h"
+#include <algorithm>
+#include <cmath>
+
+void Shake_Reset(ShakeDetector&d)
+{
+    ShakePolicy pol=d.pol; ShakeStats st=d.stats;
+    d=ShakeDetector(); d.pol=pol; d.stats=st;
+}
+
+static void Restart(ShakeDetector&d,int64_t t,float x,float y)
+{
+    d.tS=d.tF=d.tP=t; d.sx=d.fx=d.px=x; d.sy=d.fy=d.py=y; d.path=d.pathF=0;
+}
+
+static inline const ShakeStroke&Back(const ShakeDetector&d,int i){return d.run[(d.head-1-i+SHAKE_CAP)%SHAKE_CAP];}
+
+// Judges the stroke S->F; true when it completes a shake.
+static bool EndStroke(ShakeDetector&d)
+{
+    const ShakePolicy&p=d.pol;
+    ShakeStroke s; s.t0=d.tS; s.t1=d.tF; s.dx=d.fx-d.sx; s.dy=d.fy-d.sy;
+    s.amp=sqrtf(s.dx*s.dx+s.dy*s.dy); s.mx=(d.sx+d.fx)*0.5f; s.my=(d.sy+d.fy)*0.5f;
+    d.stats.strokes++;
+    const float dur=(float)(s.t1-s.t0)*1e-9f;
+    bool ok=s.amp>=p.minAmp*p.scale&&s.amp<=p.maxAmp*p.scale&&s.t1-s.t0<=p.maxStrokeNs&&dur>0&&
+            s.amp/dur>=p.minSpeed*p.scale&&d.pathF<=p.maxBend*s.amp;
+    if(!ok){d.len=0;return false;}
+    // One that does not turn back along the run's last stroke, at a similar length, can still
+    // start a new run.
+    if(d.len){
+        const ShakeStroke&q=Back(d,0);
+        if(q.t1!=s.t0||s.dx*q.dx+s.dy*q.dy>-p.minOppose*s.amp*q.amp||
+           std::max(s.amp,q.amp)>p.maxAmpRatio*std::min(s.amp,q.amp))d.len=0;
+    }
+    d.run[d.head]=s; d.head=(d.head+1)%SHAKE_CAP; d.len=std::min(d.len+1,SHAKE_CAP);
+    if(d.len<p.strokes)return false;
+
+    const ShakeStroke&first=Back(d,p.strokes-1);
+    if(s.t1-first.t0>p.windowNs)return false;
+    if(s.t1-d.lastTrigger<p.cooldownNs&&d.lastTrigger)return false;
+    float sum=0; for(int i=0;i<p.strokes;i++)sum+=Back(d,i).amp;
+    const float ddx=s.mx-first.mx, ddy=s.my-first.my;
+    if(sqrtf(ddx*ddx+ddy*ddy)>p.maxDrift*sum/p.strokes)return false;
+    d.lastTrigger=s.t1; d.len=0; d.stats.triggers++;
+    return true;
+}
+
+bool Shake_Add(ShakeDetector&d,int64_t tNs,float x,float y)
+{
+    d.stats.samples++;
+    if(!d.tP||tNs-d.tP>d.pol.gapNs||tNs<d.tP){d.len=0;Restart(d,tNs,x,y);return false;}
+    const float mx=x-d.px, my=y-d.py, m2=mx*mx+my*my, step=d.pol.pathStep*d.pol.scale;
+    if(m2>=step*step){d.path+=sqrtf(m2);d.px=x;d.py=y;}
+    d.tP=tNs;
+
+    const float ax=d.fx-d.sx, ay=d.fy-d.sy, bx=x-d.fx, by=y-d.fy;
+    const float sf2=ax*ax+ay*ay, sp2=(x-d.sx)*(x-d.sx)+(y-d.sy)*(y-d.sy);
+    if(sp2>=sf2){d.fx=x;d.fy=y;d.tF=tNs;d.pathF=d.path;return false;}
+    const float turn=d.pol.turnPx*d.pol.scale;
+    if(bx*bx+by*by<turn*turn||ax*bx+ay*by>=0)return false;
+
+    const bool shake=EndStroke(d);
+    // The next stroke starts at F; what was travelled since F already belongs to it.
+    const float back=d.path-d.pathF;
+    d.sx=d.fx; d.sy=d.fy; d.tS=d.tF;
+    d.fx=x; d.fy=y; d.tF=tNs; d.path=d.pathF=back;
+    return shake;
+}
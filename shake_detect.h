@@ -0,0 +1,50 @@
+//  shake_detect.h  –  Better Cursor Finder (BCF)
+//  Shake-to-find: a streaming detector over pointer reports. Motion is cut into strokes at
+//  each reversal (the pointer travels back from its farthest point); a shake is a run of
+//  short, fast, straight strokes, each roughly opposite the one before, that stays in place.
+//  Every report costs O(1) with no allocation, and an idle pointer sends no reports at all.
+//  No Windows headers.
+#pragma once
+#include <cstdint>
+
+static const int SHAKE_CAP = 8;                 // strokes kept; ShakePolicy::strokes <= SHAKE_CAP
+
+struct ShakePolicy {
+    float   minAmp      = 30.f;                 // logical px a stroke must cover
+    float   maxAmp      = 420.f;                // longer strokes are ordinary movement
+    float   minSpeed    = 300.f;                // logical px/s, mean over a stroke
+    float   turnPx      = 10.f;                 // travel back from the farthest point that ends a stroke
+    float   maxBend     = 1.35f;                // stroke path length / amplitude; circles are ~1.57
+    float   pathStep    = 3.f;                  // path is summed over moves this long, so jitter at
+                                                // high report rates does not add up to a bend
+    float   minOppose   = 0.9f;                 // -cos of the angle between consecutive strokes
+    float   maxAmpRatio = 1.6f;                  // ... and the longer of the two / the shorter
+    float   maxDrift    = 0.75f;                // run's midpoint travel / mean amplitude
+    int     strokes     = 4;                    // consecutive strokes (three reversals) to trigger
+    int64_t windowNs    = 1000000000;           // ... all within this window
+    int64_t maxStrokeNs = 320000000;            // slower strokes break a run
+    int64_t gapNs       = 100000000;            // no report for this long starts over
+    int64_t cooldownNs  = 1500000000;           // after a trigger
+    float   scale       = 1.f;                  // DPI scale applied to the px thresholds
+};
+
+struct ShakeStroke { int64_t t0 = 0, t1 = 0; float dx = 0, dy = 0, amp = 0, mx = 0, my = 0; };
+
+struct ShakeStats { uint64_t samples = 0, strokes = 0, triggers = 0; };
+
+struct ShakeDetector {
+    ShakePolicy pol;
+    // Stroke in progress: start S, farthest point F so far, last path point P.
+    int64_t     tS = 0, tF = 0, tP = 0;         // tP: last report, 0 before the first
+    float       sx = 0, sy = 0, fx = 0, fy = 0, px = 0, py = 0;
+    float       path = 0, pathF = 0;            // travelled since S, in total and up to F
+    // The current run of strokes that qualify, newest at head-1.
+    ShakeStroke run[SHAKE_CAP];
+    int         head = 0, len = 0;
+    int64_t     lastTrigger = 0;
+    ShakeStats  stats;
+};
+
+void Shake_Reset(ShakeDetector&d);
+// Feeds one report; true when it completes a shake.
+bool Shake_Add  (ShakeDetector&d,int64_t tNs,float x,float y);
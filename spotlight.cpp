@@ -0,0 +1,125 @@
+//  spotlight.cpp  –  Better Cursor Finder (BCF)
+//  Coverage is a smoothstep over the feather, quantized to the dim alpha's levels and looked
+//  up as a premultiplied pixel, so uniform tiles are plain fills and the per-pixel path only
+//  runs inside the feather band.
+
+#include "spotlight.h"
+#include "overlay_damage.h"
+#include <algorithm>
+#include <cmath>
+
+static inline float Feather(const SpotTiles&t){return std::max(1.f,t.style.feather*t.style.scale);}
+
+static inline uint32_t PixelAt(const SpotTiles&t,float dx,float dy,float inner,float invF)
+{
+    float s=(sqrtf(dx*dx+dy*dy)-inner)*invF;
+    if(s<=0)return t.lut[0];
+    if(s>=1)return t.lut[t.levels];
+    s=s*s*(3.f-2.f*s);
+    return t.lut[(int)(s*(float)t.levels+0.5f)];
+}
+
+static void Fill(uint32_t*bits,int stride,const IRect&r,uint32_t v)
+{
+    for(int y=r.y0;y<r.y1;y++){
+        uint32_t*row=bits+(size_t)y*stride;
+        std::fill(row+r.x0,row+r.x1,v);
+    }
+}
+
+void Spot_Init(SpotTiles&t,int w,int h,const SpotStyle&st,uint32_t*bits,int stride)
+{
+    t.w=w; t.h=h; t.style=st;
+    t.cols=(w+SPOT_TILE-1)/SPOT_TILE; t.rows=(h+SPOT_TILE-1)/SPOT_TILE;
+    t.cls.assign((size_t)t.cols*t.rows,TILE_DIM);
+    t.levels=std::min(255,std::max(1,(int)lroundf(st.dimAlpha*255.f)));
+    uint32_t b=st.dimColor>>16&255, g=st.dimColor>>8&255, r=st.dimColor&255;
+    for(int a=0;a<256;a++)
+        t.lut[a]=(uint32_t)a<<24|(r*a+127)/255<<16|(g*a+127)/255<<8|(b*a+127)/255;
+    t.haveLast=false; t.stats=SpotStats();
+    IRect all; all.x1=w; all.y1=h;
+    Fill(bits,stride,all,t.lut[t.levels]);
+}
+
+void Spot_Raster(const SpotTiles&t,uint32_t*bits,int stride,const IRect&box,const SpotCircle&c)
+{
+    const float f=Feather(t), inner=c.r-f*0.5f, outer=c.r+f*0.5f, invF=1.f/f;
+    const uint32_t dim=t.lut[t.levels], clear=t.lut[0];
+    for(int y=box.y0;y<box.y1;y++){
+        uint32_t*row=bits+(size_t)y*stride;
+        const float dy=(float)y+0.5f-c.cy, dy2=dy*dy;
+        if(dy2>=outer*outer){std::fill(row+box.x0,row+box.x1,dim);continue;}
+        // Pixels outside [lo,hi) are past the outer edge, inside [ilo,ihi) within the inner.
+        const float so=sqrtf(outer*outer-dy2);
+        int lo=std::max(box.x0,(int)floorf(c.cx-so-0.5f)), hi=std::min(box.x1,(int)ceilf(c.cx+so-0.5f)+1);
+        lo=std::min(lo,box.x1); hi=std::max(hi,lo);
+        int ilo=hi, ihi=hi;
+        if(inner>0&&dy2<inner*inner){
+            const float si=sqrtf(inner*inner-dy2);
+            ilo=std::max(lo,(int)ceilf(c.cx-si-0.5f)); ihi=std::min(hi,(int)floorf(c.cx+si-0.5f)+1);
+            if(ihi<ilo)ilo=ihi=hi;
+        }
+        if(lo>box.x0)std::fill(row+box.x0,row+lo,dim);
+        for(int x=lo;x<ilo;x++)row[x]=PixelAt(t,(float)x+0.5f-c.cx,dy,inner,invF);
+        if(ihi>ilo)std::fill(row+ilo,row+ihi,clear);
+        for(int x=std::max(ihi,lo);x<hi;x++)row[x]=PixelAt(t,(float)x+0.5f-c.cx,dy,inner,invF);
+        if(hi<box.x1)std::fill(row+std::max(hi,box.x0),row+box.x1,dim);
+    }
+}
+
+uint32_t Spot_Pixel(const SpotTiles&t,int x,int y,const SpotCircle&c)
+{
+    const float f=Feather(t);
+    return PixelAt(t,(float)x+0.5f-c.cx,(float)y+0.5f-c.cy,c.r-f*0.5f,1.f/f);
+}
+
+// Tile class from the nearest and farthest pixel centres.
+static SpotTileClass Classify(const IRect&r,const SpotCircle&c,float inner,float outer)
+{
+    float nx=std::max(0.f,std::max((float)r.x0+0.5f-c.cx,c.cx-((float)r.x1-0.5f)));
+    float ny=std::max(0.f,std::max((float)r.y0+0.5f-c.cy,c.cy-((float)r.y1-0.5f)));
+    if(nx*nx+ny*ny>=outer*outer)return TILE_DIM;
+    float fx=std::max(fabsf((float)r.x0+0.5f-c.cx),fabsf((float)r.x1-0.5f-c.cx));
+    float fy=std::max(fabsf((float)r.y0+0.5f-c.cy),fabsf((float)r.y1-0.5f-c.cy));
+    if(inner>0&&fx*fx+fy*fy<=inner*inner)return TILE_CLEAR;
+    return TILE_EDGE;
+}
+
+static IRect CircleBox(const SpotCircle&c,float outer)
+{
+    IRect b;
+    b.x0=(int)floorf(c.cx-outer)-1; b.y0=(int)floorf(c.cy-outer)-1;
+    b.x1=(int)ceilf(c.cx+outer)+1;  b.y1=(int)ceilf(c.cy+outer)+1;
+    return b;
+}
+
+IRect Spot_Update(SpotTiles&t,uint32_t*bits,int stride,const SpotCircle&c)
+{
+    t.stats.frames++;
+    t.stats.fullBytes+=(uint64_t)t.w*t.h*4;
+    if(t.haveLast&&t.last.cx==c.cx&&t.last.cy==c.cy&&t.last.r==c.r)return IRect();
+
+    const float f=Feather(t), inner=c.r-f*0.5f, outer=c.r+f*0.5f;
+    // Tiles outside both circles' boxes are dim before and after.
+    IRect area=CircleBox(c,outer);
+    if(t.haveLast)area=IRectUnion(area,CircleBox(t.last,t.last.r+f*0.5f));
+    const int tx0=std::max(0,area.x0/SPOT_TILE), ty0=std::max(0,area.y0/SPOT_TILE);
+    const int tx1=std::min(t.cols,(std::max(0,area.x1)+SPOT_TILE-1)/SPOT_TILE);
+    const int ty1=std::min(t.rows,(std::max(0,area.y1)+SPOT_TILE-1)/SPOT_TILE);
+
+    IRect dirty;
+    for(int ty=ty0;ty<ty1;ty++)
+        for(int tx=tx0;tx<tx1;tx++){
+            IRect r; r.x0=tx*SPOT_TILE; r.y0=ty*SPOT_TILE;
+            r.x1=std::min(t.w,r.x0+SPOT_TILE); r.y1=std::min(t.h,r.y0+SPOT_TILE);
+            uint8_t&held=t.cls[(size_t)ty*t.cols+tx];
+            SpotTileClass k=Classify(r,c,inner,outer);
+            if(k==TILE_EDGE){Spot_Raster(t,bits,stride,r,c);t.stats.rastered++;}
+            else if(k!=held){Fill(bits,stride,r,k==TILE_CLEAR?t.lut[0]:t.lut[t.levels]);t.stats.filled++;}
+            else continue;
+            held=(uint8_t)k; dirty=IRectUnion(dirty,r);
+        }
+    t.last=c; t.haveLast=true;
+    t.stats.uploadBytes+=(uint64_t)IRectArea(dirty)*4;
+    return dirty;
+}
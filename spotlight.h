@@ -0,0 +1,54 @@
+//  spotlight.h  –  Better Cursor Finder (BCF)
+//  Spotlight locate mode: the whole virtual desktop dimmed except a soft circle around the
+//  pointer. The surface is split into tiles that are either uniformly dim, uniformly clear
+//  or crossed by the circle's feathered edge. The surface is filled once; each frame only
+//  tiles crossed by the old or new edge are re-rasterized and tiles that changed class are
+//  refilled, and the returned rect bounds what the compositor has to be sent.
+//  No Windows headers.
+#pragma once
+#include "ring_raster.h"
+#include <cstdint>
+#include <vector>
+
+static const int SPOT_TILE = 64;
+
+struct SpotStyle {
+    uint32_t dimColor = 0x00000000;     // COLORREF layout, 0x00BBGGRR
+    float    dimAlpha = 0.62f;
+    float    feather  = 28.f;           // logical px from clear to fully dim
+    float    scale    = 1.f;            // DPI scale applied to the feather
+};
+
+struct SpotCircle { float cx = 0, cy = 0, r = 0; };      // surface pixels
+
+enum SpotTileClass : uint8_t { TILE_DIM, TILE_CLEAR, TILE_EDGE };
+
+struct SpotStats {
+    uint64_t frames      = 0;
+    uint64_t rastered    = 0;           // edge tiles re-rasterized
+    uint64_t filled      = 0;           // tiles refilled with a uniform value
+    uint64_t uploadBytes = 0;           // area of the returned dirty rects
+    uint64_t fullBytes   = 0;           // what whole-surface frames would have cost
+};
+
+struct SpotTiles {
+    int        w = 0, h = 0, cols = 0, rows = 0;
+    SpotStyle  style;
+    uint32_t   lut[256] = {};           // premultiplied dim pixel per coverage level
+    int        levels = 0;              // coverage levels in use (dim alpha in 0..255)
+    std::vector<uint8_t> cls;           // what each tile holds now
+    SpotCircle last;
+    bool       haveLast = false;
+    SpotStats  stats;
+};
+
+// Sizes the grid for a w x h surface and fills all of it with the dim colour.
+void  Spot_Init  (SpotTiles&t,int w,int h,const SpotStyle&st,uint32_t*bits,int stride);
+// Moves the clear circle to c; returns the rect that changed (empty when nothing did).
+IRect Spot_Update(SpotTiles&t,uint32_t*bits,int stride,const SpotCircle&c);
+
+// Rasterizes the dim layer for circle c into rect `box`: per row, the spans left and right
+// of the feather are filled and only the feather itself is evaluated per pixel.
+void  Spot_Raster(const SpotTiles&t,uint32_t*bits,int stride,const IRect&box,const SpotCircle&c);
+// Reference value of one pixel, for tests and benchmarks.
+uint32_t Spot_Pixel(const SpotTiles&t,int x,int y,const SpotCircle&c);
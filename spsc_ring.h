@@ -0,0 +1,30 @@
+//  spsc_ring.h  –  Better Cursor Finder (BCF)
+//  Bounded single-producer / single-consumer ring. Push and Pop never block or allocate;
+//  a full ring rejects the push. No Windows headers.
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+template<class T,uint32_t N>
+struct SpscRing {
+    static_assert(N&&!(N&(N-1)),"SpscRing size must be a power of two");
+    alignas(64) std::atomic<uint32_t> head{0};     // written by the producer
+    alignas(64) std::atomic<uint32_t> tail{0};     // written by the consumer
+    alignas(64) T slots[N];
+
+    bool Push(const T&v){
+        uint32_t h=head.load(std::memory_order_relaxed);
+        if(h-tail.load(std::memory_order_acquire)==N)return false;
+        slots[h&(N-1)]=v;
+        head.store(h+1,std::memory_order_release);
+        return true;
+    }
+    bool Pop(T&v){
+        uint32_t t=tail.load(std::memory_order_relaxed);
+        if(t==head.load(std::memory_order_acquire))return false;
+        v=slots[t&(N-1)];
+        tail.store(t+1,std::memory_order_release);
+        return true;
+    }
+    uint32_t Size()const{return head.load(std::memory_order_acquire)-tail.load(std::memory_order_acquire);}
+};
@@ -0,0 +1,44 @@
+//  srgb.cpp  –  Better Cursor Finder (BCF)
+//  pow is not constexpr, so decoding uses x^2.4 = x^2 * (x^2)^(1/5) with the fifth root by
+//  Newton's method. The encode table needs no inverse: linear value l rounds up to sRGB
+//  code k+1 exactly when l reaches the decoded midpoint between k and k+1, so one sweep
+//  over the 255 midpoints fills it.
+
+#include "srgb.h"
+#include <cmath>
+
+static constexpr double Root5(double a)
+{
+    if(a<=0)return 0;
+    double y=1;
+    for(int i=0;i<64;i++){
+        const double n=(4*y+a/(y*y*y*y))/5;
+        if(n>=y)break;                      // decreasing from above until it converges
+        y=n;
+    }
+    return y;
+}
+static constexpr double Decode(double c)
+{
+    if(c<=0.04045)return c/12.92;
+    const double x=(c+0.055)/1.055;
+    return x*x*Root5(x*x);
+}
+static constexpr SrgbTables BuildSrgbTables()
+{
+    SrgbTables t{};
+    for(int v=0;v<256;v++)t.toLinear[v]=(float)Decode(v/255.0);
+    int k=0;
+    for(int i=0;i<=SRGB_LIN_MAX;i++){
+        while(k<255&&(double)i/SRGB_LIN_MAX>=Decode((k+0.5)/255.0))k++;
+        t.toSrgb[i]=(uint8_t)k;
+    }
+    return t;
+}
+
+constexpr SrgbTables g_srgb=BuildSrgbTables();
+static_assert(g_srgb.toLinear[0]==0.f&&g_srgb.toLinear[255]==1.f,"sRGB decode endpoints");
+static_assert(g_srgb.toSrgb[0]==0&&g_srgb.toSrgb[SRGB_LIN_MAX]==255,"sRGB encode endpoints");
+
+double SrgbDecode(double v){return v<=0.04045?v/12.92:pow((v+0.055)/1.055,2.4);}
+double SrgbEncode(double l){return l<=0.0031308?l*12.92:1.055*pow(l,1/2.4)-0.055;}
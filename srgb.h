@@ -0,0 +1,25 @@
+//  srgb.h  –  Better Cursor Finder (BCF)
+//  The sRGB transfer function as lookup tables built at compile time: 8-bit sRGB to linear
+//  light, and linear light quantized to 12 bits back to 8-bit sRGB, rounded exactly as the
+//  formula would round. No Windows headers.
+#pragma once
+#include <cstdint>
+
+static const int SRGB_LIN_BITS = 12;
+static const int SRGB_LIN_MAX  = (1<<SRGB_LIN_BITS)-1;
+
+struct SrgbTables {
+    float   toLinear[256];                  // 0..1
+    uint8_t toSrgb[SRGB_LIN_MAX+1];         // index: linear * SRGB_LIN_MAX, rounded
+};
+extern const SrgbTables g_srgb;
+
+static inline float   SrgbToLinear(uint32_t v){return g_srgb.toLinear[v&255];}
+static inline uint8_t LinearToSrgb(float l){
+    int i=(int)(l*(float)SRGB_LIN_MAX+.5f);
+    return g_srgb.toSrgb[i<0?0:i>SRGB_LIN_MAX?SRGB_LIN_MAX:i];
+}
+
+// The exact functions (0..1 both ways), for tests.
+double SrgbDecode(double v);
+double SrgbEncode(double l);
@@ -0,0 +1,136 @@
+//  bcf_channel_stress.cpp  –  Better Cursor Finder (BCF)
+//  Two-thread stress run of the render channel: command order and payload through the SPSC
+//  queue, snapshot consistency through the triple buffer, and the ordering the render thread
+//  relies on (a snapshot published before RC_CONFIG is visible when RC_CONFIG is popped).
+//  Build with -DBCF_TSAN=ON to run it under ThreadSanitizer.
+//
+//  bcf_channel_stress [--iters N] [--json]
+
+#include "render_channel.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+struct StressResult {
+    uint64_t ops    = 0;
+    uint64_t errors = 0;
+    uint64_t fresh  = 0;        // snapshots the reader actually moved to
+    double   ns     = 0;
+};
+
+static RenderConfig ConfigFor(uint32_t i)
+{
+    RenderConfig c;
+    c.ringColor=i*2654435761u&0xFFFFFF; c.outlineColor=~i&0xFFFFFF;
+    c.speed=(int)(i%3); c.moveCancel=(i&1)!=0;
+    return c;
+}
+static bool ConfigOk(const RenderConfig&c)
+{
+    RenderConfig e=ConfigFor(c.version);
+    return c.ringColor==e.ringColor&&c.outlineColor==e.outlineColor&&c.speed==e.speed&&c.moveCancel==e.moveCancel;
+}
+
+template<class F> static double Timed(F f)
+{
+    auto t0=std::chrono::steady_clock::now(); f();
+    return std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count();
+}
+
+// Every command arrives once, in order, with its payload intact.
+static StressResult QueueStress(uint32_t n)
+{
+    StressResult r; RenderChannel ch;
+    r.ns=Timed([&]{
+        std::thread prod([&]{
+            for(uint32_t i=1;i<=n;i++){
+                RenderCmd m; m.type=(RenderCmdType)(i%(RC_QUIT+1)); m.x=(int32_t)(i*3); m.y=~(int32_t)i; m.seq=i;
+                while(!ch.cmds.Push(m))std::this_thread::yield();
+            }
+        });
+        uint32_t expect=1; RenderCmd m;
+        while(expect<=n){
+            if(!ch.cmds.Pop(m)){std::this_thread::yield();continue;}
+            if(m.seq!=expect||m.x!=(int32_t)(expect*3)||m.y!=~(int32_t)expect||m.type!=(RenderCmdType)(expect%(RC_QUIT+1)))r.errors++;
+            expect++;
+        }
+        prod.join();
+    });
+    r.ops=n;
+    return r;
+}
+
+// The reader never sees a torn snapshot or a version going backwards, and ends on the last one.
+static StressResult SnapshotStress(uint32_t n)
+{
+    StressResult r; RenderChannel ch;
+    r.ns=Timed([&]{
+        std::thread prod([&]{for(uint32_t i=1;i<=n;i++)Chan_Publish(ch,ConfigFor(i));});
+        uint32_t seen=0;
+        while(seen<n){
+            if(!ch.config.Acquire()){std::this_thread::yield();continue;}
+            const RenderConfig&c=ch.config.Front();
+            if(c.version<=seen||!ConfigOk(c))r.errors++;
+            seen=c.version; r.fresh++;
+        }
+        prod.join();
+        if(ch.config.Acquire())r.errors++;                 // nothing may remain after the last
+    });
+    r.ops=n;
+    return r;
+}
+
+// The app's pattern: publish, then send RC_CONFIG carrying the version just published.
+static StressResult ConfigStress(uint32_t n)
+{
+    StressResult r; RenderChannel ch;
+    r.ns=Timed([&]{
+        std::thread prod([&]{
+            for(uint32_t i=1;i<=n;i++){
+                Chan_Publish(ch,ConfigFor(i));
+                while(!Chan_Send(ch,RC_CONFIG,(int32_t)i))std::this_thread::yield();
+            }
+            while(!Chan_Send(ch,RC_QUIT))std::this_thread::yield();
+        });
+        RenderCmd m; uint32_t have=0;
+        for(;;){
+            if(!ch.cmds.Pop(m)){std::this_thread::yield();continue;}
+            if(m.type==RC_QUIT)break;
+            if(ch.config.Acquire())r.fresh++;
+            const RenderConfig&c=ch.config.Front();
+            if(c.version<(uint32_t)m.x||c.version<have||!ConfigOk(c))r.errors++;
+            have=c.version;
+        }
+        prod.join();
+    });
+    r.ops=n;
+    return r;
+}
+
+int main(int argc,char**argv)
+{
+    uint32_t iters=2000000; bool json=false;
+    for(int i=1;i<argc;i++){
+        const char*a=argv[i]; const char*v=i+1<argc?argv[i+1]:nullptr;
+        if(!strcmp(a,"--json"))json=true;
+        else if(!strcmp(a,"--iters")&&v){iters=(uint32_t)atoi(v);i++;}
+        else{fprintf(stderr,"usage: %s [--iters N] [--json]\n",argv[0]);return 2;}
+    }
+    struct {const char*name;StressResult r;} runs[]={
+        {"queue",QueueStress(iters)},{"snapshot",SnapshotStress(iters)},{"config",ConfigStress(iters/4)}};
+
+    bool ok=true;
+    if(json)printf("[");
+    else printf("test,ops,ns_per_op,fresh,errors\n");
+    for(size_t i=0;i<sizeof(runs)/sizeof(runs[0]);i++){
+        const StressResult&r=runs[i].r; ok=ok&&!r.errors;
+        if(json)printf("%s{\"test\":\"%s\",\"ops\":%llu,\"ns_per_op\":%.1f,\"fresh\":%llu,\"errors\":%llu}",i?",":"",
+                       runs[i].name,(unsigned long long)r.ops,r.ns/r.ops,(unsigned long long)r.fresh,(unsigned long long)r.errors);
+        else printf("%s,%llu,%.1f,%llu,%llu\n",runs[i].name,(unsigned long long)r.ops,r.ns/r.ops,
+                    (unsigned long long)r.fresh,(unsigned long long)r.errors);
+    }
+    if(json)printf("]\n");
+    return ok?0:1;
+}
@@ -0,0 +1,165 @@
+//  bcf_governor_sim.cpp  –  Better Cursor Finder (BCF)
+//  Drives the frame governor and the frame pacer together against a simulated display and
+//  simulated frame costs, the way AnimTick does: pace, draw, feed the cost back, re-arm for
+//  the wake time. A frame that costs more than the render lead delays the next wake, so the
+//  pacer sees the missed vblanks a slow frame causes on a real display.
+//
+//  Each scenario fixes a refresh rate, a power source and a cost profile and states what the
+//  governor must do (rate, quality, stepping down under load and back up, the idle reset);
+//  the tool prints what happened per animation and exits non-zero when an expectation fails.
+//
+//  bcf_governor_sim [--json]
+
+#include "frame_governor.h"
+#include "frame_pacer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+static const int64_t MS = 1000000;
+
+struct SimClock : PaceClock {
+    int64_t now = 0, period = 16666667;
+    int64_t NowNs() override {return now;}
+    bool VBlank(int64_t&p,int64_t&last) override {p=period;last=now/period*period;return true;}
+};
+
+struct AnimResult {
+    int64_t  startNs = 0;
+    int      startLevel = 0, endLevel = 0, endDivisor = 1;
+    uint64_t frames = 0, reduced = 0, missed = 0;
+    double   fps = 0;
+};
+
+// One animation of `durMs` starting at `t0`; cost(tSinceStart) in ns per drawn frame.
+static AnimResult Animate(FrameGovernor&g,SimClock&clk,int64_t t0,float durMs,
+                          const std::function<int64_t(int64_t)>&cost)
+{
+    FramePacer p; AnimResult r;
+    clk.now=t0; r.startNs=t0;
+    Pacer_Start(p,&clk,durMs);
+    Gov_Start(g,p.startNs); p.divisor=Gov_Current(g).divisor;
+    r.startLevel=g.level;
+    int64_t firstPresent=0, lastPresent=0;
+    for(;;){
+        PaceFrame f=Pacer_Next(p);
+        if(f.render){
+            if(f.progress>=1.f)break;
+            int64_t c=cost(clk.now-t0);
+            if(Gov_Current(g).quality==GOV_REDUCED)r.reduced++;
+            r.frames++;
+            if(!firstPresent)firstPresent=f.presentNs;
+            lastPresent=f.presentNs;
+            Gov_Frame(g,clk.now,c,p.stats.missed,clk.period);
+            p.divisor=Gov_Current(g).divisor;
+            clk.now+=c;
+        }
+        clk.now=std::max(clk.now+50000,f.wakeNs);
+    }
+    r.endLevel=g.level; r.endDivisor=Gov_Current(g).divisor; r.missed=p.stats.missed;
+    if(r.frames>1)r.fps=(double)(r.frames-1)*1e9/(double)(lastPresent-firstPresent);
+    return r;
+}
+
+struct Check { std::string what; bool ok; };
+struct Scenario {
+    std::string name; int hz; PowerSource power;
+    std::vector<AnimResult> anims;
+    std::vector<Check> checks;
+    GovStats stats;
+    void Expect(bool ok,const char*what){checks.push_back({what,ok});}
+};
+
+static int64_t Cheap(int64_t){return 150000;}
+static int64_t Heavy(int64_t){return 3*MS;}
+
+static Scenario Run(const char*name,int hz,PowerSource power,
+                    const std::function<void(Scenario&,FrameGovernor&,SimClock&)>&body)
+{
+    Scenario s; s.name=name; s.hz=hz; s.power=power;
+    FrameGovernor g; SimClock clk; clk.period=1000000000LL/hz;
+    Gov_SetPower(g,power); g.periodNs=clk.period;
+    body(s,g,clk);
+    s.stats=g.stats;
+    return s;
+}
+
+int main(int argc,char**argv)
+{
+    bool json=false;
+    for(int i=1;i<argc;i++){
+        if(!strcmp(argv[i],"--json"))json=true;
+        else{fprintf(stderr,"usage: %s [--json]\n",argv[0]);return 2;}
+    }
+    std::vector<Scenario> all;
+    for(int hz:{60,144,240})
+        all.push_back(Run("cheap",hz,POWER_AC,[hz](Scenario&s,FrameGovernor&g,SimClock&c){
+            s.anims.push_back(Animate(g,c,1*MS,1050,Cheap));
+            const AnimResult&a=s.anims[0];
+            s.Expect(a.endLevel==0&&!a.reduced,"stays at full quality");
+            s.Expect(fabs(a.fps-hz)<hz*0.05,"runs at the refresh rate");
+        }));
+    all.push_back(Run("battery",144,POWER_BATTERY,[](Scenario&s,FrameGovernor&g,SimClock&c){
+        s.anims.push_back(Animate(g,c,1*MS,1050,Cheap));
+        s.Expect(s.anims[0].endDivisor==3&&!s.anims[0].reduced,"every 3rd vblank, full quality");
+        s.Expect(s.anims[0].fps<=60,"at most 60 fps");
+    }));
+    all.push_back(Run("battery",60,POWER_BATTERY,[](Scenario&s,FrameGovernor&g,SimClock&c){
+        s.anims.push_back(Animate(g,c,1*MS,1050,Cheap));
+        s.Expect(s.anims[0].endDivisor==1,"60 Hz is already within the cap");
+    }));
+    all.push_back(Run("saver",60,POWER_SAVER,[](Scenario&s,FrameGovernor&g,SimClock&c){
+        s.anims.push_back(Animate(g,c,1*MS,1050,Cheap));
+        const AnimResult&a=s.anims[0];
+        s.Expect(a.reduced==a.frames,"reduced quality throughout");
+        s.Expect(a.fps<=30.5,"at most 30 fps");
+    }));
+    all.push_back(Run("sustained",144,POWER_AC,[](Scenario&s,FrameGovernor&g,SimClock&c){
+        s.anims.push_back(Animate(g,c,1*MS,1600,Heavy));
+        s.Expect(s.anims[0].endLevel==Gov_MaxLevel(g),"ends on the last step");
+        s.Expect(s.anims[0].fps>=29,"never below 30 fps");
+    }));
+    all.push_back(Run("spike",144,POWER_AC,[](Scenario&s,FrameGovernor&g,SimClock&c){
+        s.anims.push_back(Animate(g,c,1*MS,4000,[](int64_t t){return t<300*MS?3*MS:150000;}));
+        s.Expect(g.stats.down>0,"steps down under the spike");
+        s.Expect(s.anims[0].endLevel==0,"back to full quality afterwards");
+    }));
+    all.push_back(Run("idle",144,POWER_AC,[](Scenario&s,FrameGovernor&g,SimClock&c){
+        s.anims.push_back(Animate(g,c,1*MS,1050,Heavy));
+        int64_t t=s.anims[0].startNs+1100*MS;
+        s.anims.push_back(Animate(g,c,t+1000*MS,1050,Cheap));
+        t=s.anims[1].startNs+1100*MS;
+        s.anims.push_back(Animate(g,c,t+4000*MS,1050,Cheap));
+        s.Expect(s.anims[1].startLevel>0,"a quick retrigger keeps the reduced step");
+        s.Expect(s.anims[2].startLevel==0,"after 3 s idle it starts at full quality");
+    }));
+
+    bool ok=true, first=true;
+    if(json)printf("[");
+    else printf("scenario,hz,power,anim,start_step,end_step,divisor,frames,reduced,missed,fps\n");
+    for(const Scenario&s:all){
+        for(size_t i=0;i<s.anims.size();i++){
+            const AnimResult&a=s.anims[i];
+            if(json){
+                printf("%s{\"scenario\":\"%s\",\"hz\":%d,\"power\":\"%s\",\"anim\":%zu,\"start_step\":%d,\"end_step\":%d,"
+                       "\"divisor\":%d,\"frames\":%llu,\"reduced\":%llu,\"missed\":%llu,\"fps\":%.1f}",
+                       first?"":",",s.name.c_str(),s.hz,GovPowerName(s.power),i,a.startLevel,a.endLevel,a.endDivisor,
+                       (unsigned long long)a.frames,(unsigned long long)a.reduced,(unsigned long long)a.missed,a.fps);
+                first=false;
+            } else
+                printf("%s,%d,%s,%zu,%d,%d,%d,%llu,%llu,%llu,%.1f\n",s.name.c_str(),s.hz,GovPowerName(s.power),i,
+                       a.startLevel,a.endLevel,a.endDivisor,(unsigned long long)a.frames,
+                       (unsigned long long)a.reduced,(unsigned long long)a.missed,a.fps);
+        }
+        for(const Check&c:s.checks)if(!c.ok){
+            ok=false;
+            fprintf(stderr,"FAIL %s @%d Hz %s: %s\n",s.name.c_str(),s.hz,GovPowerName(s.power),c.what.c_str());
+        }
+    }
+    if(json)printf("]\n");
+    return ok?0:1;
+}
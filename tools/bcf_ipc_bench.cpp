@@ -0,0 +1,231 @@
+//  bcf_ipc_bench.cpp  –  Better Cursor Finder (BCF)
+//  Latency of the local command channel, over the Unix domain socket stand-in for the named
+//  pipe. The app's threads are simulated as they hand a command on: the IPC thread passes
+//  each request to the UI thread and waits for it (SendMessage in the app), the UI thread
+//  sends RC_START through the render channel and wakes the render thread, and the render
+//  thread stamps the moment StartAnimation would run.
+//
+//  Reports percentiles for a ping round trip, client send to StartAnimation, client send to
+//  the reply, and a second launch's connect-call-close. Also checks the protocol: set-color
+//  and get-stats round trips, bad version and bad op replies, the connection limit and
+//  command-line parsing.
+//  Exits non-zero when a check fails or the median send-to-start latency is 1 ms or more.
+//
+//  bcf_ipc_bench [--iters N] [--json]
+
+#include "ipc_channel.h"
+#include "frame_stats.h"
+#include "render_channel.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#if !defined(_WIN32)
+  #include <unistd.h>
+#endif
+
+#if !defined(_WIN32)
+static int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Auto-reset event, as the render thread's wake event.
+struct Event {
+    std::mutex m; std::condition_variable cv; bool set = false;
+    void Set(){{std::lock_guard<std::mutex> l(m);set=true;}cv.notify_one();}
+    void Wait(){std::unique_lock<std::mutex> l(m);cv.wait(l,[&]{return set;});set=false;}
+};
+
+//  SIMULATED APP
+struct App {
+    // UI thread mailbox: one call at a time, like SendMessage.
+    std::mutex call, m; std::condition_variable cv;
+    const IpcMessage*q = nullptr; IpcMessage*r = nullptr; bool done = false, quit = false;
+    // UI thread state
+    uint32_t ring = 0x00FFFFFF, outline = 0;
+    uint64_t animations = 0;
+    IpcServer*server = nullptr;
+    // Render thread
+    RenderChannel chan; Event wake;
+    std::atomic<uint32_t> started{0};
+    std::atomic<int64_t>  startNs{0};
+};
+
+static void OnIpc(App&a,const IpcMessage&q,IpcMessage&r)
+{
+    switch(q.op){
+    case IPC_START:  Chan_Send(a.chan,RC_START); a.wake.Set(); a.animations++; break;
+    case IPC_CANCEL: Chan_Send(a.chan,RC_CANCEL); a.wake.Set(); break;
+    case IPC_SET_COLOR:
+        if(!Ipc_GetColor(q,a.ring,a.outline))r.op=IPC_BAD_ARGS;
+        break;
+    case IPC_GET_STATS:{
+        IpcStats s; s.ringColor=a.ring; s.outlineColor=a.outline; s.animations=a.animations;
+        s.requests=a.server->requests;
+        Ipc_PutStats(r,s); break;}
+    }
+}
+static void UiThread(App&a)
+{
+    std::unique_lock<std::mutex> l(a.m);
+    for(;;){
+        a.cv.wait(l,[&]{return a.q||a.quit;});
+        if(a.quit)return;
+        OnIpc(a,*a.q,*a.r);
+        a.q=nullptr; a.done=true; a.cv.notify_all();
+    }
+}
+static void RenderThread(App&a)
+{
+    for(;;){
+        a.wake.Wait();
+        RenderCmd c;
+        while(a.chan.cmds.Pop(c)){
+            if(c.type==RC_QUIT)return;
+            if(c.type==RC_START){a.startNs.store(NowNs(),std::memory_order_relaxed);a.started.fetch_add(1,std::memory_order_release);}
+        }
+    }
+}
+static void Handler(void*ctx,const IpcMessage&q,IpcMessage&r)
+{
+    App&a=*(App*)ctx;
+    std::lock_guard<std::mutex> one(a.call);
+    std::unique_lock<std::mutex> l(a.m);
+    a.q=&q; a.r=&r; a.done=false; a.cv.notify_all();
+    a.cv.wait(l,[&]{return a.done;});
+}
+
+//  MEASUREMENT
+struct Series { const char*name; LatencyHist h; };
+
+static void Print(const Series&s,bool json,bool last)
+{
+    const double mean=s.h.total?(double)s.h.sumNs/s.h.total/1e3:0;
+    const double p50=Hist_Percentile(s.h,0.5)/1e3, p99=Hist_Percentile(s.h,0.99)/1e3, mx=s.h.maxNs/1e3;
+    if(json)printf("  {\"series\":\"%s\",\"n\":%llu,\"mean_us\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}%s\n",
+                   s.name,(unsigned long long)s.h.total,mean,p50,p99,mx,last?"":",");
+    else printf("%s,%llu,%.1f,%.1f,%.1f,%.1f\n",s.name,(unsigned long long)s.h.total,mean,p50,p99,mx);
+}
+
+// Raw bytes, for headers the protocol functions would not produce.
+struct RawHeader { uint8_t b[3]; };
+
+int main(int argc,char**argv)
+{
+    int iters=2000; bool json=false;
+    for(int i=1;i<argc;i++){
+        if(!strcmp(argv[i],"--json"))json=true;
+        else if(!strcmp(argv[i],"--iters")&&i+1<argc)iters=std::max(1,atoi(argv[++i]));
+        else{fprintf(stderr,"usage: %s [--iters N] [--json]\n",argv[0]);return 2;}
+    }
+    const std::string path="/tmp/bcf_ipc_bench_"+std::to_string(getpid())+".sock";
+    UnixSocketListener listener(path);
+    if(!listener.Open()){fprintf(stderr,"cannot listen on %s\n",path.c_str());return 1;}
+
+    App app; IpcServer server; app.server=&server;
+    std::thread ui(UiThread,std::ref(app)), render(RenderThread,std::ref(app));
+    Ipc_Start(server,&listener,Handler,&app);
+
+    std::vector<std::string> failures;
+    auto expect=[&](bool ok,const char*what){if(!ok)failures.push_back(what);};
+    Series ping{"ping_roundtrip",{}}, start{"send_to_start",{}}, reply{"send_to_reply",{}}, launch{"connect_call_close",{}};
+
+    IpcConn*c=UnixSocket_Connect(path.c_str());
+    if(!c){fprintf(stderr,"cannot connect to %s\n",path.c_str());return 1;}
+    IpcMessage q, r;
+    for(int i=0;i<iters/10+10;i++){q=IpcMessage();q.op=IPC_PING;Ipc_Call(*c,q,r);}     // warm up
+    for(int i=0;i<iters;i++){
+        q=IpcMessage(); q.op=IPC_PING;
+        int64_t t0=NowNs(); bool ok=Ipc_Call(*c,q,r);
+        Hist_Add(ping.h,(uint32_t)(NowNs()-t0));
+        if(!ok||r.op!=IPC_OK){expect(false,"ping");break;}
+    }
+    for(int i=0;i<iters;i++){
+        const uint32_t before=app.started.load(std::memory_order_acquire);
+        q=IpcMessage(); q.op=IPC_START;
+        int64_t t0=NowNs(); bool ok=Ipc_Call(*c,q,r);
+        int64_t t1=NowNs();
+        while(app.started.load(std::memory_order_acquire)==before)std::this_thread::yield();
+        Hist_Add(reply.h,(uint32_t)(t1-t0));
+        Hist_Add(start.h,(uint32_t)(app.startNs.load(std::memory_order_relaxed)-t0));
+        if(!ok||r.op!=IPC_OK){expect(false,"start");break;}
+    }
+    for(int i=0;i<iters/4;i++){
+        int64_t t0=NowNs();
+        IpcConn*k=UnixSocket_Connect(path.c_str());
+        q=IpcMessage(); q.op=IPC_PING;
+        bool ok=k&&Ipc_Call(*k,q,r);
+        delete k;
+        Hist_Add(launch.h,(uint32_t)(NowNs()-t0));
+        if(!ok){expect(false,"connect, call, close");break;}
+    }
+
+    // Protocol checks.
+    q=IpcMessage(); q.op=IPC_SET_COLOR; Ipc_PutColor(q,0x0000FF,0x00FF00);
+    expect(Ipc_Call(*c,q,r)&&r.op==IPC_OK,"set-color accepted");
+    q=IpcMessage(); q.op=IPC_GET_STATS; IpcStats st;
+    expect(Ipc_Call(*c,q,r)&&r.op==IPC_OK&&Ipc_GetStats(r,st),"get-stats");
+    expect(st.ringColor==0x0000FF&&st.outlineColor==0x00FF00,"colours round trip");
+    expect(st.animations==(uint64_t)iters,"every start reached the UI thread");
+    q=IpcMessage(); q.op=IPC_SET_COLOR; q.len=3;
+    expect(Ipc_Call(*c,q,r)&&r.op==IPC_BAD_ARGS,"short set-color rejected");
+    q=IpcMessage(); q.op=IPC_OPS;
+    expect(Ipc_Call(*c,q,r)&&r.op==IPC_BAD_OP,"unknown op rejected");
+    {
+        RawHeader h={{IPC_VERSION+1,IPC_PING,0}};
+        expect(c->Write(h.b,3)&&Ipc_Recv(*c,r)>0&&r.op==IPC_BAD_VERSION,"other version rejected");
+        expect(Ipc_Recv(*c,r)==0,"connection closed after a bad header");
+    }
+    delete c;
+    {
+        IpcConn*open[IPC_MAX_CONNS]={};
+        bool ok=true;
+        for(IpcConn*&k:open){
+            k=UnixSocket_Connect(path.c_str()); q=IpcMessage(); q.op=IPC_PING;
+            ok=ok&&k&&Ipc_Call(*k,q,r)&&r.op==IPC_OK;
+        }
+        IpcConn*extra=UnixSocket_Connect(path.c_str());
+        expect(ok,"serves IPC_MAX_CONNS clients at once");
+        expect(extra&&Ipc_Recv(*extra,r)>0&&r.op==IPC_BUSY,"one more is told it is busy");
+        delete extra; for(IpcConn*k:open)delete k;
+    }
+
+    IpcMessage a; uint32_t ring=0, outline=1;
+    expect(Ipc_ParseArgs("--start",a)&&a.op==IPC_START,"parse --start");
+    expect(Ipc_ParseArgs("  --stats ",a)&&a.op==IPC_GET_STATS,"parse --stats");
+    expect(Ipc_ParseArgs("--color #FF8000",a)&&a.op==IPC_SET_COLOR&&Ipc_GetColor(a,ring,outline)&&
+           ring==0x0080FF&&outline==0,"parse --color RRGGBB");
+    expect(Ipc_ParseArgs("--color 000000 ffffff",a)&&Ipc_GetColor(a,ring,outline)&&outline==0xFFFFFF,"parse two colours");
+    expect(!Ipc_ParseArgs("--color 12345",a)&&!Ipc_ParseArgs("--start now",a)&&!Ipc_ParseArgs("",a)&&
+           !Ipc_ParseArgs("--frobnicate",a),"reject bad arguments");
+
+    Ipc_Stop(server);
+    {std::lock_guard<std::mutex> l(app.m);app.quit=true;}
+    app.cv.notify_all(); ui.join();
+    Chan_Send(app.chan,RC_QUIT); app.wake.Set(); render.join();
+    expect(server.errors==1,"one malformed header counted");
+
+    const double p50=Hist_Percentile(start.h,0.5)/1e3;
+    expect(p50<1000,"median send-to-start under 1 ms");
+    const Series*all[]={&ping,&start,&reply,&launch};
+    if(json)printf("{\"transport\":\"%s\",\"series\":[\n",listener.Name());
+    else printf("series,n,mean_us,p50_us,p99_us,max_us\n");
+    for(int i=0;i<4;i++)Print(*all[i],json,i==3);
+    if(json){
+        printf("],\"failures\":[");
+        for(size_t i=0;i<failures.size();i++)printf("%s\"%s\"",i?",":"",failures[i].c_str());
+        printf("]}\n");
+    } else for(const std::string&f:failures)fprintf(stderr,"FAIL: %s\n",f.c_str());
+    return failures.empty()?0:1;
+}
+#else
+int main()
+{
+    fprintf(stderr,"bcf_ipc_bench runs over a Unix domain socket; not built for Windows\n");
+    return 0;
+}
+#endif
@@ -0,0 +1,157 @@
+//  bcf_predict_eval.cpp  –  Better Cursor Finder (BCF)
+//  Replays pointer traces through the motion predictor the way the render thread drives it
+//  (samples up to the frame's wake time, prediction to the vblank it presents on) and
+//  reports the distance between the drawn ring centre and the real pointer at present time:
+//  mean and 99th percentile per trace and prediction amount.
+//
+//  Built-in traces are synthetic (minimum-jerk flicks, circles, a slow drag with tremor,
+//  zig-zags) at 125 Hz and 1000 Hz report rates. --trace replays a recording instead:
+//  one "t_ms,x,y" line per report.
+//
+//  bcf_predict_eval [--trace FILE] [--hz N] [--seconds N] [--json]
+
+#include "motion_predict.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+struct TraceSample { int64_t tNs; float x, y; };
+typedef std::vector<TraceSample> Trace;
+
+static float MinJerk(float s){s=s<0?0:s>1?1:s;return s*s*s*(10.f+s*(-15.f+6.f*s));}
+
+// Reports of a continuous path at `reportHz`, rounded to whole pixels like a real cursor.
+template<class F> static Trace Sample(F path,double seconds,int reportHz)
+{
+    Trace t; int64_t step=1000000000LL/reportHz;
+    for(int64_t ns=0;ns<(int64_t)(seconds*1e9);ns+=step){
+        float x,y; path(ns*1e-9,x,y);
+        t.push_back({ns,roundf(x),roundf(y)});
+    }
+    return t;
+}
+static Trace Flicks(double seconds,int hz,uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    struct Move{double t0,t1;float x0,y0,x1,y1;};
+    std::vector<Move> moves; double t=0; float x=960,y=540;
+    while(t<seconds){
+        float ang=(float)(rng()%6283)/1000.f, dist=200.f+(float)(rng()%1300);
+        float nx=std::min(3800.f,std::max(0.f,x+dist*cosf(ang))), ny=std::min(2100.f,std::max(0.f,y+dist*sinf(ang)));
+        double dur=0.15+(rng()%250)/1000.0;
+        moves.push_back({t,t+dur,x,y,nx,ny}); x=nx; y=ny;
+        t+=dur+0.1+(rng()%200)/1000.0;
+    }
+    return Sample([&](double s,float&px,float&py){
+        const Move*m=&moves.front();
+        for(const Move&mv:moves){if(mv.t0>s)break;m=&mv;}
+        float k=MinJerk((float)((s-m->t0)/(m->t1-m->t0)));
+        px=m->x0+(m->x1-m->x0)*k; py=m->y0+(m->y1-m->y0)*k;
+    },seconds,hz);
+}
+static Trace Circles(double seconds,int hz)
+{
+    return Sample([](double s,float&x,float&y){x=960+250*(float)cos(s*6.2832);y=540+250*(float)sin(s*6.2832);},seconds,hz);
+}
+static Trace Drag(double seconds,int hz)
+{
+    return Sample([](double s,float&x,float&y){
+        x=400+120*(float)s+2.f*(float)sin(s*2*3.14159*8); y=600+40*(float)s+1.5f*(float)cos(s*2*3.14159*11);
+    },seconds,hz);
+}
+static Trace ZigZag(double seconds,int hz)
+{
+    return Sample([](double s,float&x,float&y){
+        double ph=fmod(s,0.5)/0.5; float k=MinJerk((float)(ph<0.5?ph*2:2-ph*2));
+        x=700+600*k; y=500+(float)(40*s);
+    },seconds,hz);
+}
+
+static Trace LoadTrace(const char*path)
+{
+    Trace t; FILE*f=fopen(path,"r"); if(!f)return t;
+    char line[256];
+    while(fgets(line,sizeof(line),f)){
+        double ms; float x,y;
+        if(sscanf(line,"%lf,%f,%f",&ms,&x,&y)==3)t.push_back({(int64_t)(ms*1e6),x,y});
+    }
+    fclose(f);
+    return t;
+}
+
+struct EvalResult { double mean=0, p99=0, max=0; size_t frames=0; };
+
+// Frames wake `leadNs` before each vblank, feed every report up to the wake and draw at the
+// predicted vblank position; the pointer's true position is the last report at the vblank.
+static EvalResult Evaluate(const Trace&tr,int hz,float amount,int64_t leadNs)
+{
+    EvalResult r; if(tr.size()<2)return r;
+    MotionPredictor p; Predict_Reset(p);
+    const int64_t period=1000000000LL/hz, t0=tr.front().tNs, t1=tr.back().tNs;
+    size_t fed=0,seen=0; std::vector<float> err;
+    for(int64_t vb=t0+period;vb<=t1;vb+=period){
+        int64_t wake=vb-leadNs;
+        while(fed<tr.size()&&tr[fed].tNs<=wake){Predict_Add(p,tr[fed].tNs,tr[fed].x,tr[fed].y);fed++;}
+        if(!fed)continue;
+        float px,py; Predict_At(p,vb,amount,px,py);
+        while(seen+1<tr.size()&&tr[seen+1].tNs<=vb)seen++;
+        float dx=px-tr[seen].x, dy=py-tr[seen].y;
+        err.push_back(sqrtf(dx*dx+dy*dy));
+    }
+    if(err.empty())return r;
+    double sum=0; for(float e:err)sum+=e;
+    std::sort(err.begin(),err.end());
+    r.frames=err.size(); r.mean=sum/err.size();
+    r.p99=err[std::min(err.size()-1,(size_t)(err.size()*0.99))]; r.max=err.back();
+    return r;
+}
+
+int main(int argc,char**argv)
+{
+    const char*tracePath=nullptr; int hz=144; double seconds=20; bool json=false;
+    for(int i=1;i<argc;i++){
+        const char*a=argv[i]; const char*v=i+1<argc?argv[i+1]:nullptr;
+        if(!strcmp(a,"--json"))json=true;
+        else if(!strcmp(a,"--trace")&&v){tracePath=v;i++;}
+        else if(!strcmp(a,"--hz")&&v){hz=std::max(1,atoi(v));i++;}
+        else if(!strcmp(a,"--seconds")&&v){seconds=atof(v);i++;}
+        else{fprintf(stderr,"usage: %s [--trace FILE] [--hz N] [--seconds N] [--json]\n",argv[0]);return 2;}
+    }
+    struct Named{std::string name;Trace t;};
+    std::vector<Named> traces;
+    if(tracePath){
+        traces.push_back({tracePath,LoadTrace(tracePath)});
+        if(traces[0].t.size()<2){fprintf(stderr,"%s: no samples\n",tracePath);return 1;}
+    } else {
+        for(int rate:{125,1000}){
+            std::string sfx="@"+std::to_string(rate);
+            traces.push_back({"flicks"+sfx,Flicks(seconds,rate,7)});
+            traces.push_back({"circles"+sfx,Circles(seconds,rate)});
+            traces.push_back({"drag"+sfx,Drag(seconds,rate)});
+            traces.push_back({"zigzag"+sfx,ZigZag(seconds,rate)});
+        }
+    }
+    // Render lead as the frame pacer schedules it: render budget plus timer slack.
+    const int64_t leadNs=3000000;
+    const float amounts[]={0.f,0.25f,0.5f,0.75f,1.f};
+
+    if(json)printf("[");
+    else printf("trace,hz,amount,frames,mean_px,p99_px,max_px\n");
+    bool first=true;
+    for(const Named&n:traces)
+        for(float a:amounts){
+            EvalResult r=Evaluate(n.t,hz,a,leadNs);
+            if(json){
+                printf("%s{\"trace\":\"%s\",\"hz\":%d,\"amount\":%.2f,\"frames\":%zu,\"mean_px\":%.2f,\"p99_px\":%.2f,\"max_px\":%.2f}",
+                       first?"":",",n.name.c_str(),hz,a,r.frames,r.mean,r.p99,r.max);
+                first=false;
+            } else printf("%s,%d,%.2f,%zu,%.2f,%.2f,%.2f\n",n.name.c_str(),hz,a,r.frames,r.mean,r.p99,r.max);
+        }
+    if(json)printf("]\n");
+    return 0;
+}
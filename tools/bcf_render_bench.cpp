@@ -0,0 +1,1208 @@
+//  bcf_render_bench.cpp  –  Better Cursor Finder (BCF)
+//  Headless benchmark of the animation hot path. Plays the locate animation into in-memory
+//  BGRA surfaces the way the overlay does (clear the stale rect, draw, upload the box) for
+//  every speed and overlay scale, and reports ns/frame, bytes touched and heap allocations
+//  per frame as CSV (default) or JSON. --hsv instead times the colour-picker HSV kernels
+//  and checks them exhaustively against HSVtoRGB / RGBtoHSV. --spot plays spotlight mode on
+//  a desktop-sized surface (three 4K screens by default), tiled against whole-surface
+//  rasterization, and checks the tiled surface against the per-pixel reference. --trail
+//  flicks the pointer at several speeds with trail mode on and reports capsule segments
+//  rasterized per ms, batched against one bounding-box pass per segment. --contrast times
+//  the auto-contrast luminance kernel on synthetic screenshots the size of the overlay,
+//  checks every path against the scalar sums and the colours picked for each scene.
+//  --gamma checks the sRGB tables against the exact transfer functions, the linear-light
+//  ring against its double-precision reference for several colour pairs and every SIMD
+//  path against the scalar one, and times the sRGB and linear paths side by side.
+//
+//  --glow times the alpha blur behind the glow on overlay-sized planes at 1x, 2x and 3x, checks
+//  every path against the scalar one and the scalar one against direct box sums, reports how
+//  far three boxes are from a true Gaussian, and times building the per-radius glow profiles.
+//  --near checks that the reduced-quality nearest-frame lookup never strays more than one
+//  radius step, against the real atlas and one cut to the outer half of the radii.
+//  --damage checks the rect helpers and the overlay's clear and upload rects on fixed cases
+//  and on random rects against per-pixel sets. --stats checks the frame-time histogram's
+//  bucket edges and percentiles and the sample ring's overflow, and times Stats_Record.
+//
+//  bcf_render_bench [--reps N] [--hz N] [--ring BBGGRR] [--outline BBGGRR] [--glow-px N] [--json] [--hsv]
+//                   [--spot [--desktop WxH] [--scale S]] [--trail [--scale S]]
+//                   [--contrast [--scale S]] [--gamma [--scale S]] [--glow] [--near] [--damage] [--stats]
+
+#include "ring_raster.h"
+#include "ring_atlas.h"
+#include "ring_anim.h"
+#include "overlay_damage.h"
+#include "cpu_features.h"
+#include "color_hsv.h"
+#include "spotlight.h"
+#include "cursor_trail.h"
+#include "bg_contrast.h"
+#include "srgb.h"
+#include "alpha_blur.h"
+#include "frame_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+//  ALLOCATION COUNTER
+static std::atomic<uint64_t> g_allocs{0};
+void* operator new(size_t n){g_allocs++; if(void*p=malloc(n?n:1))return p; throw std::bad_alloc();}
+void  operator delete(void*p)noexcept{free(p);}
+void  operator delete(void*p,size_t)noexcept{free(p);}
+
+//  OPTIONS
+static const int OV_SIZE = 240;            // logical overlay size, as in cursor_ring.cpp
+
+struct BenchOptions {
+    int       reps = 20;
+    int       hz   = 144;
+    RingStyle style;                       // AppSettings defaults: white ring, black outline
+    bool      json = false;
+    bool      hsv  = false;
+    bool      spot = false;
+    bool      trail = false;
+    bool      contrast = false;
+    bool      gamma = false;
+    bool      glow = false;
+    bool      near = false;
+    bool      damage = false;
+    bool      stats = false;
+    int       deskW = 3*3840, deskH = 2160;
+    float     deskScale = 1.5f;
+};
+
+enum BenchMode { BM_LIVE_SCALAR, BM_LIVE, BM_ATLAS, BM_COUNT };
+static const char*ModeName(int m){static const char*n[]={"live-scalar","live","atlas"};return n[m];}
+
+struct BenchResult {
+    int      mode, speed, scale, size;
+    uint64_t frames;                       // per repetition
+    double   nsPerFrame, bestNsPerFrame, bytesPerFrame, allocsPerFrame;
+    double   atlasMs, atlasKB;
+    int      atlasBaked, atlasKeys;
+};
+
+//  SURFACE
+// Double-buffered like OverlaySurface: each back buffer is cleared only where it drew last.
+struct BenchSurface {
+    int      size = 0;
+    std::vector<uint32_t> bits[2];
+    IRect    drawn[2];
+    int      back = 0;
+    DamageStats damage;
+    uint64_t drawBytes = 0;
+};
+
+static void Surface_Init(BenchSurface&s,int size)
+{
+    s.size=size; s.back=0; s.damage=DamageStats(); s.drawBytes=0;
+    for(int i=0;i<2;i++){s.bits[i].assign((size_t)size*size,0); s.drawn[i]=IRect();}
+}
+
+static void Frame(BenchSurface&s,int mode,const RingAtlas&atlas,const RingStyle&st,const RingFrame&rf)
+{
+    const int sz=s.size; uint32_t*px=s.bits[s.back].data();
+    IRect clear=DamageClearRect(s.drawn[s.back],sz);
+    for(int y=clear.y0;y<clear.y1;y++)memset(px+(size_t)y*sz+clear.x0,0,(size_t)(clear.x1-clear.x0)*4);
+
+    const float c=sz/2.f, r=rf.r*st.scale;
+    IRect box;
+    const AtlasFrame*f=mode==BM_ATLAS?AtlasLookup(atlas,r,rf.alpha):nullptr;
+    if(f) box=AtlasBlit(atlas,*f,px,sz);
+    else  box=RasterRing(px,sz,sz,sz,c,c,r,rf.alpha,st,mode==BM_LIVE_SCALAR?RP_SCALAR:RP_AUTO);
+
+    DamageAccount(s.damage,clear,DamageUploadRect(box,sz),sz);
+    s.drawBytes+=(uint64_t)IRectArea(box)*4;
+    s.drawn[s.back]=box; s.back^=1;
+}
+
+static BenchResult Run(const BenchOptions&o,int mode,int speed,int scale)
+{
+    BenchResult res={}; res.mode=mode; res.speed=speed; res.scale=scale; res.size=OV_SIZE*scale;
+    RingStyle st=o.style; st.scale=(float)scale;
+
+    RingAtlas atlas;
+    if(mode==BM_ATLAS){
+        AtlasBuild(atlas,res.size,st); res.atlasMs=atlas.buildMs; res.atlasKB=atlas.bytes/1024.0;
+        res.atlasBaked=atlas.baked; res.atlasKeys=atlas.keys;
+    }
+
+    // Fixed refresh-rate schedule, as the pacer would deliver on an idle machine.
+    std::vector<RingFrame> frames;
+    const float dt=1000.f/o.hz, dur=AnimDurationMs(speed);
+    for(int i=0;;i++){
+        RingFrame rf=RingFrameAt(std::min(i*dt/dur,1.f));
+        if(rf.done)break;
+        frames.push_back(rf);
+    }
+    res.frames=frames.size();
+
+    BenchSurface s; Surface_Init(s,res.size);
+    double total=0, best=1e300;
+    uint64_t allocs0=g_allocs.load();
+    for(int rep=0;rep<o.reps;rep++){
+        auto t0=std::chrono::steady_clock::now();
+        for(const RingFrame&rf:frames)Frame(s,mode,atlas,st,rf);
+        double ns=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count();
+        total+=ns; if(ns<best)best=ns;
+    }
+    const double n=(double)res.frames*o.reps;
+    res.allocsPerFrame=(double)(g_allocs.load()-allocs0)/n;
+    res.nsPerFrame=total/n;
+    res.bestNsPerFrame=best/(double)res.frames;
+    res.bytesPerFrame=(double)(s.damage.clearBytes+s.damage.uploadBytes+s.drawBytes)/n;
+    return res;
+}
+
+static bool ParseArgs(int argc,char**argv,BenchOptions&o)
+{
+    for(int i=1;i<argc;i++){
+        const char*a=argv[i]; const char*v=i+1<argc?argv[i+1]:nullptr;
+        if(!strcmp(a,"--json"))o.json=true;
+        else if(!strcmp(a,"--hsv"))o.hsv=true;
+        else if(!strcmp(a,"--spot"))o.spot=true;
+        else if(!strcmp(a,"--trail"))o.trail=true;
+        else if(!strcmp(a,"--contrast"))o.contrast=true;
+        else if(!strcmp(a,"--gamma"))o.gamma=true;
+        else if(!strcmp(a,"--glow"))o.glow=true;
+        else if(!strcmp(a,"--near"))o.near=true;
+        else if(!strcmp(a,"--damage"))o.damage=true;
+        else if(!strcmp(a,"--stats"))o.stats=true;
+        else if(!strcmp(a,"--glow-px")&&v){o.style.glow=(float)atof(v);i++;}
+        else if(!strcmp(a,"--desktop")&&v&&sscanf(v,"%dx%d",&o.deskW,&o.deskH)==2){i++;}
+        else if(!strcmp(a,"--scale")&&v){o.deskScale=(float)atof(v);i++;}
+        else if(!strcmp(a,"--reps")&&v){o.reps=std::max(1,atoi(v));i++;}
+        else if(!strcmp(a,"--hz")&&v){o.hz=std::max(1,atoi(v));i++;}
+        else if(!strcmp(a,"--ring")&&v){o.style.ringColor=(uint32_t)strtoul(v,nullptr,16);i++;}
+        else if(!strcmp(a,"--outline")&&v){o.style.outlineColor=(uint32_t)strtoul(v,nullptr,16);i++;}
+        else{fprintf(stderr,"usage: %s [--reps N] [--hz N] [--ring BBGGRR] [--outline BBGGRR] [--json] [--hsv]"
+                          " [--spot [--desktop WxH] [--scale S]] [--trail [--scale S]] [--contrast [--scale S]]"
+                          " [--gamma [--scale S]] [--glow] [--glow-px N] [--near] [--damage] [--stats]\n",
+                          argv[0]);return false;}
+    }
+    return true;
+}
+
+//  HSV
+static const int CP_SV_W = 280, CP_SV_H = 188;          // picker SV square, logical px
+
+struct HsvResult {
+    int      path;
+    double   nsPerPixel;
+    uint64_t mismatches;                               // batch != HSVtoRGB on the same input
+    uint64_t roundTrip;                                // HSVtoRGB(RGBtoHSV(c)) != c, any path
+};
+
+static HsvResult RunHsv(const BenchOptions&o,RasterPath path)
+{
+    HsvResult res={}; res.path=path;
+    // Every 24-bit colour through RGBtoHSV, then back through the batch kernel.
+    const int CHUNK=1<<16;
+    std::vector<float> h(CHUNK),s(CHUNK),v(CHUNK);
+    std::vector<uint32_t> out(CHUNK);
+    for(uint32_t base=0;base<(1u<<24);base+=CHUNK){
+        for(int i=0;i<CHUNK;i++)RGBtoHSV(base+i,h[i],s[i],v[i]);
+        HsvToBGRA(out.data(),h.data(),s.data(),v.data(),CHUNK,path);
+        for(int i=0;i<CHUNK;i++){
+            if(out[i]!=ColorToBGRA(HSVtoRGB(h[i],s[i],v[i])))res.mismatches++;
+            if(out[i]!=ColorToBGRA(base+i))res.roundTrip++;
+        }
+    }
+    // Ramps as the picker draws them: SV rows at a sweep of hues, and the hue bar.
+    for(int hue=0;hue<=360;hue++)
+        for(int y=0;y<CP_SV_H;y++){
+            float val=1.f-(float)y/(CP_SV_H-1);
+            HsvRamp rp={(float)hue,(float)hue,0,1,val,val};
+            HsvRowToBGRA(out.data(),CP_SV_W,rp,path);
+            for(int x=0;x<CP_SV_W;x++)
+                if(out[x]!=ColorToBGRA(HSVtoRGB((float)hue,(float)x/(CP_SV_W-1),val)))res.mismatches++;
+        }
+    HsvRamp bar={0,360,1,1,1,1};
+    HsvRowToBGRA(out.data(),CP_SV_W,bar,path);
+    for(int x=0;x<CP_SV_W;x++)
+        if(out[x]!=ColorToBGRA(HSVtoRGB((float)x/(CP_SV_W-1)*360.f,1,1)))res.mismatches++;
+
+    // Timing: one full SV square per rep.
+    std::vector<uint32_t> sq((size_t)CP_SV_W*CP_SV_H);
+    double best=1e300;
+    for(int rep=0;rep<o.reps*10;rep++){
+        auto t0=std::chrono::steady_clock::now();
+        for(int y=0;y<CP_SV_H;y++){
+            float val=1.f-(float)y/(CP_SV_H-1);
+            HsvRamp rp={(float)(rep%360),(float)(rep%360),0,1,val,val};
+            HsvRowToBGRA(sq.data()+(size_t)y*CP_SV_W,CP_SV_W,rp,path);
+        }
+        double ns=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count();
+        if(ns<best)best=ns;
+    }
+    res.nsPerPixel=best/((double)CP_SV_W*CP_SV_H);
+    return res;
+}
+
+static int MainHsv(const BenchOptions&o)
+{
+    std::vector<HsvResult> results;
+    results.push_back(RunHsv(o,RP_SCALAR));
+#if defined(BCF_SSE2)
+    results.push_back(RunHsv(o,RP_SSE2));
+#endif
+#if defined(BCF_AVX2)
+    if(CpuHasAVX2())results.push_back(RunHsv(o,RP_AVX2));
+#endif
+    bool ok=true;
+    if(o.json)printf("{\"hsv\":[\n");
+    else printf("path,ns_per_pixel,mismatches,round_trip_errors\n");
+    for(size_t i=0;i<results.size();i++){
+        const HsvResult&r=results[i];
+        ok=ok&&!r.mismatches;
+        if(o.json)printf("  {\"path\":\"%s\",\"ns_per_pixel\":%.3f,\"mismatches\":%llu,\"round_trip_errors\":%llu}%s\n",
+                         RasterPathName((RasterPath)r.path),r.nsPerPixel,(unsigned long long)r.mismatches,
+                         (unsigned long long)r.roundTrip,i+1<results.size()?",":"");
+        else printf("%s,%.3f,%llu,%llu\n",RasterPathName((RasterPath)r.path),r.nsPerPixel,
+                    (unsigned long long)r.mismatches,(unsigned long long)r.roundTrip);
+    }
+    if(o.json)printf("]}\n");
+    return ok?0:1;
+}
+
+//  SPOTLIGHT
+struct SpotResult {
+    const char*mode;
+    int      speed;
+    uint64_t frames;
+    double   nsPerFrame, bestNsPerFrame, rasteredPerFrame, filledPerFrame, uploadBytesPerFrame, fullBytes;
+    uint64_t mismatches;                               // tiled surface != Spot_Pixel reference
+};
+
+// The pointer drags right and down while the circle closes, as a user chasing it would.
+static std::vector<SpotCircle> SpotSchedule(const BenchOptions&o,int speed)
+{
+    std::vector<SpotCircle> v;
+    const float dt=1000.f/o.hz, dur=AnimDurationMs(speed);
+    for(int i=0;;i++){
+        float p=std::min(i*dt/dur,1.f);
+        SpotFrame sf=SpotFrameAt(p);
+        if(sf.done)break;
+        SpotCircle c; c.r=sf.r*o.deskScale;
+        c.cx=o.deskW*0.45f+p*700.f*o.deskScale; c.cy=o.deskH*0.5f+p*180.f*o.deskScale;
+        v.push_back(c);
+    }
+    return v;
+}
+
+static uint64_t SpotCheck(const SpotTiles&t,const uint32_t*bits,const SpotCircle&c)
+{
+    uint64_t bad=0;
+    for(int y=0;y<t.h;y++)
+        for(int x=0;x<t.w;x++)bad+=bits[(size_t)y*t.w+x]!=Spot_Pixel(t,x,y,c);
+    return bad;
+}
+
+static SpotResult RunSpot(const BenchOptions&o,int speed,bool naive)
+{
+    SpotResult res={}; res.mode=naive?"spot-naive":"spot-tiled"; res.speed=speed;
+    SpotStyle st; st.scale=o.deskScale;
+    std::vector<SpotCircle> frames=SpotSchedule(o,speed);
+    std::vector<uint32_t> bits((size_t)o.deskW*o.deskH);
+    IRect all; all.x1=o.deskW; all.y1=o.deskH;
+    SpotTiles t;
+    // Whole-surface frames cost ~100 MB each, so the baseline samples a few.
+    const size_t n=naive?std::min<size_t>(frames.size(),8):frames.size();
+    const int reps=naive?1:o.reps;
+    double total=0, best=1e300;
+    for(int rep=0;rep<reps;rep++){
+        Spot_Init(t,o.deskW,o.deskH,st,bits.data(),o.deskW);
+        auto t0=std::chrono::steady_clock::now();
+        for(size_t i=0;i<n;i++){
+            if(naive){Spot_Raster(t,bits.data(),o.deskW,all,frames[i]);t.stats.uploadBytes+=(uint64_t)o.deskW*o.deskH*4;}
+            else Spot_Update(t,bits.data(),o.deskW,frames[i]);
+        }
+        double ns=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count();
+        total+=ns; if(ns<best)best=ns;
+    }
+    // Correctness: replay once more and compare the whole surface at a spread of frames.
+    if(!naive){
+        Spot_Init(t,o.deskW,o.deskH,st,bits.data(),o.deskW);
+        for(size_t i=0;i<n;i++){
+            Spot_Update(t,bits.data(),o.deskW,frames[i]);
+            if(i%(n/6+1)==0||i+1==n)res.mismatches+=SpotCheck(t,bits.data(),frames[i]);
+        }
+    }
+    res.frames=n;
+    res.nsPerFrame=total/((double)n*reps);
+    res.bestNsPerFrame=best/(double)n;
+    res.rasteredPerFrame=naive?0:(double)t.stats.rastered/n;
+    res.filledPerFrame=naive?0:(double)t.stats.filled/n;
+    res.uploadBytesPerFrame=(double)t.stats.uploadBytes/n;
+    res.fullBytes=(double)o.deskW*o.deskH*4;
+    return res;
+}
+
+static int MainSpot(const BenchOptions&o)
+{
+    std::vector<SpotResult> results;
+    for(int speed=0;speed<3;speed++){results.push_back(RunSpot(o,speed,false));results.push_back(RunSpot(o,speed,true));}
+    bool ok=true;
+    if(o.json)printf("{\"desktop\":\"%dx%d\",\"scale\":%.2f,\"tile\":%d,\"spot\":[\n",o.deskW,o.deskH,o.deskScale,SPOT_TILE);
+    else printf("# desktop=%dx%d scale=%.2f tile=%d\nmode,speed,frames,ns_per_frame,best_ns_per_frame,"
+                "tiles_rastered,tiles_filled,upload_bytes_per_frame,full_bytes,mismatches\n",o.deskW,o.deskH,o.deskScale,SPOT_TILE);
+    for(size_t i=0;i<results.size();i++){
+        const SpotResult&r=results[i];
+        ok=ok&&!r.mismatches;
+        if(o.json)printf("  {\"mode\":\"%s\",\"speed\":%d,\"frames\":%llu,\"ns_per_frame\":%.1f,\"best_ns_per_frame\":%.1f,"
+                         "\"tiles_rastered\":%.1f,\"tiles_filled\":%.1f,\"upload_bytes_per_frame\":%.0f,\"full_bytes\":%.0f,"
+                         "\"mismatches\":%llu}%s\n",r.mode,r.speed,(unsigned long long)r.frames,r.nsPerFrame,r.bestNsPerFrame,
+                         r.rasteredPerFrame,r.filledPerFrame,r.uploadBytesPerFrame,r.fullBytes,
+                         (unsigned long long)r.mismatches,i+1<results.size()?",":"");
+        else printf("%s,%d,%llu,%.1f,%.1f,%.1f,%.1f,%.0f,%.0f,%llu\n",r.mode,r.speed,(unsigned long long)r.frames,
+                    r.nsPerFrame,r.bestNsPerFrame,r.rasteredPerFrame,r.filledPerFrame,r.uploadBytesPerFrame,r.fullBytes,
+                    (unsigned long long)r.mismatches);
+    }
+    if(o.json)printf("]}\n");
+    return ok?0:1;
+}
+
+//  TRAIL
+static const int TRAIL_MOUSE_HZ = 1000;                // raw input rate of a gaming mouse
+static const int TRAIL_SURF     = 2048;                // cap on the trail window, as in cursor_ring.cpp
+
+struct TrailResult {
+    const char*mode;
+    int      speed;                                    // px/s
+    uint64_t frames, segments;                         // per repetition
+    double   nsPerFrame, segsPerMs, allocsPerFrame;
+    uint64_t mismatches;                               // batched alpha != Capsule_Alpha reference
+};
+
+// Baseline: every segment evaluated over its whole bounding box.
+static void RasterNaive(uint32_t*bits,int stride,float ox,float oy,const TrailSegment*segs,int n)
+{
+    IRect b=Trail_Bounds(segs,n);
+    for(int i=0;i<n;i++){
+        IRect s=Trail_Bounds(segs+i,1);
+        for(int y=std::max(0,s.y0-b.y0);y<std::min(TRAIL_SURF,s.y1-b.y0);y++)
+            for(int x=std::max(0,s.x0-b.x0);x<std::min(TRAIL_SURF,s.x1-b.x0);x++){
+                uint32_t&p=bits[(size_t)y*stride+x];
+                int a=Capsule_Alpha((float)x+0.5f+ox,(float)y+0.5f+oy,segs+i,1);
+                if(a>(int)(p>>24))p=(uint32_t)a<<24|0xFFFFFF;
+            }
+    }
+}
+
+// The pointer circles a loop at `speed` px/s; frames run at the bench rate, samples at 1 kHz.
+static TrailResult RunTrail(const BenchOptions&o,int speed,bool naive)
+{
+    TrailResult res={}; res.mode=naive?"trail-naive":"trail-batched"; res.speed=speed;
+    TrailStyle st; st.scale=o.deskScale;
+    std::vector<uint32_t> bits((size_t)TRAIL_SURF*TRAIL_SURF);
+    static TrailSegment segs[TRAIL_CAP];
+    const int64_t frameNs=1000000000LL/o.hz, sampleNs=1000000000LL/TRAIL_MOUSE_HZ, durNs=2000000000LL;
+    const float R=600.f*o.deskScale, w=speed*o.deskScale/R;
+    double total=0;
+    for(int rep=0;rep<o.reps;rep++){
+        TrailHistory h; int64_t tS=0; IRect drawn;
+        std::fill(bits.begin(),bits.end(),0u);
+        uint64_t allocs0=g_allocs.load(); double ns=0;
+        for(int64_t t=0;t<durNs;t+=frameNs){
+            for(;tS<=t;tS+=sampleNs){float a=w*(float)tS*1e-9f;Trail_Add(h,tS,2000.f+R*cosf(a),2000.f+R*sinf(a));}
+            auto t0=std::chrono::steady_clock::now();
+            int n=Trail_Build(h,t,st,segs,TRAIL_CAP);
+            IRect b=Trail_Bounds(segs,n);
+            for(int y=drawn.y0;y<drawn.y1;y++)std::fill(&bits[(size_t)y*TRAIL_SURF+drawn.x0],&bits[(size_t)y*TRAIL_SURF+drawn.x1],0u);
+            if(naive){RasterNaive(bits.data(),TRAIL_SURF,(float)b.x0,(float)b.y0,segs,n);drawn=b;drawn.x1-=b.x0;drawn.y1-=b.y0;drawn.x0=drawn.y0=0;
+                      drawn.x1=std::min(drawn.x1,TRAIL_SURF);drawn.y1=std::min(drawn.y1,TRAIL_SURF);}
+            else drawn=RasterCapsules(bits.data(),TRAIL_SURF,TRAIL_SURF,TRAIL_SURF,(float)b.x0,(float)b.y0,segs,n,st.color);
+            ns+=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count();
+            if(!rep){
+                res.frames++; res.segments+=(uint64_t)n;
+                // Correctness: the whole drawn box, a few frames in.
+                if(!naive&&res.frames%20==7)
+                    for(int y=0;y<std::min(TRAIL_SURF,b.y1-b.y0);y++)
+                        for(int x=0;x<std::min(TRAIL_SURF,b.x1-b.x0);x++)
+                            res.mismatches+=(int)(bits[(size_t)y*TRAIL_SURF+x]>>24)!=
+                                            Capsule_Alpha((float)(x+b.x0)+0.5f,(float)(y+b.y0)+0.5f,segs,n);
+            }
+        }
+        if(!rep)res.allocsPerFrame=(double)(g_allocs.load()-allocs0)/res.frames;
+        total+=ns;
+    }
+    res.nsPerFrame=total/((double)res.frames*o.reps);
+    res.segsPerMs=res.nsPerFrame>0?(double)res.segments/res.frames/res.nsPerFrame*1e6:0;
+    return res;
+}
+
+static int MainTrail(const BenchOptions&o)
+{
+    static const int speeds[]={1500,4000,9000};
+    std::vector<TrailResult> results;
+    for(int s:speeds){results.push_back(RunTrail(o,s,false));results.push_back(RunTrail(o,s,true));}
+    bool ok=true;
+    if(o.json)printf("{\"hz\":%d,\"scale\":%.2f,\"trail\":[\n",o.hz,o.deskScale);
+    else printf("# hz=%d scale=%.2f\nmode,speed,frames,segments_per_frame,ns_per_frame,segments_per_ms,allocs_per_frame,mismatches\n",
+                o.hz,o.deskScale);
+    for(size_t i=0;i<results.size();i++){
+        const TrailResult&r=results[i];
+        ok=ok&&!r.mismatches&&!r.allocsPerFrame;
+        double spf=(double)r.segments/r.frames;
+        if(o.json)printf("  {\"mode\":\"%s\",\"speed\":%d,\"frames\":%llu,\"segments_per_frame\":%.1f,\"ns_per_frame\":%.1f,"
+                         "\"segments_per_ms\":%.0f,\"allocs_per_frame\":%.3f,\"mismatches\":%llu}%s\n",r.mode,r.speed,
+                         (unsigned long long)r.frames,spf,r.nsPerFrame,r.segsPerMs,r.allocsPerFrame,
+                         (unsigned long long)r.mismatches,i+1<results.size()?",":"");
+        else printf("%s,%d,%llu,%.1f,%.1f,%.0f,%.3f,%llu\n",r.mode,r.speed,(unsigned long long)r.frames,spf,
+                    r.nsPerFrame,r.segsPerMs,r.allocsPerFrame,(unsigned long long)r.mismatches);
+    }
+    if(o.json)printf("]}\n");
+    return ok?0:1;
+}
+
+//  CONTRAST
+enum Scene { SC_DOCUMENT, SC_IDE, SC_PHOTO, SC_GREY, SC_CHECKER, SC_COUNT };
+static const char*SceneName(int s){static const char*n[]={"document","ide","photo","grey","checker"};return n[s];}
+
+static uint32_t Lcg(uint32_t&s){s=s*1664525u+1013904223u;return s>>8;}
+static uint32_t Bgra(int r,int g,int b){return 0xFF000000u|(uint32_t)std::min(255,std::max(0,r))<<16|
+                                               (uint32_t)std::min(255,std::max(0,g))<<8|(uint32_t)std::min(255,std::max(0,b));}
+
+// Text is rows of glyph-sized blocks on the page colour; the photo is a noisy sky over ground.
+static void SceneFill(std::vector<uint32_t>&px,int w,int h,int scene)
+{
+    uint32_t seed=0x9E3779B9u+(uint32_t)scene;
+    for(int y=0;y<h;y++)
+        for(int x=0;x<w;x++){
+            uint32_t&p=px[(size_t)y*w+x];
+            bool glyph=(y%18)<11&&(x/7+y/18*3)%9!=0&&Lcg(seed)%5==0;
+            int n=(int)(Lcg(seed)%41)-20;
+            switch(scene){
+            case SC_DOCUMENT: p=glyph?Bgra(30,30,30):Bgra(250,250,250); break;
+            case SC_IDE:      p=glyph?Bgra(156+n,220+n,254):Bgra(30,30,30); break;
+            case SC_PHOTO:    p=y<h/2?Bgra(110+n+y/4,170+n+y/8,235+n):Bgra(70+n,95+n+x/16,40+n); break;
+            case SC_GREY:     p=Bgra(128+n,128+n,128+n); break;
+            case SC_CHECKER:  p=((x/8+y/8)&1)?Bgra(255,255,255):Bgra(0,0,0); break;
+            }
+        }
+}
+
+struct ContrastResult {
+    int      scene, path, step;
+    double   nsPerCapture, mpixPerSec, mean, stddev;
+    int      choice;
+    uint64_t mismatches;                               // sums != scalar path on the same capture
+};
+
+static int MainContrast(const BenchOptions&o)
+{
+    // What the app captures: the overlay square under the pointer.
+    const int sz=(int)lroundf(OV_SIZE*o.deskScale);
+    std::vector<uint32_t> px((size_t)sz*sz);
+    static const int steps[]={1,2,4};
+    static const RasterPath paths[]={RP_SCALAR,RP_SSE2,RP_AVX2};
+    // Expected picks for the default white ring on a black outline.
+    static const int expect[SC_COUNT]={CC_SWAP,CC_CONFIG,-1,CC_CONFIG,-1};
+    std::vector<ContrastResult> results;
+    bool ok=true;
+    for(int sc=0;sc<SC_COUNT;sc++){
+        SceneFill(px,sz,sz,sc);
+        for(int step:steps){
+            LumaStats ref; LumaMeasure(px.data(),sz,sz,sz,step,ref,RP_SCALAR);
+            for(RasterPath p:paths){
+                if(p==RP_AVX2&&RasterBestPath()!=RP_AVX2)continue;
+                ContrastResult r={}; r.scene=sc; r.path=p; r.step=step;
+                LumaStats st;
+                double best=1e300;
+                for(int rep=0;rep<o.reps;rep++){
+                    LumaStats s;
+                    auto t0=std::chrono::steady_clock::now();
+                    for(int k=0;k<16;k++){s=LumaStats();LumaMeasure(px.data(),sz,sz,sz,step,s,p);}
+                    double ns=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count()/16;
+                    if(ns<best)best=ns;
+                    st=s;
+                }
+                r.nsPerCapture=best; r.mpixPerSec=(double)st.n/best*1e3;
+                r.mean=LumaMean(st); r.stddev=LumaStdDev(st);
+                r.mismatches=(st.n!=ref.n)+(st.sum!=ref.sum)+(st.sumSq!=ref.sumSq);
+                r.choice=ContrastPick(st,o.style.ringColor,o.style.outlineColor,CC_CONFIG);
+                ok=ok&&!r.mismatches&&(expect[sc]<0||o.style.ringColor!=0x00FFFFFF||o.style.outlineColor||r.choice==expect[sc]);
+                results.push_back(r);
+            }
+        }
+    }
+    if(o.json)printf("{\"capture\":%d,\"contrast\":[\n",sz);
+    else printf("# capture=%dx%d\nscene,path,step,ns_per_capture,mpix_per_s,mean_luma,stddev,choice,mismatches\n",sz,sz);
+    for(size_t i=0;i<results.size();i++){
+        const ContrastResult&r=results[i];
+        if(o.json)printf("  {\"scene\":\"%s\",\"path\":\"%s\",\"step\":%d,\"ns_per_capture\":%.1f,\"mpix_per_s\":%.0f,"
+                         "\"mean_luma\":%.1f,\"stddev\":%.1f,\"choice\":\"%s\",\"mismatches\":%llu}%s\n",
+                         SceneName(r.scene),RasterPathName((RasterPath)r.path),r.step,r.nsPerCapture,r.mpixPerSec,
+                         r.mean,r.stddev,ContrastName(r.choice),(unsigned long long)r.mismatches,i+1<results.size()?",":"");
+        else printf("%s,%s,%d,%.1f,%.0f,%.1f,%.1f,%s,%llu\n",SceneName(r.scene),RasterPathName((RasterPath)r.path),r.step,
+                    r.nsPerCapture,r.mpixPerSec,r.mean,r.stddev,ContrastName(r.choice),(unsigned long long)r.mismatches);
+    }
+    if(o.json)printf("]}\n");
+    return ok?0:1;
+}
+
+//  GAMMA
+static const int GAMMA_MAX_ERR = 2;                     // levels, linear path against its reference
+
+struct GammaAccuracy {
+    uint32_t ring, outline;
+    int      maxErr[2];                                 // sRGB path, linear path
+    double   meanErr[2];
+    uint64_t pixels;
+};
+struct GammaTiming {
+    int      path;
+    double   srgbNs, linearNs, pixels;                  // per frame
+    uint64_t mismatches;                                // linear pixels != the scalar path
+};
+
+static std::vector<RingFrame> GammaFrames(int speed)
+{
+    std::vector<RingFrame> frames;
+    const float dt=1000.f/144, dur=AnimDurationMs(speed);
+    for(int i=0;;i++){
+        RingFrame rf=RingFrameAt(std::min(i*dt/dur,1.f));
+        if(rf.done)break;
+        frames.push_back(rf);
+    }
+    return frames;
+}
+
+static int ChannelErr(uint32_t a,uint32_t b)
+{
+    int m=0;
+    for(int s=0;s<32;s+=8)m=std::max(m,abs((int)(a>>s&255)-(int)(b>>s&255)));
+    return m;
+}
+
+static GammaAccuracy RunGammaAccuracy(uint32_t ring,uint32_t outline,float scale)
+{
+    GammaAccuracy res={}; res.ring=ring; res.outline=outline;
+    const int size=(int)(OV_SIZE*scale); const float c=size/2.f;
+    std::vector<uint32_t> px((size_t)size*size);
+    std::vector<RingFrame> frames=GammaFrames(1);
+    double sum[2]={};
+    for(int lin=0;lin<2;lin++){
+        RingStyle st; st.ringColor=ring; st.outlineColor=outline; st.scale=scale; st.linear=lin!=0;
+        for(size_t i=0;i<frames.size();i+=4){
+            const RingFrame&rf=frames[i]; const float r=rf.r*scale;
+            std::fill(px.begin(),px.end(),0u);
+            IRect box=RasterRing(px.data(),size,size,size,c,c,r,rf.alpha,st,RP_SCALAR);
+            for(int y=box.y0;y<box.y1;y++)
+                for(int x=box.x0;x<box.x1;x++){
+                    uint32_t ref=RingPixel(x,y,c,c,r,rf.alpha,st);
+                    if(!ref&&!px[(size_t)y*size+x])continue;
+                    int e=ChannelErr(px[(size_t)y*size+x],ref);
+                    res.maxErr[lin]=std::max(res.maxErr[lin],e); sum[lin]+=e;
+                    if(lin)res.pixels++;
+                }
+        }
+    }
+    for(int lin=0;lin<2;lin++)res.meanErr[lin]=res.pixels?sum[lin]/res.pixels:0;
+    return res;
+}
+
+static GammaTiming RunGammaTiming(const BenchOptions&o,RasterPath path,float scale)
+{
+    GammaTiming res={}; res.path=path;
+    const int size=(int)(OV_SIZE*scale); const float c=size/2.f;
+    std::vector<uint32_t> px((size_t)size*size,0), ref((size_t)size*size,0);
+    std::vector<RingFrame> frames=GammaFrames(1);
+    RingStyle st=o.style; st.scale=scale;
+    for(const RingFrame&rf:frames){
+        st.linear=true;
+        IRect box=RasterRing(px.data(),size,size,size,c,c,rf.r*scale,rf.alpha,st,path);
+        RasterRing(ref.data(),size,size,size,c,c,rf.r*scale,rf.alpha,st,RP_SCALAR);
+        for(int y=box.y0;y<box.y1;y++)
+            for(int x=box.x0;x<box.x1;x++)res.mismatches+=px[(size_t)y*size+x]!=ref[(size_t)y*size+x];
+        res.pixels+=IRectArea(box);
+    }
+    res.pixels/=(double)frames.size();
+    for(int lin=0;lin<2;lin++){
+        st.linear=lin!=0;
+        double best=1e300;
+        for(int rep=0;rep<o.reps;rep++){
+            auto t0=std::chrono::steady_clock::now();
+            for(const RingFrame&rf:frames)RasterRing(px.data(),size,size,size,c,c,rf.r*scale,rf.alpha,st,path);
+            double ns=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count();
+            best=std::min(best,ns);
+        }
+        (lin?res.linearNs:res.srgbNs)=best/(double)frames.size();
+    }
+    return res;
+}
+
+static int MainGamma(const BenchOptions&o)
+{
+    const float scale=o.deskScale<1?1.f:o.deskScale;
+    // Tables against the exact functions: decode error, encode rounding, and 8-bit round trips.
+    double decErr=0; uint64_t encBad=0, tripBad=0;
+    for(int v=0;v<256;v++){
+        decErr=std::max(decErr,fabs(SrgbToLinear(v)-SrgbDecode(v/255.0)));
+        if(LinearToSrgb(SrgbToLinear(v))!=v)tripBad++;
+    }
+    for(int i=0;i<=SRGB_LIN_MAX;i++)
+        if(g_srgb.toSrgb[i]!=(int)(SrgbEncode((double)i/SRGB_LIN_MAX)*255+.5))encBad++;
+
+    const uint32_t pairs[][2]={{o.style.ringColor,o.style.outlineColor},{0x00FFFFFF,0x00000000},
+                               {0x0000FFFF,0x00800000},{0x000080FF,0x00FFFFFF},{0x0000FF00,0x00FF00FF}};
+    std::vector<GammaAccuracy> acc;
+    for(size_t i=0;i<sizeof pairs/sizeof*pairs;i++){
+        if(i&&pairs[i][0]==pairs[0][0]&&pairs[i][1]==pairs[0][1])continue;
+        acc.push_back(RunGammaAccuracy(pairs[i][0],pairs[i][1],scale));
+    }
+    std::vector<GammaTiming> tim;
+    tim.push_back(RunGammaTiming(o,RP_SCALAR,scale));
+#if defined(BCF_SSE2)
+    tim.push_back(RunGammaTiming(o,RP_SSE2,scale));
+#endif
+#if defined(BCF_AVX2)
+    if(CpuHasAVX2())tim.push_back(RunGammaTiming(o,RP_AVX2,scale));
+#endif
+
+    bool ok=decErr<1e-6&&!encBad&&!tripBad;
+    for(const GammaAccuracy&a:acc)ok=ok&&a.maxErr[1]<=GAMMA_MAX_ERR;
+    for(const GammaTiming&t:tim)ok=ok&&!t.mismatches;
+    if(o.json){
+        printf("{\"scale\":%.2f,\"decode_max_err\":%.2e,\"encode_mismatches\":%llu,\"round_trip_errors\":%llu,\"accuracy\":[\n",
+               scale,decErr,(unsigned long long)encBad,(unsigned long long)tripBad);
+        for(size_t i=0;i<acc.size();i++){
+            const GammaAccuracy&a=acc[i];
+            printf("  {\"ring\":\"%06X\",\"outline\":\"%06X\",\"pixels\":%llu,\"srgb_max_err\":%d,\"srgb_mean_err\":%.3f,"
+                   "\"linear_max_err\":%d,\"linear_mean_err\":%.3f}%s\n",a.ring,a.outline,(unsigned long long)a.pixels,
+                   a.maxErr[0],a.meanErr[0],a.maxErr[1],a.meanErr[1],i+1<acc.size()?",":"");
+        }
+        printf("],\"timing\":[\n");
+        for(size_t i=0;i<tim.size();i++){
+            const GammaTiming&t=tim[i];
+            printf("  {\"path\":\"%s\",\"pixels_per_frame\":%.0f,\"srgb_ns_per_frame\":%.0f,\"linear_ns_per_frame\":%.0f,"
+                   "\"srgb_ns_per_pixel\":%.3f,\"linear_ns_per_pixel\":%.3f,\"mismatches\":%llu}%s\n",
+                   RasterPathName((RasterPath)t.path),t.pixels,t.srgbNs,t.linearNs,t.srgbNs/t.pixels,t.linearNs/t.pixels,
+                   (unsigned long long)t.mismatches,i+1<tim.size()?",":"");
+        }
+        printf("]}\n");
+        return ok?0:1;
+    }
+    printf("# decode_max_err=%.2e encode_mismatches=%llu round_trip_errors=%llu scale=%.2f\n",
+           decErr,(unsigned long long)encBad,(unsigned long long)tripBad,scale);
+    printf("ring,outline,pixels,srgb_max_err,srgb_mean_err,linear_max_err,linear_mean_err\n");
+    for(const GammaAccuracy&a:acc)
+        printf("%06X,%06X,%llu,%d,%.3f,%d,%.3f\n",a.ring,a.outline,(unsigned long long)a.pixels,
+               a.maxErr[0],a.meanErr[0],a.maxErr[1],a.meanErr[1]);
+    printf("path,pixels_per_frame,srgb_ns_per_frame,linear_ns_per_frame,srgb_ns_per_pixel,linear_ns_per_pixel,mismatches\n");
+    for(const GammaTiming&t:tim)
+        printf("%s,%.0f,%.0f,%.0f,%.3f,%.3f,%llu\n",RasterPathName((RasterPath)t.path),t.pixels,t.srgbNs,t.linearNs,
+               t.srgbNs/t.pixels,t.linearNs/t.pixels,(unsigned long long)t.mismatches);
+    return ok?0:1;
+}
+
+//  GLOW
+static const double GLOW_MAX_ERR   = 1e-4;                // blur against direct box sums
+static const double GLOW_MAX_GAUSS = 0.06;                // three boxes against a Gaussian, of peak
+
+struct BlurResult {
+    int      size, k, path;
+    double   ns, maxErr, gaussDev;
+    uint64_t mismatches;                                  // floats != the scalar path
+};
+struct GlowCacheResult { int scale, buckets, rebuilt; double warmMs; };
+
+// The glow source at the largest animation radius, centred on a pixel centre.
+static std::vector<float> GlowMask(int size,float r,float hw)
+{
+    std::vector<float> m((size_t)size*size);
+    const int c=size/2;
+    for(int y=0;y<size;y++)
+        for(int x=0;x<size;x++){
+            const float d=sqrtf((float)((x-c)*(x-c)+(y-c)*(y-c)));
+            m[(size_t)y*size+x]=std::min(std::max(hw+.5f-fabsf(d-r),0.f),1.f);
+        }
+    return m;
+}
+
+// Three direct box passes along one axis in double; zero past the edges.
+static void BoxRef(std::vector<double>&a,int w,int h,int k,bool rows)
+{
+    std::vector<double> t(a.size());
+    for(int pass=0;pass<3;pass++){
+        for(int y=0;y<h;y++)
+            for(int x=0;x<w;x++){
+                double s=0;
+                for(int i=-k;i<=k;i++){
+                    const int xx=rows?x+i:x, yy=rows?y:y+i;
+                    if(xx>=0&&xx<w&&yy>=0&&yy<h)s+=a[(size_t)yy*w+xx];
+                }
+                t[(size_t)y*w+x]=s/(2*k+1);
+            }
+        a.swap(t);
+    }
+}
+
+// Largest gap along the centre row between the box blur and a Gaussian of the same sigma,
+// as a fraction of the Gaussian's peak.
+static double GaussDeviation(const std::vector<float>&mask,const std::vector<double>&box,int size,int k)
+{
+    const double sig=BlurSigma(k); const int W=(int)ceil(4*sig), c=size/2;
+    std::vector<double> g((size_t)2*W+1);
+    double gs=0; for(int i=-W;i<=W;i++)gs+=g[i+W]=exp(-i*i/(2*sig*sig));
+    std::vector<double> row(size,0.);
+    double peak=0, dev=0;
+    for(int x=0;x<size;x++){
+        double s=0;
+        for(int j=-W;j<=W;j++)
+            for(int i=-W;i<=W;i++){
+                const int xx=x+i, yy=c+j;
+                if(xx>=0&&xx<size&&yy>=0&&yy<size)s+=g[i+W]*g[j+W]*mask[(size_t)yy*size+xx];
+            }
+        row[x]=s/(gs*gs); peak=std::max(peak,row[x]);
+    }
+    for(int x=0;x<size;x++)dev=std::max(dev,fabs(row[x]-box[(size_t)c*size+x]));
+    return peak>0?dev/peak:0;
+}
+
+static void RunBlur(const BenchOptions&o,int scale,std::vector<BlurResult>&out)
+{
+    const int size=OV_SIZE*scale, k=std::max(1,(int)lroundf(o.style.glow*scale/3.f));
+    const std::vector<float> mask=GlowMask(size,ANIM_MAX_R*scale,o.style.stroke*scale*.5f);
+    std::vector<double> ref(mask.begin(),mask.end());
+    BoxRef(ref,size,size,k,false); BoxRef(ref,size,size,k,true);
+    const double dev=GaussDeviation(mask,ref,size,k);
+
+    std::vector<float> a(mask.size()), scalar, scratch(BlurScratchFloats(size,size,k));
+    std::vector<RasterPath> paths={RP_SCALAR};
+#if defined(BCF_SSE2)
+    paths.push_back(RP_SSE2);
+#endif
+#if defined(BCF_AVX2)
+    if(CpuHasAVX2())paths.push_back(RP_AVX2);
+#endif
+    for(RasterPath p:paths){
+        BlurResult res={}; res.size=size; res.k=k; res.path=p; res.gaussDev=dev;
+        double best=1e300;
+        for(int rep=0;rep<o.reps;rep++){
+            a=mask;
+            auto t0=std::chrono::steady_clock::now();
+            BlurAlpha(a.data(),size,size,k,scratch.data(),p);
+            best=std::min(best,std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count());
+        }
+        res.ns=best;
+        if(p==RP_SCALAR)scalar=a;
+        for(size_t i=0;i<a.size();i++){
+            res.mismatches+=memcmp(&a[i],&scalar[i],sizeof(float))!=0;
+            res.maxErr=std::max(res.maxErr,fabs(a[i]-ref[i]));
+        }
+        out.push_back(res);
+    }
+}
+
+static GlowCacheResult RunGlowCache(const BenchOptions&o,int scale)
+{
+    GlowCacheResult res={}; res.scale=scale;
+    RingStyle st=o.style; st.scale=(float)scale;
+    RingStyle other=st; other.stroke+=1.f;
+    RingGlowWarm(other,0);                                // a different style drops the cache
+    auto t0=std::chrono::steady_clock::now();
+    res.buckets=RingGlowWarm(st,ANIM_MAX_R*scale);
+    res.warmMs=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+    res.rebuilt=RingGlowWarm(st,ANIM_MAX_R*scale);
+    return res;
+}
+
+static int MainGlow(const BenchOptions&o)
+{
+    std::vector<BlurResult> blur;
+    std::vector<GlowCacheResult> cache;
+    for(int scale=1;scale<=3;scale++){RunBlur(o,scale,blur);cache.push_back(RunGlowCache(o,scale));}
+
+    bool ok=o.style.glow>0;
+    for(const BlurResult&b:blur)ok=ok&&!b.mismatches&&b.maxErr<=GLOW_MAX_ERR&&b.gaussDev<=GLOW_MAX_GAUSS;
+    for(const GlowCacheResult&c:cache)ok=ok&&c.buckets>0&&!c.rebuilt;
+    if(o.json){
+        printf("{\"glow_px\":%.1f,\"blur\":[\n",o.style.glow);
+        for(size_t i=0;i<blur.size();i++){
+            const BlurResult&b=blur[i];
+            printf("  {\"size\":%d,\"k\":%d,\"sigma\":%.2f,\"path\":\"%s\",\"ns_per_blur\":%.0f,\"ns_per_pixel\":%.3f,"
+                   "\"max_err\":%.2e,\"gauss_dev\":%.4f,\"mismatches\":%llu}%s\n",b.size,b.k,BlurSigma(b.k),
+                   RasterPathName((RasterPath)b.path),b.ns,b.ns/((double)b.size*b.size),b.maxErr,b.gaussDev,
+                   (unsigned long long)b.mismatches,i+1<blur.size()?",":"");
+        }
+        printf("],\"profiles\":[\n");
+        for(size_t i=0;i<cache.size();i++){
+            const GlowCacheResult&c=cache[i];
+            printf("  {\"scale\":%d,\"buckets\":%d,\"build_ms\":%.3f,\"rebuilt\":%d}%s\n",
+                   c.scale,c.buckets,c.warmMs,c.rebuilt,i+1<cache.size()?",":"");
+        }
+        printf("]}\n");
+        return ok?0:1;
+    }
+    printf("# glow_px=%.1f\nsize,k,sigma,path,ns_per_blur,ns_per_pixel,max_err,gauss_dev,mismatches\n",o.style.glow);
+    for(const BlurResult&b:blur)
+        printf("%d,%d,%.2f,%s,%.0f,%.3f,%.2e,%.4f,%llu\n",b.size,b.k,BlurSigma(b.k),RasterPathName((RasterPath)b.path),
+               b.ns,b.ns/((double)b.size*b.size),b.maxErr,b.gaussDev,(unsigned long long)b.mismatches);
+    printf("scale,buckets,build_ms,rebuilt\n");
+    for(const GlowCacheResult&c:cache)printf("%d,%d,%.3f,%d\n",c.scale,c.buckets,c.warmMs,c.rebuilt);
+    return ok?0:1;
+}
+
+//  NEAR LOOKUP
+// Under GOV_REDUCED a key the atlas lacks is filled from AtlasLookupNear. Every scheduled
+// frame is looked up in the real atlas and in one holding only the outer half of the radii,
+// which is where an over-budget bake used to stop; a frame more than one radius step from
+// the request fails the run.
+static const int NEAR_MAX_STEPS = 1;                    // independent of ATLAS_NEAR_STEPS on purpose
+
+struct NearResult {
+    int         scale;
+    const char* atlas;
+    int         keys, queries, hits, far;
+    float       worstPx;                               // largest |baked r - requested r| returned
+};
+
+static void OuterHalfAtlas(RingAtlas&a,int scale)
+{
+    a.size=OV_SIZE*scale; a.maxR=ANIM_MAX_R*scale; a.rStep=ATLAS_R_STEP*scale;
+    const int rLevels=(int)(a.maxR/a.rStep+.5f)+1;
+    a.index.assign((size_t)rLevels*ATLAS_A_LEVELS,-1);
+    for(int i=0;i<=8192;i++){
+        RingFrame rf=RingFrameAt(i/8192.f);
+        if(rf.done)break;
+        const int rk=(int)(rf.r*scale/a.rStep+.5f), ak=(int)(Clamp01(rf.alpha)*(ATLAS_A_LEVELS-1)+.5f);
+        int&slot=a.index[(size_t)rk*ATLAS_A_LEVELS+ak];
+        if(rk*2<rLevels||slot>=0)continue;
+        slot=(int)a.frames.size(); a.frames.push_back(AtlasFrame());
+    }
+    a.keys=a.baked=(int)a.frames.size();
+}
+
+static NearResult CheckNear(const BenchOptions&o,const RingAtlas&a,int scale,const char*name)
+{
+    NearResult res={}; res.scale=scale; res.atlas=name; res.keys=(int)a.frames.size();
+    std::vector<int> rkOf(a.frames.size());
+    for(size_t k=0;k<a.index.size();k++)if(a.index[k]>=0)rkOf[a.index[k]]=(int)(k/ATLAS_A_LEVELS);
+    const float dt=1000.f/o.hz;
+    for(int speed=0;speed<3;speed++){
+        const float dur=AnimDurationMs(speed);
+        for(int i=0;;i++){
+            RingFrame rf=RingFrameAt(std::min(i*dt/dur,1.f));
+            if(rf.done)break;
+            const float r=rf.r*scale;
+            const AtlasFrame*f=AtlasLookupNear(a,r,rf.alpha);
+            res.queries++;
+            if(!f)continue;
+            const float off=fabsf(rkOf[f-a.frames.data()]*a.rStep-r);
+            res.hits++; res.worstPx=std::max(res.worstPx,off);
+            if(off>(NEAR_MAX_STEPS+.5f)*a.rStep)res.far++;
+        }
+    }
+    return res;
+}
+
+static int MainNear(const BenchOptions&o)
+{
+    std::vector<NearResult> results;
+    for(int scale=1;scale<=3;scale++){
+        RingStyle st=o.style; st.scale=(float)scale;
+        RingAtlas full,outer;
+        AtlasBuild(full,OV_SIZE*scale,st); OuterHalfAtlas(outer,scale);
+        results.push_back(CheckNear(o,full,scale,"full"));
+        results.push_back(CheckNear(o,outer,scale,"outer-half"));
+    }
+    bool ok=true;
+    for(const NearResult&r:results)ok=ok&&!r.far;
+    if(o.json){
+        printf("{\"hz\":%d,\"max_steps\":%d,\"results\":[\n",o.hz,NEAR_MAX_STEPS);
+        for(size_t i=0;i<results.size();i++){
+            const NearResult&r=results[i];
+            printf("  {\"scale\":%d,\"atlas\":\"%s\",\"keys\":%d,\"queries\":%d,\"hits\":%d,\"far\":%d,"
+                   "\"worst_px\":%.2f}%s\n",r.scale,r.atlas,r.keys,r.queries,r.hits,r.far,r.worstPx,
+                   i+1<results.size()?",":"");
+        }
+        printf("]}\n");
+        return ok?0:1;
+    }
+    printf("# hz=%d max_steps=%d\nscale,atlas,keys,queries,hits,far,worst_px\n",o.hz,NEAR_MAX_STEPS);
+    for(const NearResult&r:results)
+        printf("%d,%s,%d,%d,%d,%d,%.2f\n",r.scale,r.atlas,r.keys,r.queries,r.hits,r.far,r.worstPx);
+    return ok?0:1;
+}
+
+//  DAMAGE
+// Rect helpers and the clear/upload rects the overlay depends on, checked on fixed cases
+// (empty, clipped, out of bounds, touching, contained) and on random rects around a 16 px
+// surface against per-pixel sets.
+struct DamageCase { const char*name; IRect got, want; };
+
+static IRect R(int x0,int y0,int x1,int y1){IRect r; r.x0=x0; r.y0=y0; r.x1=x1; r.y1=y1; return r;}
+static bool SameRect(const IRect&a,const IRect&b){return a.x0==b.x0&&a.y0==b.y0&&a.x1==b.x1&&a.y1==b.y1;}
+static bool Inside(const IRect&r,int x,int y){return x>=r.x0&&x<r.x1&&y>=r.y0&&y<r.y1;}
+
+struct DamageResult { const char*check; uint64_t cases, mismatches; };
+
+static int MainDamage(const BenchOptions&o)
+{
+    const int S=16;
+    const IRect none, full=R(0,0,S,S), mid=R(S/2,S/2,S/2+1,S/2+1);
+    const DamageCase fixed[]={
+        {"intersect overlap",   IRectIntersect(R(0,0,8,8),R(4,4,12,12)),  R(4,4,8,8)},
+        {"intersect contained", IRectIntersect(R(0,0,8,8),R(2,3,5,6)),    R(2,3,5,6)},
+        {"intersect touching",  IRectIntersect(R(0,0,8,8),R(8,0,12,8)),   none},
+        {"intersect disjoint",  IRectIntersect(R(0,0,4,4),R(10,10,12,12)),none},
+        {"intersect empty",     IRectIntersect(R(5,5,5,9),R(0,0,16,16)),  none},
+        {"union disjoint",      IRectUnion(R(0,0,2,2),R(10,12,14,13)),    R(0,0,14,13)},
+        {"union contained",     IRectUnion(R(0,0,8,8),R(2,2,4,4)),        R(0,0,8,8)},
+        {"union empty left",    IRectUnion(none,R(3,4,5,6)),              R(3,4,5,6)},
+        {"union empty right",   IRectUnion(R(3,4,5,6),R(9,9,9,12)),       R(3,4,5,6)},
+        {"clear empty",         DamageClearRect(none,S),                  none},
+        {"clear inside",        DamageClearRect(R(2,3,9,10),S),           R(2,3,9,10)},
+        {"clear clipped",       DamageClearRect(R(-5,12,4,40),S),         R(0,12,4,16)},
+        {"clear cover",         DamageClearRect(R(-1,-1,S+1,S+1),S),      full},
+        {"clear outside",       DamageClearRect(R(-9,-9,-1,-1),S),        none},
+        {"clear past edge",     DamageClearRect(R(S,0,S+4,S),S),          none},
+        {"upload inside",       DamageUploadRect(R(1,2,3,4),S),           R(1,2,3,4)},
+        {"upload clipped",      DamageUploadRect(R(10,-3,30,5),S),        R(10,0,S,5)},
+        {"upload empty",        DamageUploadRect(none,S),                 mid},
+        {"upload outside",      DamageUploadRect(R(S+2,0,S+9,S),S),       mid},
+    };
+    std::vector<DamageResult> results;
+    DamageResult fx={"fixed",0,0};
+    for(const DamageCase&c:fixed){
+        fx.cases++;
+        if(!SameRect(c.got,c.want)){
+            fx.mismatches++;
+            fprintf(stderr,"%s: got %d,%d,%d,%d want %d,%d,%d,%d\n",c.name,c.got.x0,c.got.y0,c.got.x1,c.got.y1,
+                    c.want.x0,c.want.y0,c.want.x1,c.want.y1);
+        }
+    }
+    results.push_back(fx);
+
+    // Random rects from -8 to S+8, a quarter of them empty or inverted.
+    DamageResult in={"intersect",0,0}, un={"union",0,0}, cl={"clear",0,0}, up={"upload",0,0};
+    uint32_t seed=12345;
+    auto rnd=[&](int lo,int hi){seed=seed*1664525u+1013904223u; return lo+(int)((seed>>8)%(uint32_t)(hi-lo+1));};
+    auto rect=[&]{int x0=rnd(-8,S+8),y0=rnd(-8,S+8); return R(x0,y0,x0+rnd(-2,12),y0+rnd(-2,12));};
+    const int N=o.reps*1000;
+    for(int i=0;i<N;i++){
+        const IRect a=rect(), b=rect();
+        const IRect is=IRectIntersect(a,b), u=IRectUnion(a,b), c=DamageClearRect(a,S), p=DamageUploadRect(a,S);
+        bool okI=IRectEmpty(is)?SameRect(is,none):true, okC=IRectEmpty(c)?SameRect(c,none):true;
+        bool anyA=false;
+        IRect bb=R(1<<30,1<<30,-(1<<30),-(1<<30));
+        for(int y=-10;y<S+22;y++)
+            for(int x=-10;x<S+22;x++){
+                const bool ia=Inside(a,x,y), ib=Inside(b,x,y), onS=Inside(full,x,y);
+                okI=okI&&Inside(is,x,y)==(ia&&ib);
+                okC=okC&&Inside(c,x,y)==(ia&&onS);
+                if(ia&&onS)anyA=true;
+                if(ia||ib){bb.x0=std::min(bb.x0,x); bb.y0=std::min(bb.y0,y); bb.x1=std::max(bb.x1,x+1); bb.y1=std::max(bb.y1,y+1);}
+            }
+        // Union is the bounding box of both pixel sets; of two empty rects, any empty rect.
+        const bool okU=IRectEmpty(a)&&IRectEmpty(b)?IRectEmpty(u):SameRect(u,bb);
+        // Upload is the on-surface part of the frame, or the one centre pixel when none is.
+        const bool okP=anyA?SameRect(p,c):SameRect(p,mid);
+        in.cases++; un.cases++; cl.cases++; up.cases++;
+        in.mismatches+=!okI; un.mismatches+=!okU; cl.mismatches+=!okC; up.mismatches+=!okP;
+    }
+    results.push_back(in); results.push_back(un); results.push_back(cl); results.push_back(up);
+
+    // Accounting: one full-size clear plus a centre-pixel upload over two frames.
+    DamageStats ds;
+    DamageAccount(ds,full,mid,S); DamageAccount(ds,none,DamageUploadRect(none,S),S);
+    DamageResult acc={"account",1,0};
+    acc.mismatches=!(ds.frames==2&&ds.fullBytes==2ull*S*S*4&&ds.clearBytes==(uint64_t)S*S*4&&ds.uploadBytes==8&&
+                     DamageUploadRatio(ds)==8.0/(2.0*S*S*4)&&DamageUploadRatio(DamageStats())==0);
+    results.push_back(acc);
+
+    bool ok=true;
+    for(const DamageResult&r:results)ok=ok&&!r.mismatches;
+    if(o.json){
+        printf("{\"results\":[\n");
+        for(size_t i=0;i<results.size();i++)
+            printf("  {\"check\":\"%s\",\"cases\":%llu,\"mismatches\":%llu}%s\n",results[i].check,
+                   (unsigned long long)results[i].cases,(unsigned long long)results[i].mismatches,
+                   i+1<results.size()?",":"");
+        printf("]}\n");
+        return ok?0:1;
+    }
+    printf("check,cases,mismatches\n");
+    for(const DamageResult&r:results)
+        printf("%s,%llu,%llu\n",r.check,(unsigned long long)r.cases,(unsigned long long)r.mismatches);
+    return ok?0:1;
+}
+
+//  FRAME STATS
+// The always-on frame histograms: every bucket's edges (the value that opens it, the last
+// value it takes and the next one up), percentiles of known distributions against the
+// exact values, and the sample ring filling, dropping and recovering. Stats_Record runs
+// once per frame on the render thread, so its cost is reported too.
+static int BucketIndex(uint32_t v)
+{
+    LatencyHist h; Hist_Add(h,v);
+    for(int b=0;b<HIST_BUCKETS;b++)if(h.count[b])return b;
+    return -1;
+}
+// Upper bound of v's bucket: the only sample below a huge maximum, at p = 0.5 of two.
+static uint32_t BucketTopOf(uint32_t v)
+{
+    LatencyHist h; Hist_Add(h,v); Hist_Add(h,0xFFFFFFFFu);
+    return Hist_Percentile(h,0.5);
+}
+
+struct StatsCheck { const char*check; uint64_t cases, mismatches; };
+
+static int MainStats(const BenchOptions&o)
+{
+    std::vector<StatsCheck> checks;
+
+    // Buckets: exact below 2^SUB, then contiguous, increasing, at most 1/2^SUB wide.
+    StatsCheck edges={"bucket edges",0,0};
+    int prev=-1;
+    for(uint32_t v=0;;){
+        const int b=BucketIndex(v); const uint32_t top=BucketTopOf(v);
+        edges.cases++;
+        bool ok=b==prev+1&&b<HIST_BUCKETS&&top>=v&&BucketIndex(top)==b;
+        if(v<(1u<<HIST_SUB_BITS))ok=ok&&b==(int)v&&top==v;
+        else ok=ok&&(uint64_t)(top-v+1)*(1u<<HIST_SUB_BITS)<=(uint64_t)v;
+        if(top<0xFFFFFFFFu)ok=ok&&BucketIndex(top+1)==b+1;
+        if(!ok){edges.mismatches++; fprintf(stderr,"bucket %d: v=%u top=%u\n",b,v,top);}
+        prev=b;
+        if(top==0xFFFFFFFFu||top<v||edges.cases>HIST_BUCKETS)break;    // a broken map must not loop
+        v=top+1;
+    }
+    if(prev!=HIST_BUCKETS-1)edges.mismatches++;
+    checks.push_back(edges);
+
+    // Percentiles: never below the exact value, never more than a bucket above it, and
+    // p=1 is the maximum. Uniform, geometric and a two-mode (hitch) distribution.
+    StatsCheck pct={"percentiles",0,0};
+    {
+        uint32_t seed=777;
+        auto rnd=[&]{seed=seed*1664525u+1013904223u; return seed>>8;};
+        for(int dist=0;dist<3;dist++){
+            std::vector<uint32_t> v(20000);
+            for(uint32_t&x:v){
+                const uint32_t r=rnd();
+                x=dist==0?200000+r%400000:dist==1?(uint32_t)(1000.0*pow(1.0005,r%20000)):
+                  (r%50?150000+r%20000:8000000+r%4000000);
+            }
+            LatencyHist h; for(uint32_t x:v)Hist_Add(h,x);
+            std::sort(v.begin(),v.end());
+            const double ps[]={0,0.01,0.5,0.9,0.99,0.999,1};
+            for(double p:ps){
+                size_t want=std::max<size_t>(1,(size_t)(p*v.size()+0.5));
+                const uint32_t exact=v[want-1], got=Hist_Percentile(h,p);
+                pct.cases++;
+                if(got<exact||(uint64_t)(got-exact)*(1u<<HIST_SUB_BITS)>(uint64_t)exact){
+                    pct.mismatches++; fprintf(stderr,"dist %d p%.3f: got %u exact %u\n",dist,p,got,exact);
+                }
+            }
+            pct.cases++; if(Hist_Percentile(h,1)!=h.maxNs||h.maxNs!=v.back())pct.mismatches++;
+        }
+        LatencyHist empty; pct.cases++; if(Hist_Percentile(empty,0.5))pct.mismatches++;
+    }
+    checks.push_back(pct);
+
+    // Ring: fills to capacity, drops the rest and counts them, drains into the histograms
+    // and takes samples again.
+    StatsCheck ring={"ring overflow",0,0};
+    {
+        FrameStats*s=new FrameStats;
+        const int cap=1024, extra=300;
+        FrameSample f;
+        for(int i=0;i<cap+extra;i++){for(int p=0;p<PH_COUNT;p++)f.ns[p]=1000+i; Stats_Record(*s,f);}
+        ring.cases++; if(s->dropped.load()!=(uint64_t)extra)ring.mismatches++;
+        Stats_Drain(*s);
+        ring.cases++; if(s->hist[PH_TOTAL].total!=(uint64_t)cap||s->hist[PH_TOTAL].maxNs!=(uint32_t)(1000+cap-1))ring.mismatches++;
+        Stats_Record(*s,f); Stats_Drain(*s);
+        ring.cases++; if(s->hist[PH_SETUP].total!=(uint64_t)cap+1||s->dropped.load()!=(uint64_t)extra)ring.mismatches++;
+        delete s;
+    }
+    checks.push_back(ring);
+
+    // Cost: one record per frame, drained every 256 like a long animation would be.
+    FrameStats*s=new FrameStats;
+    FrameSample f; for(int p=0;p<PH_COUNT;p++)f.ns[p]=25000+p;
+    const int N=o.reps*50000;
+    double bestRec=1e300, bestDrain=1e300;
+    for(int rep=0;rep<5;rep++){
+        double rec=0, drain=0;
+        for(int i=0;i<N;i+=256){
+            auto t0=std::chrono::steady_clock::now();
+            for(int k=0;k<256;k++){f.ns[PH_TOTAL]=(uint32_t)(i+k)*37u; Stats_Record(*s,f);}
+            auto t1=std::chrono::steady_clock::now();
+            Stats_Drain(*s);
+            auto t2=std::chrono::steady_clock::now();
+            rec+=std::chrono::duration<double,std::nano>(t1-t0).count();
+            drain+=std::chrono::duration<double,std::nano>(t2-t1).count();
+        }
+        const int n=(N+255)/256*256;
+        bestRec=std::min(bestRec,rec/n); bestDrain=std::min(bestDrain,drain/n);
+    }
+    const bool noDrops=!s->dropped.load();
+    delete s;
+
+    bool ok=noDrops;
+    for(const StatsCheck&c:checks)ok=ok&&!c.mismatches;
+    if(o.json){
+        printf("{\"ns_per_record\":%.2f,\"ns_per_drained_sample\":%.2f,\"checks\":[\n",bestRec,bestDrain);
+        for(size_t i=0;i<checks.size();i++)
+            printf("  {\"check\":\"%s\",\"cases\":%llu,\"mismatches\":%llu}%s\n",checks[i].check,
+                   (unsigned long long)checks[i].cases,(unsigned long long)checks[i].mismatches,
+                   i+1<checks.size()?",":"");
+        printf("]}\n");
+        return ok?0:1;
+    }
+    printf("# ns_per_record=%.2f ns_per_drained_sample=%.2f\ncheck,cases,mismatches\n",bestRec,bestDrain);
+    for(const StatsCheck&c:checks)
+        printf("%s,%llu,%llu\n",c.check,(unsigned long long)c.cases,(unsigned long long)c.mismatches);
+    return ok?0:1;
+}
+
+int main(int argc,char**argv)
+{
+    BenchOptions o;
+    if(!ParseArgs(argc,argv,o))return 2;
+    if(o.hsv)return MainHsv(o);
+    if(o.spot)return MainSpot(o);
+    if(o.trail)return MainTrail(o);
+    if(o.contrast)return MainContrast(o);
+    if(o.gamma)return MainGamma(o);
+    if(o.glow)return MainGlow(o);
+    if(o.near)return MainNear(o);
+    if(o.damage)return MainDamage(o);
+    if(o.stats)return MainStats(o);
+
+    std::vector<BenchResult> results;
+    for(int scale=1;scale<=3;scale++)
+        for(int speed=0;speed<3;speed++)
+            for(int mode=0;mode<BM_COUNT;mode++)results.push_back(Run(o,mode,speed,scale));
+
+    if(o.json){
+        printf("{\"raster_path\":\"%s\",\"hz\":%d,\"reps\":%d,\"results\":[\n",
+               RasterPathName(RasterBestPath()),o.hz,o.reps);
+        for(size_t i=0;i<results.size();i++){
+            const BenchResult&r=results[i];
+            printf("  {\"mode\":\"%s\",\"speed\":%d,\"scale\":%d,\"size\":%d,\"frames\":%llu,"
+                   "\"ns_per_frame\":%.1f,\"best_ns_per_frame\":%.1f,\"bytes_per_frame\":%.0f,"
+                   "\"allocs_per_frame\":%.3f,\"atlas_ms\":%.2f,\"atlas_kb\":%.0f,\"atlas_keys\":%d,"
+                   "\"atlas_baked\":%d}%s\n",
+                   ModeName(r.mode),r.speed,r.scale,r.size,(unsigned long long)r.frames,r.nsPerFrame,
+                   r.bestNsPerFrame,r.bytesPerFrame,r.allocsPerFrame,r.atlasMs,r.atlasKB,r.atlasKeys,r.atlasBaked,
+                   i+1<results.size()?",":"");
+        }
+        printf("]}\n");
+        return 0;
+    }
+    printf("# raster_path=%s hz=%d reps=%d\n",RasterPathName(RasterBestPath()),o.hz,o.reps);
+    printf("mode,speed,scale,size,frames,ns_per_frame,best_ns_per_frame,bytes_per_frame,allocs_per_frame,atlas_ms,atlas_kb,"
+           "atlas_keys,atlas_baked\n");
+    for(const BenchResult&r:results)
+        printf("%s,%d,%d,%d,%llu,%.1f,%.1f,%.0f,%.3f,%.2f,%.0f,%d,%d\n",ModeName(r.mode),r.speed,r.scale,r.size,
+               (unsigned long long)r.frames,r.nsPerFrame,r.bestNsPerFrame,r.bytesPerFrame,r.allocsPerFrame,
+               r.atlasMs,r.atlasKB,r.atlasKeys,r.atlasBaked);
+    return 0;
+}
@@ -0,0 +1,216 @@
+//  bcf_store_bench.cpp  –  Better Cursor Finder (BCF)
+//  Settings store benchmark: INI encode/decode and file-backend load/save throughput, debounce
+//  coalescing, a revert submitted while the change is being saved, retry of a failed save,
+//  keys from a newer version surviving a save, and (POSIX) crash consistency: a child process saves in a loop and is killed
+//  at random points; every surviving file must load and hold a sequence number the child
+//  actually wrote.
+//
+//  bcf_store_bench [--dir PATH] [--kills N] [--json]
+
+#include "settings_store.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#if !defined(_WIN32)
+  #include <csignal>
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
+struct StoreBenchOptions {
+    std::string dir   = ".";
+    int         kills = 200;
+    bool        json  = false;
+};
+
+// The six values the app stores, plus a sequence number for the crash test.
+static SettingsValues SampleValues(uint32_t seq)
+{
+    SettingsValues s;
+    Settings_Set(s,"RingColor",0x00FFFFFF^seq);
+    Settings_Set(s,"OutlineColor",seq*2654435761u);
+    Settings_Set(s,"Speed",seq%3);
+    Settings_Set(s,"MoveCancel",seq&1);
+    Settings_Set(s,"DarkMode",(seq>>1)&1);
+    Settings_Set(s,"StartOnBoot",(seq>>2)&1);
+    Settings_Set(s,"Seq",seq);
+    return s;
+}
+
+template<class F> static double NsPerOp(int n,F f)
+{
+    auto t0=std::chrono::steady_clock::now();
+    for(int i=0;i<n;i++)f(i);
+    return std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count()/n;
+}
+
+// In-memory backend whose saves can be held open and made to fail, for the store's races.
+struct GateBackend : SettingsBackend {
+    std::mutex              m;
+    std::condition_variable cv;
+    SettingsValues          held;
+    bool                    hold = false, inSave = false;
+    int                     failNext = 0;
+    const char* Name() override {return "gate";}
+    bool Load(SettingsValues&s) override {std::lock_guard<std::mutex> lk(m); s=held; return true;}
+    bool Save(const SettingsValues&s) override {
+        std::unique_lock<std::mutex> lk(m);
+        inSave=true; cv.notify_all();
+        cv.wait(lk,[&]{return !hold;});
+        inSave=false;
+        if(failNext>0){failNext--;return false;}
+        held=s; return true;
+    }
+};
+
+// Change, then revert while the change is being written: the revert must reach the backend,
+// and Flush must not return before it has.
+static bool RevertDuringSave()
+{
+    GateBackend be; be.held=SampleValues(1);
+    SettingsStore st; Store_Start(st,&be,be.held,5);
+    {std::lock_guard<std::mutex> lk(be.m); be.hold=true;}
+    Store_Submit(st,SampleValues(2));
+    {std::unique_lock<std::mutex> lk(be.m); be.cv.wait(lk,[&]{return be.inSave;});}
+    Store_Submit(st,SampleValues(1));
+    {std::lock_guard<std::mutex> lk(be.m); be.hold=false; be.cv.notify_all();}
+    Store_Flush(st);
+    SettingsValues got; be.Load(got);
+    Store_Stop(st);
+    return Settings_Equal(got,SampleValues(1))&&st.writes==2;
+}
+
+// A failed save is kept and written by the next attempt.
+static bool RetryAfterFailure()
+{
+    GateBackend be; be.held=SampleValues(1); be.failNext=1;
+    SettingsStore st; Store_Start(st,&be,be.held,5);
+    Store_Submit(st,SampleValues(3));
+    Store_Flush(st);                                   // returns on the failure
+    Store_Flush(st);
+    SettingsValues got; be.Load(got);
+    Store_Stop(st);
+    return Settings_Equal(got,SampleValues(3))&&st.failures==1&&st.writes==1;
+}
+
+// A file written by a newer version: its unknown key survives this version changing a known
+// one and saving, the other section does not.
+static bool UnknownKeysKept()
+{
+    SettingsValues loaded;
+    if(!Settings_FromIni("[BCF]\nVersion=2\nRingColor=0x1\nFutureKey=0x5\n[Other]\nX=1\n",loaded))return false;
+    SettingsValues cur; Settings_Set(cur,"RingColor",2); Settings_AddMissing(cur,loaded);
+    SettingsValues back; Settings_FromIni(Settings_ToIni(cur).c_str(),back);
+    uint32_t ring=0, future=0, x;
+    return Settings_Get(back,"RingColor",ring)&&ring==2&&Settings_Get(back,"FutureKey",future)&&future==5&&
+           !Settings_Get(back,"X",x)&&back.count==2;
+}
+
+struct CrashResult { int runs=0, torn=0, missing=0, stale=0; };
+
+#if !defined(_WIN32)
+static CrashResult CrashTest(const StoreBenchOptions&o,const std::string&path)
+{
+    CrashResult r;
+    std::mt19937 rng(12345);
+    IniFileBackend be(path);
+    be.Save(SampleValues(0));
+    for(int k=0;k<o.kills;k++){
+        int pipefd[2]; if(pipe(pipefd))break;
+        pid_t pid=fork();
+        if(pid==0){
+            close(pipefd[0]);
+            IniFileBackend child(path);
+            SettingsValues cur; uint32_t seq=0;
+            if(child.Load(cur))Settings_Get(cur,"Seq",seq);
+            if(write(pipefd[1],&seq,sizeof(seq))!=sizeof(seq))_exit(1);
+            for(;;){
+                seq++;
+                if(child.Save(SampleValues(seq))&&write(pipefd[1],&seq,sizeof(seq))!=sizeof(seq))_exit(1);
+            }
+        }
+        close(pipefd[1]);
+        // The kill is timed from the child's first report, so it never lands before the
+        // child has read the file it continues from.
+        uint32_t seq=0,last=0;
+        if(read(pipefd[0],&seq,sizeof(seq))==sizeof(seq))last=seq;
+        usleep(1000+rng()%20000);
+        kill(pid,SIGKILL); waitpid(pid,nullptr,0);
+        // Last sequence the child reported as fully saved; the file may be one ahead of it
+        // when the kill landed between the rename and the report.
+        while(read(pipefd[0],&seq,sizeof(seq))==sizeof(seq))last=seq;
+        close(pipefd[0]);
+
+        r.runs++;
+        SettingsValues got; uint32_t fileSeq=0;
+        if(!be.Load(got)){r.torn++;continue;}
+        if(!Settings_Get(got,"Seq",fileSeq)){r.missing++;continue;}
+        if(fileSeq<last||fileSeq>last+1||!Settings_Equal(got,SampleValues(fileSeq)))r.stale++;
+    }
+    remove((path+".tmp").c_str());
+    return r;
+}
+#endif
+
+int main(int argc,char**argv)
+{
+    StoreBenchOptions o;
+    for(int i=1;i<argc;i++){
+        const char*a=argv[i]; const char*v=i+1<argc?argv[i+1]:nullptr;
+        if(!strcmp(a,"--json"))o.json=true;
+        else if(!strcmp(a,"--dir")&&v){o.dir=v;i++;}
+        else if(!strcmp(a,"--kills")&&v){o.kills=atoi(v);i++;}
+        else{fprintf(stderr,"usage: %s [--dir PATH] [--kills N] [--json]\n",argv[0]);return 2;}
+    }
+    const std::string path=o.dir+"/bcf_store_bench.ini";
+
+    std::string text=Settings_ToIni(SampleValues(7));
+    double encNs=NsPerOp(200000,[&](int i){text=Settings_ToIni(SampleValues((uint32_t)i));});
+    text=Settings_ToIni(SampleValues(7));
+    double decNs=NsPerOp(200000,[&](int){SettingsValues s;Settings_FromIni(text.c_str(),s);});
+
+    IniFileBackend be(path);
+    double saveNs=NsPerOp(200,[&](int i){be.Save(SampleValues((uint32_t)i));});
+    double loadNs=NsPerOp(5000,[&](int){SettingsValues s;be.Load(s);});
+
+    // A burst of 1000 changes inside one debounce window should end in a single write.
+    SettingsStore st;
+    Store_Start(st,&be,SettingsValues(),50);
+    for(uint32_t i=1;i<=1000;i++)Store_Submit(st,SampleValues(i));
+    Store_Stop(st);
+    SettingsValues last; be.Load(last);
+    bool lastOk=Settings_Equal(last,SampleValues(1000));
+
+    int revertFails=0, retryFails=0;
+    for(int i=0;i<50;i++){revertFails+=!RevertDuringSave(); retryFails+=!RetryAfterFailure();}
+
+    const bool unknownOk=UnknownKeysKept();
+
+    CrashResult cr;
+#if !defined(_WIN32)
+    cr=CrashTest(o,path);
+#endif
+    remove(path.c_str());
+
+    bool ok=lastOk&&unknownOk&&!revertFails&&!retryFails&&!cr.torn&&!cr.missing&&!cr.stale&&!st.failures;
+    if(o.json){
+        printf("{\"encode_ns\":%.0f,\"decode_ns\":%.0f,\"save_ns\":%.0f,\"load_ns\":%.0f,"
+               "\"burst_submits\":%llu,\"burst_writes\":%llu,\"burst_last_ok\":%s,"
+               "\"revert_during_save_fails\":%d,\"retry_after_failure_fails\":%d,\"unknown_keys_ok\":%s,"
+               "\"crash_runs\":%d,\"crash_torn\":%d,\"crash_missing\":%d,\"crash_stale\":%d}\n",
+               encNs,decNs,saveNs,loadNs,(unsigned long long)st.submits,(unsigned long long)st.writes,
+               lastOk?"true":"false",revertFails,retryFails,unknownOk?"true":"false",cr.runs,cr.torn,cr.missing,cr.stale);
+    } else {
+        printf("metric,value\n");
+        printf("encode_ns,%.0f\ndecode_ns,%.0f\nsave_ns,%.0f\nload_ns,%.0f\n",encNs,decNs,saveNs,loadNs);
+        printf("burst_submits,%llu\nburst_writes,%llu\nburst_last_ok,%d\n",
+               (unsigned long long)st.submits,(unsigned long long)st.writes,lastOk?1:0);
+        printf("revert_during_save_fails,%d\nretry_after_failure_fails,%d\n",revertFails,retryFails);
+        printf("unknown_keys_ok,%d\n",unknownOk?1:0);
+        printf("crash_runs,%d\ncrash_torn,%d\ncrash_missing,%d\ncrash_stale,%d\n",cr.runs,cr.torn,cr.missing,cr.stale);
+    }
+    return ok?0:1;
+}
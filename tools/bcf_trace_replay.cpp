@@ -0,0 +1,542 @@
+//  bcf_trace_replay.cpp  –  Better Cursor Finder (BCF)
+//  Re-runs a recorded trace (tray menu "Record input trace") through the Ctrl-tap detector,
+//  the frame pacer, the motion predictor and the animation schedule, with the clock and the
+//  cursor reads taken from the trace, and checks every decision against what the app did:
+//  tap actions, which ticks drew, where each frame was drawn and how each animation ended.
+//  Also reports the recorded frame timings. Non-zero exit on any mismatch, so a field trace
+//  becomes a regression test as is.
+//
+//  Without a trace it plays a built-in session (taps, Ctrl+C, move and key cancels, a
+//  polling section, a spotlight run), records it through the trace encoder, and replays the decoded file;
+//  --save keeps that file.
+//
+//  --keys instead checks KeyBits_AnyNew against the scalar reference and times both.
+//
+//  bcf_trace_replay [TRACE] [--events] [--verbose] [--json] [--save FILE] [--keys]
+
+#include "trace_log.h"
+#include "ctrl_tap.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "motion_predict.h"
+#include "ring_anim.h"
+#include "render_channel.h"
+#include "frame_governor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Clock readings come from the tick being replayed.
+struct ReplayClock : PaceClock {
+    int64_t now = 0, period = 0, vblank = 0;
+    bool    ok = false;
+    int64_t NowNs() override {return now;}
+    bool VBlank(int64_t&p,int64_t&l) override {p=period;l=vblank;return ok;}
+};
+
+//  ENGINE
+// The app's decision logic, step for step: the UI side of KeyboardHookProc / OnRawMouse and
+// the polling loop, and the render side of Render_Command, AnimTick and RenderFrame.
+struct Engine {
+    CtrlTap  tap;
+    int      speed = 1, prediction = 50, mode = LOCATE_RING;
+    bool     moveCancel = true;
+    bool     animating = false;
+    int32_t  startX = 0, startY = 0;
+    ReplayClock     clock;
+    FramePacer      pacer;
+    MotionPredictor motion;
+    FrameGovernor   gov;
+    bool     governed = true;               // false for traces from before the governor
+    int64_t  frameCostNs = 0;               // cost the app recorded for the frame being drawn
+    std::vector<TraceEvent> outputs;        // TR_FRAME / TR_END in the order they happened
+    int64_t  wakeNs = 0;                   // when the frame timer would fire next
+    uint64_t frames = 0, skipped = 0, missed = 0;
+
+    TapAction Key(int vk,bool down,bool anim){return Tap_Key(tap,vk,down,anim);}
+    TapAction Poll(const KeyBits&held,bool anim){return Tap_Poll(tap,held,anim);}
+
+    void Config(int s,bool mc,int pred,int m,int power){
+        speed=s; moveCancel=mc; prediction=pred; mode=m;
+        Gov_SetPower(gov,(PowerSource)power); Govern();
+    }
+    void Govern(){pacer.divisor=governed?Gov_Current(gov).divisor:1;}
+    void End(TraceEnd reason,int64_t t){
+        animating=false;
+        frames+=pacer.stats.frames; skipped+=pacer.stats.skipped; missed+=pacer.stats.missed;
+        TraceEvent e; e.type=TR_END; e.tNs=t; e.a=reason; outputs.push_back(e);
+    }
+    void Start(int64_t t,int32_t x,int32_t y){
+        startX=x; startY=y; clock.now=t;
+        Pacer_Start(pacer,&clock,AnimDurationMs(speed));
+        if(governed)Gov_Start(gov,pacer.startNs);
+        Govern();
+        Predict_Reset(motion); Predict_Add(motion,pacer.startNs,(float)x,(float)y);
+        animating=true; wakeNs=t;
+    }
+    void Cancel(int64_t t){if(animating)End(END_KEY,t);}
+    void CheckMove(int64_t t,int32_t x,int32_t y){
+        if(animating&&moveCancel&&MovedPastCancel(x-startX,y-startY))End(END_MOVE,t);
+    }
+    void Move(int64_t t,int32_t x,int32_t y){
+        if(animating)Predict_Add(motion,t,(float)x,(float)y);
+        CheckMove(t,x,y);
+    }
+    // Returns the TR_TICK flags this tick actually used.
+    uint8_t Tick(const TraceEvent&k){
+        CheckMove(k.tNs,k.x,k.y);
+        if(!animating||!(k.a&TICK_PACED))return 0;
+        clock.now=k.nowNs; clock.ok=(k.a&TICK_VBLANK)!=0; clock.period=k.periodNs; clock.vblank=k.vblankNs;
+        PaceFrame f=Pacer_Next(pacer); wakeNs=f.wakeNs;
+        uint8_t used=(uint8_t)(TICK_PACED|(clock.ok?TICK_VBLANK:0));
+        if(!f.render||!(k.a&TICK_DRAWN))return f.render?(uint8_t)(used|TICK_DRAWN):used;
+        Predict_Add(motion,k.t2,(float)k.x2,(float)k.y2);
+        float px,py; Predict_At(motion,f.presentNs,prediction/100.f,px,py);
+        bool done=mode==LOCATE_SPOTLIGHT?SpotFrameAt(f.progress).done:RingFrameAt(f.progress).done;
+        if(done)End(END_DONE,k.t2);
+        else{
+            TraceEvent e; e.type=TR_FRAME; e.tNs=k.t2; e.progress=f.progress;
+            e.x=(int32_t)lroundf(px); e.y=(int32_t)lroundf(py); outputs.push_back(e);
+            if(governed){
+                Gov_Frame(gov,k.t2,frameCostNs,pacer.stats.missed,clock.ok?k.periodNs:pacer.fallbackNs);
+                Govern();
+            }
+        }
+        return (uint8_t)(used|TICK_DRAWN);
+    }
+};
+
+//  REPLAY
+struct Mismatch { int64_t tNs; char what[96]; };
+
+struct Report {
+    uint64_t events = 0, keys = 0, polls = 0, triggers = 0, tapCancels = 0, ticks = 0;
+    uint64_t animations = 0, ends[4] = {}, dropped = 0, skippedUi = 0, skippedRender = 0;
+    uint64_t checked = 0;
+    std::vector<Mismatch> mismatches;
+    LatencyHist hist[PH_COUNT];
+    int64_t  firstNs = 0, lastNs = 0;
+    uint64_t frames = 0, paceSkipped = 0, missed = 0;
+    uint64_t govChecks = 0, govDown = 0, govUp = 0, govReduced = 0;
+};
+
+static void Fail(Report&r,int64_t t,const char*fmt,...)
+{
+    Mismatch m; m.tNs=t;
+    va_list ap; va_start(ap,fmt); vsnprintf(m.what,sizeof(m.what),fmt,ap); va_end(ap);
+    r.mismatches.push_back(m);
+}
+
+static bool Near(const TraceEvent&a,const TraceEvent&b)
+{
+    if(a.type!=b.type)return false;
+    if(a.type==TR_END)return a.a==b.a;
+    // Positions go through expf and lroundf; another compiler may round one ulp differently.
+    return fabsf(a.progress-b.progress)<=1e-6f&&abs(a.x-b.x)<=1&&abs(a.y-b.y)<=1;
+}
+static void Describe(const TraceEvent&e,char*buf,size_t n)
+{
+    if(e.type==TR_END)snprintf(buf,n,"end(%s)",TraceEndName(e.a));
+    else snprintf(buf,n,"frame(%.4f @ %d,%d)",e.progress,e.x,e.y);
+}
+
+static Report Replay(const std::vector<TraceEvent>&ev)
+{
+    Report r; Engine g;
+    bool uiSynced=false, renderSynced=false, govSynced=false;
+    g.governed=std::any_of(ev.begin(),ev.end(),[](const TraceEvent&e){return e.type==TR_GOV;});
+    std::vector<TraceEvent> recorded;
+    r.events=ev.size();
+    if(!ev.empty()){r.firstNs=ev.front().tNs; r.lastNs=ev.back().tNs;}
+    for(const TraceEvent&e:ev){
+        switch(e.type){
+        case TR_TAP:
+            g.tap.down=e.keys; g.tap.known=e.known; g.tap.ctrlWas=e.a!=0; g.tap.comboDetected=e.b!=0;
+            uiSynced=true;
+            break;
+        case TR_KEY:
+        case TR_POLL:{
+            if(!uiSynced){r.skippedUi++;break;}
+            TapAction a=e.type==TR_KEY?g.Key(e.a,e.b!=0,e.c!=0):g.Poll(e.keys,e.c!=0);
+            (e.type==TR_KEY?r.keys:r.polls)++; r.checked++;
+            if(a==TAP_TRIGGER)r.triggers++;
+            if(a==TAP_CANCEL)r.tapCancels++;
+            if(a!=(TapAction)e.d){
+                static const char*n[]={"none","trigger","cancel"};
+                if(e.type==TR_KEY)Fail(r,e.tNs,"key 0x%02X %s: recorded %s, replayed %s",e.a,e.b?"down":"up",n[e.d%3],n[a]);
+                else Fail(r,e.tNs,"poll: recorded %s, replayed %s",n[e.d%3],n[a]);
+            }
+            break;}
+        case TR_CONFIG: g.Config(e.a,(e.b&1)!=0,e.c,e.b>>1&1,e.b>>2&3); break;
+        case TR_START:  g.Start(e.tNs,e.x,e.y); renderSynced=true; r.animations++; break;
+        case TR_CANCEL: if(renderSynced)g.Cancel(e.tNs); else r.skippedRender++; break;
+        case TR_MOVE:   if(renderSynced)g.Move(e.tNs,e.x,e.y); else r.skippedRender++; break;
+        case TR_TICK:{
+            if(!renderSynced){r.skippedRender++;break;}
+            r.ticks++;
+            uint8_t used=g.Tick(e), want=e.a&(TICK_PACED|TICK_DRAWN);
+            r.checked++;
+            if((used&(TICK_PACED|TICK_DRAWN))!=want)
+                Fail(r,e.tNs,"tick: recorded %s, replayed %s",
+                     want&TICK_DRAWN?"drawn":want?"skipped":"cancelled",
+                     used&TICK_DRAWN?"drawn":used?"skipped":"cancelled");
+            break;}
+        case TR_GOV:{
+            if(!renderSynced)break;
+            // The governor's level carries over from before the trace began: adopt the first.
+            if(!govSynced){g.gov.level=e.a; g.gov.periodNs=e.periodNs; g.Govern(); govSynced=true; break;}
+            GovStep s=Gov_Current(g.gov);
+            r.checked++; r.govChecks++;
+            if(g.gov.level!=e.a||s.divisor!=e.b)
+                Fail(r,e.tNs,"governor: recorded step %d (every %d), replayed step %d (every %d)",e.a,e.b,g.gov.level,s.divisor);
+            break;}
+        case TR_FRAME:
+            g.frameCostNs=e.ns[PH_TOTAL];
+            for(int i=0;i<PH_COUNT;i++)Hist_Add(r.hist[i],e.ns[i]);
+            // fall through
+        case TR_END:
+            if(renderSynced)recorded.push_back(e);
+            if(e.type==TR_END&&e.a<4)r.ends[e.a]++;
+            break;
+        case TR_DROPPED: r.dropped+=(uint64_t)e.t2; break;
+        case TR_POINTER: break;     // for bcf_shake_eval; the render thread's TR_MOVE drives the replay
+        }
+    }
+    if(g.animating){r.frames+=g.pacer.stats.frames; r.paceSkipped+=g.pacer.stats.skipped; r.missed+=g.pacer.stats.missed;}
+    r.frames+=g.frames; r.paceSkipped+=g.skipped; r.missed+=g.missed;
+    r.govDown=g.gov.stats.down; r.govUp=g.gov.stats.up; r.govReduced=g.gov.stats.reduced;
+
+    // Outputs are compared as sequences: the app records a tick after what it drew.
+    size_t n=std::max(recorded.size(),g.outputs.size());
+    for(size_t i=0;i<n;i++){
+        r.checked++;
+        char a[64]="nothing", b[64]="nothing";
+        if(i<recorded.size())Describe(recorded[i],a,sizeof(a));
+        if(i<g.outputs.size())Describe(g.outputs[i],b,sizeof(b));
+        if(i>=recorded.size()||i>=g.outputs.size()||!Near(recorded[i],g.outputs[i])){
+            Fail(r,i<recorded.size()?recorded[i].tNs:g.outputs[i].tNs,"output %zu: recorded %s, replayed %s",i,a,b);
+            break;      // everything after the first divergence differs too
+        }
+    }
+    return r;
+}
+
+static void PrintEvents(const std::vector<TraceEvent>&ev)
+{
+    int64_t t0=ev.empty()?0:ev.front().tNs;
+    for(const TraceEvent&e:ev){
+        printf("%12.3f ms  %-7s",(e.tNs-t0)/1e6,TraceTypeName(e.type));
+        switch(e.type){
+        case TR_KEY:    printf(" vk 0x%02X %s%s action %d",e.a,e.b?"down":"up",e.c?" animating":"",e.d); break;
+        case TR_POLL:   printf(" held %016llx%016llx%016llx%016llx%s action %d",(unsigned long long)e.keys.w[3],
+                               (unsigned long long)e.keys.w[2],(unsigned long long)e.keys.w[1],
+                               (unsigned long long)e.keys.w[0],e.c?" animating":"",e.d); break;
+        case TR_TAP:    printf(" ctrl %d combo %d",e.a,e.b); break;
+        case TR_CONFIG: printf(" speed %d moveCancel %d prediction %d%% mode %d power %s",e.a,e.b&1,e.c,e.b>>1&1,GovPowerName(e.b>>2&3)); break;
+        case TR_GOV:    printf(" step %d every %d %s period %.3f",e.a,e.b,e.c?"reduced":"full",e.periodNs/1e6); break;
+        case TR_START:
+        case TR_MOVE:
+        case TR_POINTER:printf(" %d,%d",e.x,e.y); break;
+        case TR_TICK:
+            printf(" %d,%d",e.x,e.y);
+            if(e.a&TICK_PACED)printf(" now %+.3f",(e.nowNs-e.tNs)/1e6);
+            if(e.a&TICK_VBLANK)printf(" period %.3f",e.periodNs/1e6);
+            if(e.a&TICK_DRAWN)printf(" read %d,%d",e.x2,e.y2);
+            break;
+        case TR_FRAME:  printf(" %.4f @ %d,%d total %.1f us",e.progress,e.x,e.y,e.ns[PH_TOTAL]/1e3); break;
+        case TR_END:    printf(" %s",TraceEndName(e.a)); break;
+        case TR_DROPPED:printf(" %lld",(long long)e.t2); break;
+        }
+        printf("\n");
+    }
+}
+
+static void PrintReport(const Report&r,const char*name,bool verbose,bool json)
+{
+    if(json){
+        printf("{\"trace\":\"%s\",\"events\":%llu,\"seconds\":%.3f,\"checked\":%llu,\"mismatches\":%zu,",
+               name,(unsigned long long)r.events,(r.lastNs-r.firstNs)/1e9,(unsigned long long)r.checked,r.mismatches.size());
+        printf("\"keys\":%llu,\"polls\":%llu,\"triggers\":%llu,\"tap_cancels\":%llu,\"animations\":%llu,",
+               (unsigned long long)r.keys,(unsigned long long)r.polls,(unsigned long long)r.triggers,
+               (unsigned long long)r.tapCancels,(unsigned long long)r.animations);
+        printf("\"ends\":{\"done\":%llu,\"key\":%llu,\"move\":%llu,\"quit\":%llu},",(unsigned long long)r.ends[0],
+               (unsigned long long)r.ends[1],(unsigned long long)r.ends[2],(unsigned long long)r.ends[3]);
+        printf("\"frames\":%llu,\"pace_skipped\":%llu,\"missed_vblanks\":%llu,\"dropped\":%llu,",
+               (unsigned long long)r.frames,(unsigned long long)r.paceSkipped,(unsigned long long)r.missed,
+               (unsigned long long)r.dropped);
+        printf("\"governor\":{\"checks\":%llu,\"down\":%llu,\"up\":%llu,\"reduced_frames\":%llu},\"phases\":[",
+               (unsigned long long)r.govChecks,(unsigned long long)r.govDown,(unsigned long long)r.govUp,
+               (unsigned long long)r.govReduced);
+        for(int i=0;i<PH_COUNT;i++){
+            const LatencyHist&h=r.hist[i];
+            printf("%s{\"phase\":\"%s\",\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}",i?",":"",FramePhaseName(i),
+                   Hist_Percentile(h,0.5)/1e3,Hist_Percentile(h,0.99)/1e3,h.maxNs/1e3);
+        }
+        printf("]}\n");
+        return;
+    }
+    printf("BCF trace replay: %s\n",name);
+    printf("%llu events over %.3f s; %llu decisions checked, %zu mismatched\n",(unsigned long long)r.events,
+           (r.lastNs-r.firstNs)/1e9,(unsigned long long)r.checked,r.mismatches.size());
+    printf("keys %llu  polls %llu  triggers %llu  tap cancels %llu\n",(unsigned long long)r.keys,
+           (unsigned long long)r.polls,(unsigned long long)r.triggers,(unsigned long long)r.tapCancels);
+    printf("animations %llu  ended: done %llu  key %llu  move %llu  quit %llu\n",(unsigned long long)r.animations,
+           (unsigned long long)r.ends[0],(unsigned long long)r.ends[1],(unsigned long long)r.ends[2],(unsigned long long)r.ends[3]);
+    printf("frames %llu  skipped wakes %llu  missed vblanks %llu\n",(unsigned long long)r.frames,
+           (unsigned long long)r.paceSkipped,(unsigned long long)r.missed);
+    printf("governor: %llu starts checked, %llu steps down, %llu up, %llu reduced-quality frames\n",
+           (unsigned long long)r.govChecks,(unsigned long long)r.govDown,(unsigned long long)r.govUp,
+           (unsigned long long)r.govReduced);
+    if(r.skippedUi||r.skippedRender)
+        printf("before sync: %llu UI and %llu render events not replayed\n",(unsigned long long)r.skippedUi,
+               (unsigned long long)r.skippedRender);
+    if(r.dropped)printf("warning: %llu events were dropped while recording; mismatches may follow\n",(unsigned long long)r.dropped);
+    printf("\n%-8s %10s %10s %10s\n","phase","p50 us","p99 us","max us");
+    for(int i=0;i<PH_COUNT;i++){
+        const LatencyHist&h=r.hist[i];
+        printf("%-8s %10.1f %10.1f %10.1f\n",FramePhaseName(i),Hist_Percentile(h,0.5)/1e3,Hist_Percentile(h,0.99)/1e3,h.maxNs/1e3);
+    }
+    size_t shown=verbose?r.mismatches.size():std::min<size_t>(r.mismatches.size(),10);
+    if(shown)printf("\n");
+    for(size_t i=0;i<shown;i++)printf("mismatch at %.3f ms: %s\n",(r.mismatches[i].tNs-r.firstNs)/1e6,r.mismatches[i].what);
+    if(shown<r.mismatches.size())printf("... %zu more (--verbose)\n",r.mismatches.size()-shown);
+}
+
+//  BUILT-IN SESSION
+// Drives an Engine the way the app's threads would at 144 Hz and writes the trace the app
+// would record: inputs as they arrive, a tick after what it drew.
+struct Session {
+    Engine   live;
+    FILE*    f;
+    int64_t  lastNs = 0;
+    int64_t  period = 6944444;
+    uint32_t rng = 12345;
+    int64_t  load = 0;                      // added to every frame's cost
+    FrameSample cost;                       // phases of the frame the next tick draws
+    std::vector<uint8_t> ends;
+
+    void Put(const TraceEvent&e){Trace_Append(f,lastNs,e);}
+    void Flush(size_t from){
+        for(size_t i=from;i<live.outputs.size();i++){
+            TraceEvent o=live.outputs[i];
+            for(int p=0;p<PH_COUNT;p++)o.ns[p]=cost.ns[p];
+            if(o.type==TR_END)ends.push_back(o.a);
+            Put(o);
+        }
+    }
+    void Key(int64_t t,int vk,bool down){
+        TraceEvent e; e.type=TR_KEY; e.tNs=t; e.a=(uint8_t)vk; e.b=down; e.c=live.animating;
+        TapAction a=live.Key(vk,down,live.animating); e.d=(uint8_t)a; Put(e);
+        Command(t,a);
+    }
+    void Poll(int64_t t,const KeyBits&held){
+        TraceEvent e; e.type=TR_POLL; e.tNs=t; e.keys=held; e.c=live.animating;
+        TapAction a=live.Poll(held,live.animating); e.d=(uint8_t)a; Put(e);
+        Command(t,a);
+    }
+    int32_t cx = 960, cy = 540;
+    void Command(int64_t t,TapAction a){
+        size_t n=live.outputs.size();
+        TraceEvent e; e.tNs=t+50000;
+        if(a==TAP_TRIGGER){
+            e.type=TR_START; e.x=cx; e.y=cy; Put(e); live.Start(e.tNs,cx,cy);
+            GovStep s=Gov_Current(live.gov);
+            TraceEvent gv; gv.type=TR_GOV; gv.tNs=e.tNs; gv.a=(uint8_t)live.gov.level; gv.b=(uint8_t)s.divisor;
+            gv.c=s.quality; gv.periodNs=live.gov.periodNs; Put(gv);
+        }
+        else if(a==TAP_CANCEL){e.type=TR_CANCEL; Put(e); live.Cancel(e.tNs);}
+        Flush(n);
+    }
+    void Config(int64_t t,int speed,bool mc,int pred,int mode=LOCATE_RING,int power=POWER_AC){
+        TraceEvent e; e.type=TR_CONFIG; e.tNs=t; e.a=(uint8_t)speed; e.b=(uint8_t)(mc|mode<<1|power<<2); e.c=(uint8_t)pred; Put(e);
+        live.Config(speed,mc,pred,mode,power);
+    }
+    // Runs the render side until `until`, the pointer following path(t).
+    template<class P> void Run(int64_t from,int64_t until,P path){
+        int64_t lastMove=from;
+        for(int64_t t=from;t<until;t+=100000){
+            int32_t x,y; path(t,x,y);
+            if(live.animating&&(x!=cx||y!=cy)&&t-lastMove>=1000000){
+                size_t n=live.outputs.size();
+                TraceEvent m; m.type=TR_MOVE; m.tNs=t; m.x=x; m.y=y; Put(m);
+                live.Move(t,x,y); Flush(n); lastMove=t;
+            }
+            cx=x; cy=y;
+            if(!live.animating||t<live.wakeNs)continue;
+            // Timer wakes land up to 300 us late.
+            rng=rng*1103515245u+12345u;
+            int64_t now=t+(int64_t)(rng>>16)%300000;
+            TraceEvent k; k.type=TR_TICK; k.tNs=now; k.x=x; k.y=y;
+            k.a=TICK_PACED|TICK_VBLANK|TICK_DRAWN; k.nowNs=now+20000;
+            k.periodNs=period; k.vblankNs=k.nowNs/period*period;
+            k.t2=k.nowNs+15000; path(k.t2,k.x2,k.y2);
+            cost.ns[PH_SETUP]=2000+rng%500; cost.ns[PH_RASTER]=9000+rng%4000+(uint32_t)load; cost.ns[PH_PRESENT]=60000+rng%30000;
+            cost.ns[PH_TOTAL]=cost.ns[PH_SETUP]+cost.ns[PH_RASTER]+cost.ns[PH_PRESENT];
+            live.frameCostNs=cost.ns[PH_TOTAL];
+            size_t n=live.outputs.size();
+            k.a=live.Tick(k);
+            Flush(n); Put(k);
+        }
+    }
+};
+
+static void Still(int64_t,int32_t&x,int32_t&y){x=960;y=540;}
+
+// Writes the built-in session to f; false when the live run did not end the way the
+// scenario expects.
+static bool WriteSession(FILE*f)
+{
+    Session s; s.f=f;
+    Trace_WriteHeader(f);
+    const int64_t MS=1000000;
+    TraceEvent tap; tap.type=TR_TAP; s.Put(tap);
+    s.Config(0,1,true,50);
+    // 1. Bare Ctrl tap: the ring plays to the end.
+    s.Key(10*MS,TAP_VK_LCONTROL,true); s.Key(90*MS,TAP_VK_LCONTROL,false);
+    s.Run(90*MS,1400*MS,Still);
+    // 2. Ctrl+C: no trigger.
+    s.Key(1500*MS,TAP_VK_LCONTROL,true); s.Key(1560*MS,'C',true); s.Key(1620*MS,'C',false); s.Key(1700*MS,TAP_VK_LCONTROL,false);
+    s.Run(1700*MS,1800*MS,Still);
+    // 3. Tap, then the pointer moves away: move cancel.
+    s.Key(1900*MS,TAP_VK_RCONTROL,true); s.Key(1950*MS,TAP_VK_RCONTROL,false);
+    s.Run(1950*MS,2600*MS,[](int64_t t,int32_t&x,int32_t&y){int64_t d=t>2150*MS?(t-2150*MS)/(2*MS):0;x=960+(int32_t)d;y=540;});
+    // 4. Back at the start, tap, then a key: key cancel.
+    s.Run(2600*MS,2700*MS,Still);
+    s.Key(2700*MS,TAP_VK_LCONTROL,true); s.Key(2760*MS,TAP_VK_LCONTROL,false);
+    s.Run(2760*MS,2900*MS,Still);
+    s.Key(2900*MS,'A',true); s.Key(2950*MS,'A',false);
+    s.Run(2950*MS,3000*MS,Still);
+    // 5. Fast speed, no move cancel, full prediction: the ring follows a circling pointer.
+    s.Config(3000*MS,2,false,100);
+    s.Key(3100*MS,TAP_VK_LCONTROL,true); s.Key(3180*MS,TAP_VK_LCONTROL,false);
+    s.Run(3180*MS,4000*MS,[](int64_t t,int32_t&x,int32_t&y){
+        double a=t*1e-9*6.2832; x=960+(int32_t)lround(200*cos(a)); y=540+(int32_t)lround(200*sin(a));});
+    // 6. Polling fallback: generic Ctrl held, then released.
+    KeyBits none, ctrl; KeyBits_Set(ctrl,TAP_VK_CONTROL,true); KeyBits_Set(ctrl,TAP_VK_LCONTROL,true);
+    s.Poll(4100*MS,ctrl); s.Poll(4106*MS,ctrl); s.Poll(4112*MS,none);
+    s.Run(4112*MS,5000*MS,Still);
+    // 7. Spotlight mode plays to the end.
+    s.Config(5000*MS,1,true,50,LOCATE_SPOTLIGHT);
+    s.Key(5100*MS,TAP_VK_LCONTROL,true); s.Key(5160*MS,TAP_VK_LCONTROL,false);
+    s.Run(5160*MS,6500*MS,Still);
+    // 8. Frames far over budget, then cheap again: the governor steps down and back up.
+    s.Config(6500*MS,0,true,50);
+    s.load=3*MS;
+    s.Key(6600*MS,TAP_VK_LCONTROL,true); s.Key(6660*MS,TAP_VK_LCONTROL,false);
+    s.Run(6660*MS,6800*MS,Still);
+    s.load=0;
+    s.Run(6800*MS,8400*MS,Still);
+    // 9. On battery, after an idle gap: back to full quality, and a 144 Hz display runs the
+    //    animation at 48 Hz.
+    s.Config(8400*MS,1,true,50,LOCATE_RING,POWER_BATTERY);
+    s.Key(11500*MS,TAP_VK_LCONTROL,true); s.Key(11560*MS,TAP_VK_LCONTROL,false);
+    s.Run(11560*MS,12800*MS,Still);
+
+    TraceEvent d; d.type=TR_DROPPED; d.tNs=s.lastNs; s.Put(d);
+    const uint8_t want[]={END_DONE,END_MOVE,END_KEY,END_DONE,END_DONE,END_DONE,END_DONE,END_DONE};
+    const GovStats&gs=s.live.gov.stats;
+    return s.ends.size()==sizeof(want)&&!memcmp(s.ends.data(),want,sizeof(want))&&
+           gs.deepest>=2&&gs.up>=1&&gs.resets>=1&&Gov_Current(s.live.gov).divisor==3;
+}
+
+//  KEY SETS
+// KeyBits_AnyNew as compiled against the scalar reference: every key alone and missing from
+// a full set, then random sets shaped like polling (mostly the same keys, a few changed).
+// Then ns per call for both over a batch of such pairs.
+static int MainKeys(bool json)
+{
+    uint64_t cases=0, mismatches=0;
+    auto check=[&](const KeyBits&n,const KeyBits&k){
+        cases++; if(KeyBits_AnyNew(n,k)!=KeyBits_AnyNewScalar(n,k))mismatches++;
+    };
+    KeyBits none, all;
+    for(int vk=0;vk<256;vk++)KeyBits_Set(all,vk,true);
+    for(int vk=0;vk<256;vk++){
+        KeyBits one, allBut=all; KeyBits_Set(one,vk,true); KeyBits_Set(allBut,vk,false);
+        check(one,none); check(none,one); check(one,one); check(one,allBut); check(all,allBut); check(allBut,all);
+        cases++; if(!KeyBits_AnyNew(one,none)||KeyBits_AnyNew(one,one)||!KeyBits_AnyNew(all,allBut))mismatches++;
+    }
+    uint64_t seed=0x9E3779B97F4A7C15ull;
+    auto rnd=[&]{seed^=seed<<13; seed^=seed>>7; seed^=seed<<17; return seed;};
+    const int PAIRS=64;
+    std::vector<KeyBits> now(PAIRS), known(PAIRS);
+    for(int i=0;i<200000;i++){
+        KeyBits n,k;
+        for(int w=0;w<4;w++){n.w[w]=rnd()&rnd()&rnd(); k.w[w]=n.w[w];}
+        for(int c=(int)(rnd()%4);c>0;c--)KeyBits_Set(rnd()&1?n:k,(int)(rnd()&255),rnd()&1);
+        check(n,k);
+        if(i<PAIRS){now[i]=n; known[i]=k;}
+    }
+
+    const int CALLS=1<<22;
+    auto time=[&](bool simd){
+        double best=1e300; uint64_t hits=0;
+        for(int rep=0;rep<5;rep++){
+            auto t0=std::chrono::steady_clock::now();
+            for(int i=0;i<CALLS;i++){
+                const int j=i&(PAIRS-1);
+                hits+=simd?KeyBits_AnyNew(now[j],known[j]):KeyBits_AnyNewScalar(now[j],known[j]);
+            }
+            best=std::min(best,std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count()/CALLS);
+        }
+        if(!hits)fprintf(stderr,"no new keys in the timing set\n");
+        return best;
+    };
+    const double nsSimd=time(true), nsScalar=time(false);
+#if defined(BCF_SSE2)
+    const char*path="sse2";
+#else
+    const char*path="scalar";
+#endif
+    if(json)
+        printf("{\"path\":\"%s\",\"cases\":%llu,\"mismatches\":%llu,\"ns_per_call\":%.2f,\"scalar_ns_per_call\":%.2f}\n",
+               path,(unsigned long long)cases,(unsigned long long)mismatches,nsSimd,nsScalar);
+    else
+        printf("path,cases,mismatches,ns_per_call,scalar_ns_per_call\n%s,%llu,%llu,%.2f,%.2f\n",
+               path,(unsigned long long)cases,(unsigned long long)mismatches,nsSimd,nsScalar);
+    return mismatches?1:0;
+}
+
+int main(int argc,char**argv)
+{
+    const char*path=nullptr,*save=nullptr; bool events=false, verbose=false, json=false, keys=false;
+    for(int i=1;i<argc;i++){
+        const char*a=argv[i];
+        if(!strcmp(a,"--events"))events=true;
+        else if(!strcmp(a,"--save")&&i+1<argc)save=argv[++i];
+        else if(!strcmp(a,"--verbose"))verbose=true;
+        else if(!strcmp(a,"--json"))json=true;
+        else if(!strcmp(a,"--keys"))keys=true;
+        else if(a[0]!='-'&&!path)path=a;
+        else{fprintf(stderr,"usage: %s [TRACE] [--events] [--verbose] [--json] [--save FILE] [--keys]\n",argv[0]);return 2;}
+    }
+    if(keys)return MainKeys(json);
+
+    std::vector<TraceEvent> ev;
+    bool sessionOk=true;
+    if(path){
+        FILE*f=fopen(path,"rb");
+        if(!f){fprintf(stderr,"%s: cannot open\n",path);return 1;}
+        bool ok=Trace_Read(f,ev); fclose(f);
+        if(!ok&&ev.empty()){fprintf(stderr,"%s: not a BCF trace\n",path);return 1;}
+        if(!ok)fprintf(stderr,"%s: truncated after %zu events; replaying those\n",path,ev.size());
+    } else {
+        FILE*f=save?fopen(save,"w+b"):tmpfile();
+        if(!f){fprintf(stderr,"cannot create %s\n",save?save:"a temporary file");return 1;}
+        sessionOk=WriteSession(f);
+        rewind(f);
+        bool ok=Trace_Read(f,ev); fclose(f);
+        if(!ok){fprintf(stderr,"built-in session did not decode\n");return 1;}
+        if(!sessionOk)fprintf(stderr,"built-in session did not end as expected\n");
+    }
+
+    if(events)PrintEvents(ev);
+    Report r=Replay(ev);
+    PrintReport(r,path?path:"built-in session",verbose,json);
+    return r.mismatches.empty()&&sessionOk?0:1;
+}
@@ -0,0 +1,170 @@
+//  trace_log.cpp  –  Better Cursor Finder (BCF)
+//  File layout: "BCFTRACE", a little-endian u32 version, then one record per event: the type
+//  byte, the time as a zigzag varint delta from the previous record, and a type-specific
+//  payload of bytes and zigzag varints. Key sets store a mask of non-zero words and only
+//  those words, so a typical record is a handful of bytes.
+
+#include "trace_log.h"
+#include <algorithm>
+#include <cstring>
+
+static const char     TRACE_MAGIC[8] = {'B','C','F','T','R','A','C','E'};
+static const uint32_t TRACE_VERSION  = 3;          // reads 1 and 2 too: 2 added TR_GOV, 3 TR_POINTER
+
+//  ENCODE
+struct Out { uint8_t b[160]; int n = 0; };
+static void PutU8(Out&o,uint8_t v){o.b[o.n++]=v;}
+static void PutUV(Out&o,uint64_t v){while(v>=0x80){PutU8(o,(uint8_t)(v|0x80));v>>=7;}PutU8(o,(uint8_t)v);}
+static void PutSV(Out&o,int64_t v){PutUV(o,((uint64_t)v<<1)^(uint64_t)(v>>63));}
+static void PutKeys(Out&o,const KeyBits&k){
+    uint8_t mask=0; for(int i=0;i<4;i++)if(k.w[i])mask|=(uint8_t)(1<<i);
+    PutU8(o,mask);
+    for(int i=0;i<4;i++)if(k.w[i])for(int s=0;s<64;s+=8)PutU8(o,(uint8_t)(k.w[i]>>s));
+}
+
+void Trace_WriteHeader(FILE*f)
+{
+    uint8_t v[4]={(uint8_t)TRACE_VERSION,(uint8_t)(TRACE_VERSION>>8),(uint8_t)(TRACE_VERSION>>16),(uint8_t)(TRACE_VERSION>>24)};
+    fwrite(TRACE_MAGIC,1,8,f); fwrite(v,1,4,f);
+}
+
+void Trace_Append(FILE*f,int64_t&lastNs,const TraceEvent&e,uint64_t*bytes)
+{
+    Out o;
+    PutU8(o,e.type); PutSV(o,e.tNs-lastNs); lastNs=e.tNs;
+    switch(e.type){
+    case TR_TAP:    PutKeys(o,e.keys); PutKeys(o,e.known); PutU8(o,(uint8_t)(e.a|e.b<<1)); break;
+    case TR_KEY:    PutU8(o,e.a); PutU8(o,(uint8_t)(e.b|e.c<<1|e.d<<2)); break;
+    case TR_POLL:   PutKeys(o,e.keys); PutU8(o,(uint8_t)(e.c|e.d<<1)); break;
+    case TR_CONFIG: PutU8(o,e.a); PutU8(o,e.b); PutU8(o,e.c); break;
+    case TR_START:
+    case TR_MOVE:
+    case TR_POINTER:PutSV(o,e.x); PutSV(o,e.y); break;
+    case TR_CANCEL: break;
+    case TR_TICK:
+        PutSV(o,e.x); PutSV(o,e.y); PutU8(o,e.a);
+        if(e.a&TICK_PACED) PutSV(o,e.nowNs-e.tNs);
+        if(e.a&TICK_VBLANK){PutSV(o,e.periodNs); PutSV(o,e.vblankNs-e.nowNs);}
+        if(e.a&TICK_DRAWN){PutSV(o,e.x2); PutSV(o,e.y2); PutSV(o,e.t2-e.nowNs);}
+        break;
+    case TR_FRAME:{
+        uint32_t p; memcpy(&p,&e.progress,4);
+        for(int s=0;s<32;s+=8)PutU8(o,(uint8_t)(p>>s));
+        PutSV(o,e.x); PutSV(o,e.y);
+        for(int i=0;i<PH_COUNT;i++)PutUV(o,e.ns[i]);
+        break;}
+    case TR_END:    PutU8(o,e.a); break;
+    case TR_DROPPED:PutUV(o,(uint64_t)e.t2); break;
+    case TR_GOV:    PutU8(o,e.a); PutU8(o,e.b); PutU8(o,e.c); PutSV(o,e.periodNs); break;
+    }
+    fwrite(o.b,1,(size_t)o.n,f);
+    if(bytes)*bytes+=(uint64_t)o.n;
+}
+
+//  RECORDER
+bool Trace_Begin(TraceRecorder&r,FILE*f)
+{
+    if(!f)return false;
+    TraceEvent e;
+    while(r.ui.Pop(e)){} while(r.render.Pop(e)){}
+    r.file=f; r.lastNs=0; r.events=0; r.bytes=12; r.dropped=0;
+    Trace_WriteHeader(f);
+    r.on.store(true,std::memory_order_release);
+    return true;
+}
+
+// The rings are each in time order; a merge keeps the file mostly ordered too, and the signed
+// deltas absorb the odd render event that lands after a later UI one was written.
+void Trace_Drain(TraceRecorder&r)
+{
+    if(!r.file)return;
+    TraceEvent a,b; bool ha=r.ui.Pop(a), hb=r.render.Pop(b);
+    while(ha||hb){
+        if(ha&&(!hb||a.tNs<=b.tNs)){Trace_Append(r.file,r.lastNs,a,&r.bytes);ha=r.ui.Pop(a);}
+        else{Trace_Append(r.file,r.lastNs,b,&r.bytes);hb=r.render.Pop(b);}
+        r.events++;
+    }
+}
+
+void Trace_End(TraceRecorder&r)
+{
+    if(!r.file)return;
+    r.on.store(false,std::memory_order_release);
+    Trace_Drain(r);
+    TraceEvent e; e.type=TR_DROPPED; e.tNs=r.lastNs; e.t2=(int64_t)r.dropped.load();
+    Trace_Append(r.file,r.lastNs,e,&r.bytes);
+    fclose(r.file); r.file=nullptr;
+}
+
+//  DECODE
+struct In {
+    FILE*f; bool ok = true;
+    uint8_t U8(){int c=fgetc(f);if(c==EOF){ok=false;return 0;}return (uint8_t)c;}
+    uint64_t UV(){
+        uint64_t v=0;
+        for(int s=0;s<64&&ok;s+=7){uint8_t c=U8();v|=(uint64_t)(c&0x7F)<<s;if(!(c&0x80))return v;}
+        ok=false; return 0;
+    }
+    int64_t SV(){uint64_t u=UV();return (int64_t)(u>>1)^-(int64_t)(u&1);}
+    void Keys(KeyBits&k){
+        uint8_t mask=U8();
+        for(int i=0;i<4;i++){
+            k.w[i]=0;
+            if(mask&(1<<i))for(int s=0;s<64;s+=8)k.w[i]|=(uint64_t)U8()<<s;
+        }
+    }
+};
+
+bool Trace_Read(FILE*f,std::vector<TraceEvent>&out)
+{
+    char magic[8]; uint8_t v[4];
+    if(fread(magic,1,8,f)!=8||memcmp(magic,TRACE_MAGIC,8)||fread(v,1,4,f)!=4)return false;
+    const uint32_t version=(uint32_t)(v[0]|v[1]<<8|v[2]<<16|(uint32_t)v[3]<<24);
+    if(version<1||version>TRACE_VERSION)return false;
+    In in{f}; int64_t t=0;
+    for(;;){
+        int type=fgetc(f);
+        if(type==EOF)return true;
+        if(type>=TR_TYPES)return false;
+        TraceEvent e; e.type=(uint8_t)type;
+        t+=in.SV(); e.tNs=t;
+        switch(e.type){
+        case TR_TAP:    {in.Keys(e.keys); in.Keys(e.known); uint8_t fl=in.U8(); e.a=fl&1; e.b=fl>>1&1; break;}
+        case TR_KEY:    {e.a=in.U8(); uint8_t fl=in.U8(); e.b=fl&1; e.c=fl>>1&1; e.d=fl>>2; break;}
+        case TR_POLL:   {in.Keys(e.keys); uint8_t fl=in.U8(); e.c=fl&1; e.d=fl>>1; break;}
+        case TR_CONFIG: e.a=in.U8(); e.b=in.U8(); e.c=in.U8(); break;
+        case TR_START:
+        case TR_MOVE:
+        case TR_POINTER:e.x=(int32_t)in.SV(); e.y=(int32_t)in.SV(); break;
+        case TR_CANCEL: break;
+        case TR_TICK:
+            e.x=(int32_t)in.SV(); e.y=(int32_t)in.SV(); e.a=in.U8();
+            if(e.a&TICK_PACED) e.nowNs=e.tNs+in.SV();
+            if(e.a&TICK_VBLANK){e.periodNs=in.SV(); e.vblankNs=e.nowNs+in.SV();}
+            if(e.a&TICK_DRAWN){e.x2=(int32_t)in.SV(); e.y2=(int32_t)in.SV(); e.t2=e.nowNs+in.SV();}
+            break;
+        case TR_FRAME:{
+            uint32_t p=0; for(int s=0;s<32;s+=8)p|=(uint32_t)in.U8()<<s;
+            memcpy(&e.progress,&p,4);
+            e.x=(int32_t)in.SV(); e.y=(int32_t)in.SV();
+            for(int i=0;i<PH_COUNT;i++)e.ns[i]=(uint32_t)in.UV();
+            break;}
+        case TR_END:    e.a=in.U8(); break;
+        case TR_DROPPED:e.t2=(int64_t)in.UV(); break;
+        case TR_GOV:    e.a=in.U8(); e.b=in.U8(); e.c=in.U8(); e.periodNs=in.SV(); break;
+        }
+        if(!in.ok)return false;
+        out.push_back(e);
+    }
+}
+
+const char*TraceTypeName(int type)
+{
+    static const char*n[TR_TYPES]={"tap","key","poll","config","start","cancel","move","tick","frame","end","dropped","gov","pointer"};
+    return type>=0&&type<TR_TYPES?n[type]:"?";
+}
+const char*TraceEndName(int reason)
+{
+    static const char*n[]={"done","key","move","quit"};
+    return reason>=0&&reason<4?n[reason]:"?";
+}
@@ -0,0 +1,98 @@
+//  trace_log.h  –  Better Cursor Finder (BCF)
+//  Opt-in input and frame trace. The UI thread records what the Ctrl-tap detector saw and
+//  decided and every raw pointer report, the render thread records the commands, cursor reads and clock readings that
+//  drive an animation plus what it drew. Each thread pushes into its own lock-free ring;
+//  the UI thread drains both into a compact binary file. The decoder and the event layout
+//  are shared with tools/bcf_trace_replay, which re-runs the same state machines over a
+//  trace headlessly, and tools/bcf_shake_eval, which feeds the pointer reports to the shake
+//  detector. No Windows headers.
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "key_bits.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "spsc_ring.h"
+
+enum TraceType : uint8_t {
+    // UI thread
+    TR_TAP,         // Ctrl-tap state when recording began: keys, known, flags
+    TR_KEY,         // hook or mouse-button transition: a=vk, b=down, c=animating, d=action
+    TR_POLL,        // polling tick: keys=held, c=animating, d=action
+    // render thread, inputs
+    TR_CONFIG,      // a=speed, b=moveCancel | mode<<1 | power<<2, c=prediction %
+    TR_START,       // animation started at (x,y); tNs is the pacer's start time
+    TR_CANCEL,      // cancel command (key or click)
+    TR_MOVE,        // raw-input cursor position (x,y) at tNs
+    TR_TICK,        // frame tick: (x,y) cursor read first, pacer clock, (x2,y2) at t2 if drawn
+    // render thread, outputs
+    TR_FRAME,       // drawn at (x,y) with progress, phase times in ns
+    TR_END,         // a=TraceEnd
+    TR_DROPPED,     // t2=events lost to full rings, written when the trace is closed
+    // version 2
+    TR_GOV,         // frame governor at animation start: a=level, b=divisor, c=quality, periodNs
+    // version 3
+    TR_POINTER,     // UI thread: raw-input pointer report (x,y) at tNs, animating or not
+    TR_TYPES
+};
+enum TraceEnd : uint8_t { END_DONE, END_KEY, END_MOVE, END_QUIT };
+enum { TICK_PACED=1, TICK_VBLANK=2, TICK_DRAWN=4 };     // TR_TICK flags in `a`
+
+struct TraceEvent {
+    int64_t  tNs = 0;
+    uint8_t  type = TR_TYPES;
+    uint8_t  a = 0, b = 0, c = 0, d = 0;
+    int32_t  x = 0, y = 0, x2 = 0, y2 = 0;
+    int64_t  t2 = 0;            // TR_TICK: frame cursor read
+    int64_t  nowNs = 0;         // TR_TICK: pacer clock
+    int64_t  periodNs = 0, vblankNs = 0;
+    float    progress = 0;
+    uint32_t ns[PH_COUNT] = {};
+    KeyBits  keys, known;
+};
+
+// Pacer clock that remembers what it last returned, so a tick can record the readings its
+// frame was scheduled from.
+struct TraceClock : PaceClock {
+    PaceClock*inner = nullptr;
+    int64_t   nowNs = 0, periodNs = 0, vblankNs = 0;
+    bool      vblankOk = false;
+    int64_t NowNs() override {return nowNs=inner->NowNs();}
+    bool VBlank(int64_t&periodNs_,int64_t&lastNs) override {
+        vblankOk=inner->VBlank(periodNs_,lastNs); periodNs=periodNs_; vblankNs=lastNs;
+        return vblankOk;
+    }
+};
+
+//  RECORDER
+struct TraceRecorder {
+    std::atomic<bool>          on{false};
+    SpscRing<TraceEvent,2048>  ui;          // producer: UI thread
+    SpscRing<TraceEvent,2048>  render;      // producer: render thread
+    std::atomic<uint64_t>      dropped{0};
+    FILE*                      file = nullptr;      // consumer (UI thread) only
+    int64_t                    lastNs = 0;
+    uint64_t                   events = 0;
+    uint64_t                   bytes = 0;
+};
+static inline bool Trace_On(const TraceRecorder&r){return r.on.load(std::memory_order_relaxed);}
+static inline void Trace_Push(TraceRecorder&r,SpscRing<TraceEvent,2048>&q,const TraceEvent&e){
+    if(Trace_On(r)&&!q.Push(e))r.dropped.fetch_add(1,std::memory_order_relaxed);
+}
+
+// Consumer side, all on one thread. Begin writes the header and discards anything a previous
+// session left in the rings; Drain merges both rings by time and appends them to the file.
+bool Trace_Begin(TraceRecorder&r,FILE*f);
+void Trace_Drain(TraceRecorder&r);
+void Trace_End  (TraceRecorder&r);                 // drains, writes TR_DROPPED, closes the file
+
+// Stand-alone encoder for traces produced without the rings (synthetic sessions, tests).
+void Trace_WriteHeader(FILE*f);
+void Trace_Append(FILE*f,int64_t&lastNs,const TraceEvent&e,uint64_t*bytes=nullptr);
+
+//  READER
+bool Trace_Read(FILE*f,std::vector<TraceEvent>&out);   // false on a bad header or a torn record
+const char*TraceTypeName(int type);
+const char*TraceEndName(int reason);